@@ -9,6 +9,8 @@
 #define FEATURE_BASELINE 0
 #define FEATURE_AUNIT 1
 #define FEATURE_AUNIT_VERBOSE 2
+#define FEATURE_AUNIT_TEST_10 3
+#define FEATURE_AUNIT_SIMPLE_TEST_10 4
 
 // Select one of the FEATURE_* parameter and compile. Then look at the flash
 // and RAM usage, compared to FEATURE_BASELINE usage to determine how much
@@ -17,7 +19,9 @@
 // when modifying its format.
 #define FEATURE 0
 
-#if FEATURE == FEATURE_AUNIT
+#if FEATURE == FEATURE_AUNIT \
+    || FEATURE == FEATURE_AUNIT_TEST_10 \
+    || FEATURE == FEATURE_AUNIT_SIMPLE_TEST_10
   #include <AUnit.h>
   using namespace aunit;
 #elif FEATURE == FEATURE_AUNIT_VERBOSE
@@ -42,6 +46,31 @@ test(atest) {
   guard = 1;
   assertEqual(1, guard);
 }
+#elif FEATURE == FEATURE_AUNIT_TEST_10 \
+    || FEATURE == FEATURE_AUNIT_SIMPLE_TEST_10
+  // Ten tiny tests, to determine the incremental cost of each test, using
+  // test() or simpleTest().
+  #if FEATURE == FEATURE_AUNIT_TEST_10
+    #define TINY_TEST(name, value) test(name) { \
+      guard = value; \
+      assertEqual(value, guard); \
+    }
+  #else
+    #define TINY_TEST(name, value) simpleTest(name) { \
+      guard = value; \
+      assertEqual(value, guard); \
+    }
+  #endif
+TINY_TEST(test0, 0)
+TINY_TEST(test1, 1)
+TINY_TEST(test2, 2)
+TINY_TEST(test3, 3)
+TINY_TEST(test4, 4)
+TINY_TEST(test5, 5)
+TINY_TEST(test6, 6)
+TINY_TEST(test7, 7)
+TINY_TEST(test8, 8)
+TINY_TEST(test9, 9)
 #else
   #error Unknown FEATURE
 #endif
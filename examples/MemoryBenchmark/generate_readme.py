@@ -55,6 +55,16 @@ ASCII table.
 
 ## Library Size Changes
 
+**Unreleased**
+
+* Add `FEATURE_AUNIT_TEST_10` and `FEATURE_AUNIT_SIMPLE_TEST_10`, which define
+  10 tiny tests using `test()` and `simpleTest()` respectively, to show the
+  incremental cost of each test.
+    * The tables below were last collected with AUnit v1.7.1 and do not contain
+      these 2 rows yet. They are added by the next `make benchmarks`.
+    * Each `simpleTest()` shares the vtable and the constructor of
+      `FunctionTest`, instead of defining its own subclass of `TestOnce`.
+
 ## Arduino Nano
 
 * 16MHz ATmega328P
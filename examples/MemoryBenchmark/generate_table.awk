@@ -9,6 +9,8 @@ BEGIN {
   labels[0] = "Baseline"
   labels[1] = "AUnit Single Test"
   labels[2] = "AUnit Single Test Verbose"
+  labels[3] = "AUnit 10 test()"
+  labels[4] = "AUnit 10 simpleTest()"
   record_index = 0
 }
 {
@@ -38,6 +40,7 @@ END {
   for (i = 0; i < NUM_ENTRIES; i++) {
     if (labels[i] ~ /^Baseline/ \
         || labels[i] ~ /^AUnit Single Test$/ \
+        || labels[i] ~ /^AUnit 10 test/ \
     ) {
       printf(\
         "|----------------------------------------+--------------+-------------|\n")
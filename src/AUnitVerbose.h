@@ -45,10 +45,29 @@ SOFTWARE.
 #include "aunit/Compare.h"
 #include "aunit/Printer.h"
 #include "aunit/Test.h"
+#include "aunit/Timer.h"
+#include "aunit/Clock.h"
+#include "aunit/TestListener.h"
+#include "aunit/TestSuite.h"
+#include "aunit/StackMonitor.h"
+#include "aunit/HeapMonitor.h"
+#include "aunit/ComparingPrint.h"
+#include "aunit/LogCapture.h"
+#include "aunit/IsrMonitor.h"
+#include "aunit/TeePrint.h"
+#include "aunit/Benchmark.h"
 #include "aunit/Assertion.h"
 #include "aunit/MetaAssertion.h"
 #include "aunit/TestOnce.h"
 #include "aunit/TestAgain.h"
+#include "aunit/LazyTest.h"
+#include "aunit/FunctionTest.h"
+#include "aunit/ParamTest.h"
+#include "aunit/Random.h"
+#include "aunit/PropertyTest.h"
+#include "aunit/FuzzTest.h"
+#include "aunit/TestHistory.h"
+#include "aunit/ThreadRunner.h"
 #include "aunit/TestRunner.h"
 #include "aunit/AssertVerboseMacros.h" // verbose assertXxx() macros
 #include "aunit/MetaAssertMacros.h"
@@ -100,6 +100,127 @@ SOFTWARE.
     return;\
 } while (false)
 
+/**
+ * Assert that the first 'n' bytes of arg1 and arg2 are equal. Each argument is
+ * a pointer to RAM, or a (const __FlashStringHelper*) to PROGMEM, e.g.
+ * F("\x01\x02") or AUNIT_FPSTR(kBytes). On failure, prints the offset of the
+ * first different byte and the bytes around it in hex.
+ */
+#define assertBytesEqual(arg1,arg2,n) \
+    assertBytesInternal(arg1,arg2,n,1)
+
+/**
+ * Assert that the first 'n' elements of the arrays arg1 and arg2 are equal.
+ * One of the arrays can be in PROGMEM, using AUNIT_FPSTR(). The elements are
+ * compared byte by byte, so they should be integers, or structs without
+ * padding. On failure, prints the index of the first different element and the
+ * elements around it in hex.
+ */
+#define assertArrayEqual(arg1,arg2,n) \
+    assertBytesInternal(arg1,arg2,n,\
+        aunit::internal::arrayElementSize(arg1,arg2))
+
+/** Internal helper macro, shouldn't be called directly by users. */
+#define assertBytesInternal(arg1,arg2,n,elementSize) do {\
+  if (!assertionBytes(__FILE__,__LINE__,(arg1),(arg2),(n),(elementSize)))\
+    return;\
+} while (false)
+
+/**
+ * Assert that each of the first 'n' elements of the float arrays arg1 and arg2
+ * are within 'error' of each other, i.e. |a - b| <= error. On failure, prints
+ * the number of elements out of tolerance, and the largest error with its
+ * index.
+ */
+#define assertArrayNear(arg1,arg2,n,error) \
+    assertArrayNearInternal(arg1,arg2,n,error,\
+        aunit::internal::ArrayNearMode::kAbsolute)
+
+/**
+ * Assert that each of the first 'n' elements of the float arrays arg1 and arg2
+ * are within a relative 'error' of each other, i.e.
+ * |a - b| <= error * max(|a|, |b|).
+ */
+#define assertArrayNearRelative(arg1,arg2,n,error) \
+    assertArrayNearInternal(arg1,arg2,n,error,\
+        aunit::internal::ArrayNearMode::kRelative)
+
+/**
+ * Assert that each of the first 'n' elements of the float arrays arg1 and arg2
+ * are at most 'ulps' representable floats apart (units in the last place).
+ */
+#define assertArrayNearUlps(arg1,arg2,n,ulps) \
+    assertArrayNearInternal(arg1,arg2,n,ulps,\
+        aunit::internal::ArrayNearMode::kUlps)
+
+/** Internal helper macro, shouldn't be called directly by users. */
+#define assertArrayNearInternal(arg1,arg2,n,tolerance,mode) do {\
+  if (!assertionArrayNear(__FILE__,__LINE__,(arg1),(arg2),(n),(tolerance),\
+      (mode)))\
+    return;\
+} while (false)
+
+/**
+ * Assert that the Benchmark 'bench' is no slower than the 'baseline' plus the
+ * 'tolerance' percent, after allowing for the noise in the measurements. The
+ * 'baseline' is a BenchmarkBaseline, normally stored in PROGMEM.
+ */
+#define assertNoSlowerThan(bench, baseline, tolerance) do { \
+  if (!assertionNoSlowerThan(__FILE__, __LINE__, \
+      bench, baseline, tolerance)) \
+    return;\
+} while (false)
+
+/**
+ * Assert that the block of code following the macro makes at most 'n' heap
+ * allocations. Usage:
+ *
+ * @verbatim
+ * assertAllocationsAtMost(1) {
+ *   buffer.append(x);
+ * }
+ * @endverbatim
+ *
+ * The allocations are checked after the block finishes normally, so a
+ * 'break' or 'return' inside the block skips the check. See HeapMonitor for
+ * the platforms on which the allocations are tracked. On the other platforms,
+ * the test is skipped after the block.
+ */
+#define assertAllocationsAtMost(n) \
+  for (aunit::internal::AllocationScope aunitScope; ; aunitScope.finish()) \
+    if (aunitScope.isFinished()) { \
+      if (!assertionAllocations(__FILE__, __LINE__, aunitScope, (n))) \
+        return; \
+      break; \
+    } else
+
+/** Assert that the block of code following the macro does not allocate. */
+#define assertNoAllocations assertAllocationsAtMost(0)
+
+/**
+ * Assert that the block of code following the macro prints exactly the
+ * 'expected' string, which can be in RAM or a flash string using F(). The
+ * macro declares a Print object named 'out' which should be passed to the
+ * code under test. Usage:
+ *
+ * @verbatim
+ * assertPrinted(out, F("{\"a\":1}")) {
+ *   serializer.serialize(out);
+ * }
+ * @endverbatim
+ *
+ * Each byte is compared as it is written, so the output is never stored. See
+ * ComparingPrint for details. As with assertAllocationsAtMost(), a 'break' or
+ * 'return' inside the block skips the check.
+ */
+#define assertPrinted(out, expected) \
+  for (aunit::ComparingPrint out(expected); ; out.finish()) \
+    if (out.isFinished()) { \
+      if (!assertionPrinted(__FILE__, __LINE__, out)) \
+        return; \
+      break; \
+    } else
+
 /**
  * Assert that the inner 'statement' returns with no fatal assertions. This is
  * required because AUnit does not use exceptions, so we have to check the
@@ -111,4 +232,48 @@ SOFTWARE.
   if (isDone()) return; \
 } while (false)
 
+
+/** Assert from an interrupt handler that arg1 is equal to arg2. */
+#define isrAssertEqual(arg1,arg2) \
+    isrAssertOpInternal(arg1,aunit::internal::compareEqual,"==",arg2)
+
+/** Assert from an interrupt handler that arg1 is not equal to arg2. */
+#define isrAssertNotEqual(arg1,arg2) \
+    isrAssertOpInternal(arg1,aunit::internal::compareNotEqual,"!=",arg2)
+
+/** Assert from an interrupt handler that arg1 is less than arg2. */
+#define isrAssertLess(arg1,arg2) \
+    isrAssertOpInternal(arg1,aunit::internal::compareLess,"<",arg2)
+
+/** Assert from an interrupt handler that arg1 is more than arg2. */
+#define isrAssertMore(arg1,arg2) \
+    isrAssertOpInternal(arg1,aunit::internal::compareMore,">",arg2)
+
+/** Assert from an interrupt handler that arg1 is less than or equal to arg2. */
+#define isrAssertLessOrEqual(arg1,arg2) \
+    isrAssertOpInternal(arg1,aunit::internal::compareLessOrEqual,"<=",arg2)
+
+/** Assert from an interrupt handler that arg1 is more than or equal to arg2. */
+#define isrAssertMoreOrEqual(arg1,arg2) \
+    isrAssertOpInternal(arg1,aunit::internal::compareMoreOrEqual,">=",arg2)
+
+/** Assert from an interrupt handler that arg is true. */
+#define isrAssertTrue(arg) isrAssertEqual((bool) (arg),true)
+
+/** Assert from an interrupt handler that arg is false. */
+#define isrAssertFalse(arg) isrAssertEqual((bool) (arg),false)
+
+/**
+ * Internal helper macro, shouldn't be called directly by users. Unlike the
+ * assertXxx() macros, it can be used in any function, nothing is printed,
+ * and the function continues after a failure. The arguments must be integers
+ * no wider than long. They are converted to long, or to unsigned long if
+ * their comparison is unsigned. See IsrMonitor.
+ */
+#define isrAssertOpInternal(arg1,op,opName,arg2) \
+    aunit::IsrMonitor::isrAssertion(__FILE__,__LINE__,\
+        (aunit::internal::IsrOperand<decltype((arg1) + (arg2))>::type) (arg1),\
+        opName,op,\
+        (aunit::internal::IsrOperand<decltype((arg1) + (arg2))>::type) (arg2))
+
 #endif
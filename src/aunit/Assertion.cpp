@@ -22,10 +22,24 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#if EPOXY_DUINO
+#include <atomic>
+#include <thread>
+#include <vector>
+#endif
 #include <stdint.h>
+#include <ctype.h> // tolower()
+#include <math.h> // floor(), log10(), pow()
 #include <Arduino.h>  // definition of Print
 #include "Flash.h"
+#include "Compare.h"
 #include "Printer.h"
+#include "Benchmark.h"
+#include "HeapMonitor.h"
+#include "ComparingPrint.h"
+#include "LinePrint.h"
+#include "FCString.h"
+#include "string_util.h"
 #include "Assertion.h"
 
 #if ! defined(ARDUINO_ARCH_STM32)
@@ -249,11 +263,452 @@ void printAssertionNearMessage(
   printer->println('.');
 }
 
+// Special version for assertNoSlowerThan(). Prints:
+//    "Test.ino:24: Assertion passed/failed: crc32 (median=1250, mad=8) <=
+//    (median=1200, mad=10) +10%."
+//    "Test.ino:24: Assertion passed: crc32 (median=1250, mad=8) recorded."
+void printAssertionBenchmarkMessage(
+    Print* printer,
+    bool ok,
+    const char* file,
+    uint16_t line,
+    const Benchmark& bench,
+    bool recorded,
+    uint32_t baselineMedian,
+    uint32_t baselineMad,
+    uint8_t tolerance
+) {
+
+  // Don't use F() strings here. Same reason as above.
+  printer->print(file);
+  printer->print(':');
+  printer->print(line);
+  printer->print(": Assertion ");
+  printer->print(ok ? "passed" : "failed");
+  printer->print(": ");
+  bench.getName().print(printer);
+  printer->print(" (median=");
+  printer->print((unsigned long) bench.getMedian());
+  printer->print(", mad=");
+  printer->print((unsigned long) bench.getMad());
+  if (recorded) {
+    printer->print(") recorded");
+  } else {
+    printer->print(") <= (median=");
+    printer->print((unsigned long) baselineMedian);
+    printer->print(", mad=");
+    printer->print((unsigned long) baselineMad);
+    printer->print(") +");
+    printer->print(tolerance);
+    printer->print('%');
+  }
+  printer->println('.');
+}
+
+// Special version for assertNoAllocations and assertAllocationsAtMost().
+// Prints:
+//    "Test.ino:24: Assertion passed/failed: allocations (3) <= (2)."
+void printAssertionAllocationsMessage(
+    Print* printer,
+    bool ok,
+    const char* file,
+    uint16_t line,
+    uint32_t count,
+    uint32_t maxCount
+) {
+
+  // Don't use F() strings here. Same reason as above.
+  printer->print(file);
+  printer->print(':');
+  printer->print(line);
+  printer->print(": Assertion ");
+  printer->print(ok ? "passed" : "failed");
+  printer->print(": allocations (");
+  printer->print((unsigned long) count);
+  printer->print(") <= (");
+  printer->print((unsigned long) maxCount);
+  printer->print(')');
+  printer->println('.');
+}
+
+// Special version for assertNoAllocations on a platform which does not track
+// the heap. Prints:
+//    "Test.ino:24: Assertion skipped: allocations are not tracked."
+void printAssertionAllocationsSkippedMessage(
+    Print* printer,
+    const char* file,
+    uint16_t line
+) {
+
+  // Don't use F() strings here. Same reason as above.
+  printer->print(file);
+  printer->print(':');
+  printer->print(line);
+  printer->println(": Assertion skipped: allocations are not tracked.");
+}
+
+// Special version for assertPrinted(). Prints:
+//    "Test.ino:24: Assertion passed: printed (12) bytes."
+//    "Test.ino:24: Assertion failed: printed (12) bytes, mismatch at (9):
+//    expected "...[1,2,3]}" but got "...[1,2,4]}"."
+void printAssertionPrintedMessage(
+    Print* printer,
+    bool ok,
+    const char* file,
+    uint16_t line,
+    const ComparingPrint& output
+) {
+
+  // Don't use F() strings here. Same reason as above.
+  printer->print(file);
+  printer->print(':');
+  printer->print(line);
+  printer->print(": Assertion ");
+  printer->print(ok ? "passed" : "failed");
+  printer->print(": printed (");
+  printer->print((unsigned long) output.getNumWritten());
+  printer->print(") bytes");
+  if (!ok) {
+    printer->print(", mismatch at (");
+    printer->print((unsigned long) output.getMismatchOffset());
+    printer->print("): ");
+    output.printMismatch(printer);
+  }
+  printer->println('.');
+}
+
+/** Number of elements printed on each side of the first mismatch. */
+const uint8_t kBytesContextSize = 3;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+const bool kIsLittleEndian = false;
+#else
+const bool kIsLittleEndian = true;
+#endif
+
+// Print the element at 'p' in hex. Elements of 2, 4 or 8 bytes are printed as
+// integers, with the most significant byte first. Other elements are printed
+// in the order of their bytes in memory.
+void printElementHex(
+    Print* printer,
+    const uint8_t* p,
+    bool isFlash,
+    uint8_t elementSize
+) {
+  bool isReversed = kIsLittleEndian
+      && (elementSize == 2 || elementSize == 4 || elementSize == 8);
+  for (uint8_t i = 0; i < elementSize; i++) {
+    uint8_t j = isReversed ? elementSize - 1 - i : i;
+    uint8_t b = isFlash ? pgm_read_byte(p + j) : p[j];
+    if (b < 0x10) printer->print('0');
+    printer->print(b, HEX);
+  }
+}
+
+// Print the elements around 'index', e.g. "{... 03 04 (05) 06 07 ...}".
+void printBytesWindow(
+    Print* printer,
+    const void* data,
+    bool isFlash,
+    size_t n,
+    uint8_t elementSize,
+    size_t index
+) {
+  size_t begin = (index > kBytesContextSize) ? index - kBytesContextSize : 0;
+  size_t end = (n - index > kBytesContextSize)
+      ? index + kBytesContextSize + 1
+      : n;
+
+  printer->print('{');
+  if (begin > 0) printer->print("... ");
+  for (size_t i = begin; i < end; i++) {
+    if (i > begin) printer->print(' ');
+    if (i == index) printer->print('(');
+    printElementHex(printer, (const uint8_t*) data + i * elementSize, isFlash,
+        elementSize);
+    if (i == index) printer->print(')');
+  }
+  if (end < n) printer->print(" ...");
+  printer->print('}');
+}
+
+// Special version for assertBytesEqual() and assertArrayEqual(). Prints:
+//    "Test.ino:24: Assertion passed: (16) bytes are equal."
+//    "Test.ino:24: Assertion failed: (16) bytes, mismatch at [5]:
+//    {... 03 04 (05) 06 07 ...} vs {... 03 04 (FF) 06 07 ...}."
+// The mismatch is the index of the element, not of the byte.
+void printAssertionBytesMessage(
+    Print* printer,
+    bool ok,
+    const char* file,
+    uint16_t line,
+    const void* lhs,
+    bool isLhsFlash,
+    const void* rhs,
+    bool isRhsFlash,
+    size_t n,
+    uint8_t elementSize,
+    size_t mismatchOffset
+) {
+
+  // Don't use F() strings here. Same reason as above.
+  printer->print(file);
+  printer->print(':');
+  printer->print(line);
+  printer->print(": Assertion ");
+  printer->print(ok ? "passed" : "failed");
+  printer->print(": (");
+  printer->print((unsigned long) n);
+  printer->print(elementSize == 1 ? ") bytes" : ") elements");
+  if (ok) {
+    printer->println(" are equal.");
+    return;
+  }
+
+  size_t index = mismatchOffset / elementSize;
+  printer->print(", mismatch at [");
+  printer->print((unsigned long) index);
+  printer->print("]: ");
+  printBytesWindow(printer, lhs, isLhsFlash, n, elementSize, index);
+  printer->print(" vs ");
+  printBytesWindow(printer, rhs, isRhsFlash, n, elementSize, index);
+  printer->println('.');
+}
+
+// Print 'x' in scientific notation with the given number of decimals, e.g.
+// "1.25e-3". The errors of float arrays are often much smaller than the 2
+// decimals printed by Print::print(double).
+void printScientific(Print* printer, float x, uint8_t decimals) {
+  if (x != x || x - x != 0 || x == 0) {
+    // NaN, infinity and zero.
+    printer->print(x, (x == 0) ? 0 : 2);
+    return;
+  }
+  if (x < 0) {
+    printer->print('-');
+    x = -x;
+  }
+
+  int exponent = (int) floor(log10(x));
+  float mantissa = x / pow(10, exponent);
+  // Normalize the mantissa after a rounding error of log10() or pow().
+  if (mantissa >= 10) {
+    mantissa /= 10;
+    exponent++;
+  } else if (mantissa < 1) {
+    mantissa *= 10;
+    exponent--;
+  }
+  printer->print(mantissa, decimals);
+  printer->print('e');
+  printer->print(exponent);
+}
+
+// Print the tolerance or the error of assertArrayNear() and its variants.
+void printArrayNearError(Print* printer, float error, uint8_t mode) {
+  printer->print('(');
+  if (mode == ArrayNearMode::kUlps) {
+    printer->print((unsigned long) error);
+    printer->print(") ulps");
+  } else {
+    printScientific(printer, error, 2);
+    printer->print(mode == ArrayNearMode::kRelative ? ") relative" : ")");
+  }
+}
+
+// Special version for assertArrayNear() and its variants. Prints:
+//    "Test.ino:24: Assertion passed: (512) elements within (1.00e-3),
+//    max error (2.50e-4)."
+//    "Test.ino:24: Assertion failed: (512) elements within (1.00e-3),
+//    (2) out of tolerance, max error (1.20e-2) at [37]: (1.250000e0) vs
+//    (1.262000e0)."
+void printAssertionArrayNearMessage(
+    Print* printer,
+    bool ok,
+    const char* file,
+    uint16_t line,
+    const float* lhs,
+    const float* rhs,
+    size_t n,
+    float tolerance,
+    uint8_t mode,
+    const ArrayNearResult& result
+) {
+
+  // Don't use F() strings here. Same reason as above.
+  printer->print(file);
+  printer->print(':');
+  printer->print(line);
+  printer->print(": Assertion ");
+  printer->print(ok ? "passed" : "failed");
+  printer->print(": (");
+  printer->print((unsigned long) n);
+  printer->print(") elements within ");
+  printArrayNearError(printer, tolerance, mode);
+  if (!ok) {
+    printer->print(", (");
+    printer->print((unsigned long) result.numFailed);
+    printer->print(") out of tolerance");
+  }
+  printer->print(", max error ");
+  printArrayNearError(printer, result.maxError, mode);
+  if (!ok) {
+    printer->print(" at [");
+    printer->print((unsigned long) result.maxIndex);
+    printer->print("]: (");
+    printScientific(printer, lhs[result.maxIndex], 6);
+    printer->print(") vs (");
+    printScientific(printer, rhs[result.maxIndex], 6);
+    printer->print(')');
+  }
+  printer->println('.');
+}
+
+/** Number of characters printed on each side of the first difference. */
+const uint8_t kStringContextSize = 16;
+
+FCString toFCString(const char* s) { return FCString(s); }
+
+FCString toFCString(const String& s) { return FCString(s.c_str()); }
+
+FCString toFCString(const __FlashStringHelper* s) { return FCString(s); }
+
+// Return true if 'op' is one of the case insensitive comparisons, so that the
+// diff does not stop at a difference of case.
+template <typename A, typename B>
+bool isCaseInsensitive(bool (*op)(A, B)) {
+  typedef bool (*Op)(A, B);
+  return op == static_cast<Op>(compareStringCaseEqual)
+      || op == static_cast<Op>(compareStringCaseNotEqual);
+}
+
+// Print one line of the diff, from 'begin' to kStringContextSize characters
+// after 'offset', e.g. '  "...quick brown fox jumps o..."'. Returns the column
+// of the character at 'offset'.
+uint8_t printStringWindow(
+    Print* printer,
+    const FCString& s,
+    size_t length,
+    size_t begin,
+    size_t offset
+) {
+  size_t end = (length - offset > kStringContextSize)
+      ? offset + kStringContextSize
+      : length;
+  uint8_t column = 3;
+
+  printer->print("  \"");
+  if (begin > 0) {
+    printer->print("...");
+    column += 3;
+  }
+  for (size_t i = begin; i < end; i++) {
+    uint8_t width = printEscaped(printer, s.charAt(i));
+    if (i < offset) column += width;
+  }
+  if (end < length) printer->print("...");
+  printer->println('"');
+  return column;
+}
+
+// Special version for the failed assertions on 2 long strings, which prints
+// the length of the strings, and the characters around the first difference,
+// instead of the full strings. Prints:
+//    "Test.ino:24: Assertion failed: (300 chars) == (302 chars),
+//    first difference at [137]:"
+//    "  "...quick brown fox jumps o...""
+//    "  "...quick brown cat jumps o...""
+//    "                     ^"
+// The verbose version prints "(s1=300 chars)". The characters of a flash
+// string are read one at a time, so the string is never copied into RAM.
+// Returns false, without printing anything, if the assertion passed, if both
+// strings are short enough to be printed in full, or if they are equal.
+bool printStringDiffMessage(
+    Print* printer,
+    bool ok,
+    const char* file,
+    uint16_t line,
+    const FCString& lhs,
+    const __FlashStringHelper* lhsString,
+    const char* opName,
+    const FCString& rhs,
+    const __FlashStringHelper* rhsString,
+    bool ignoreCase
+) {
+  if (ok) return false;
+  if (lhs.getCString() == nullptr || rhs.getCString() == nullptr) return false;
+
+  size_t lhsLength = lhs.length();
+  size_t rhsLength = rhs.length();
+  if (lhsLength <= 2 * kStringContextSize
+      && rhsLength <= 2 * kStringContextSize) {
+    return false;
+  }
+
+  size_t offset = 0;
+  while (offset < lhsLength && offset < rhsLength) {
+    char a = lhs.charAt(offset);
+    char b = rhs.charAt(offset);
+    if (ignoreCase) {
+      a = tolower((unsigned char) a);
+      b = tolower((unsigned char) b);
+    }
+    if (a != b) break;
+    offset++;
+  }
+  if (offset == lhsLength && offset == rhsLength) return false;
+
+  // Don't use F() strings here. Same reason as above. The verbosity of a
+  // message applies until the end of its line (see TeePrint), so it is set
+  // again before each of the 4 lines.
+  Printer::setMessageVerbosity(Verbosity::kAssertionFailed);
+  printer->print(file);
+  printer->print(':');
+  printer->print(line);
+  printer->print(": Assertion failed: (");
+  if (lhsString) {
+    printer->print(lhsString);
+    printer->print('=');
+  }
+  printer->print((unsigned long) lhsLength);
+  printer->print(" chars) ");
+  printer->print(opName);
+  printer->print(" (");
+  if (rhsString) {
+    printer->print(rhsString);
+    printer->print('=');
+  }
+  printer->print((unsigned long) rhsLength);
+  printer->print(" chars), first difference at [");
+  printer->print((unsigned long) offset);
+  printer->println("]:");
+
+  // The characters before the difference are the same in both strings, except
+  // for their case, so the column of the difference is the same.
+  size_t begin = (offset > kStringContextSize)
+      ? offset - kStringContextSize
+      : 0;
+  Printer::setMessageVerbosity(Verbosity::kAssertionFailed);
+  uint8_t column = printStringWindow(printer, lhs, lhsLength, begin, offset);
+  Printer::setMessageVerbosity(Verbosity::kAssertionFailed);
+  printStringWindow(printer, rhs, rhsLength, begin, offset);
+  Printer::setMessageVerbosity(Verbosity::kAssertionFailed);
+  for (uint8_t i = 0; i < column; i++) {
+    printer->print(' ');
+  }
+  printer->println('^');
+  return true;
+}
+
 } // namespace
 
 bool Assertion::isOutputEnabled(bool ok) const {
-  return (ok && isVerbosity(Verbosity::kAssertionPassed)) ||
-      (!ok && isVerbosity(Verbosity::kAssertionFailed));
+  uint8_t verbosity = ok
+      ? Verbosity::kAssertionPassed
+      : Verbosity::kAssertionFailed;
+  if (!isVerbosity(verbosity)) return false;
+  Printer::setMessageVerbosity(verbosity);
+  return true;
 }
 
 bool Assertion::assertionBool(
@@ -463,8 +918,11 @@ bool Assertion::assertion(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessage(Printer::getPrinter(), ok, file, line,
-        lhs, opName, rhs);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        nullptr, opName, toFCString(rhs), nullptr, isCaseInsensitive(op))) {
+      printAssertionMessage(printer, ok, file, line, lhs, opName, rhs);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -481,8 +939,11 @@ bool Assertion::assertion(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessage(Printer::getPrinter(), ok, file, line,
-        lhs, opName, rhs);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        nullptr, opName, toFCString(rhs), nullptr, isCaseInsensitive(op))) {
+      printAssertionMessage(printer, ok, file, line, lhs, opName, rhs);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -499,8 +960,11 @@ bool Assertion::assertion(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessage(Printer::getPrinter(), ok, file, line,
-        lhs, opName, rhs);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        nullptr, opName, toFCString(rhs), nullptr, isCaseInsensitive(op))) {
+      printAssertionMessage(printer, ok, file, line, lhs, opName, rhs);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -517,8 +981,11 @@ bool Assertion::assertion(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessage(Printer::getPrinter(), ok, file, line,
-        lhs, opName, rhs);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        nullptr, opName, toFCString(rhs), nullptr, isCaseInsensitive(op))) {
+      printAssertionMessage(printer, ok, file, line, lhs, opName, rhs);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -535,8 +1002,11 @@ bool Assertion::assertion(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessage(Printer::getPrinter(), ok, file, line,
-        lhs, opName, rhs);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        nullptr, opName, toFCString(rhs), nullptr, isCaseInsensitive(op))) {
+      printAssertionMessage(printer, ok, file, line, lhs, opName, rhs);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -553,8 +1023,11 @@ bool Assertion::assertion(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessage(Printer::getPrinter(), ok, file, line,
-        lhs, opName, rhs);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        nullptr, opName, toFCString(rhs), nullptr, isCaseInsensitive(op))) {
+      printAssertionMessage(printer, ok, file, line, lhs, opName, rhs);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -571,8 +1044,11 @@ bool Assertion::assertion(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessage(Printer::getPrinter(), ok, file, line,
-        lhs, opName, rhs);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        nullptr, opName, toFCString(rhs), nullptr, isCaseInsensitive(op))) {
+      printAssertionMessage(printer, ok, file, line, lhs, opName, rhs);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -589,8 +1065,11 @@ bool Assertion::assertion(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessage(Printer::getPrinter(), ok, file, line,
-        lhs, opName, rhs);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        nullptr, opName, toFCString(rhs), nullptr, isCaseInsensitive(op))) {
+      printAssertionMessage(printer, ok, file, line, lhs, opName, rhs);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -607,8 +1086,11 @@ bool Assertion::assertion(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessage(Printer::getPrinter(), ok, file, line,
-        lhs, opName, rhs);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        nullptr, opName, toFCString(rhs), nullptr, isCaseInsensitive(op))) {
+      printAssertionMessage(printer, ok, file, line, lhs, opName, rhs);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -709,6 +1191,248 @@ bool Assertion::assertionNear(
   return ok;
 }
 
+bool Assertion::assertionNoSlowerThan(
+    const char* file,
+    uint16_t line,
+    const Benchmark& bench,
+    const BenchmarkBaseline& baseline,
+    uint8_t tolerance
+) {
+  if (isDone()) return false;
+  uint32_t baselineMedian;
+  uint32_t baselineMad;
+  readBaseline(bench, baseline, baselineMedian, baselineMad);
+  bool recorded = recordBaseline(bench);
+  bool ok = recorded || isNoSlowerThan(bench.getMedian(), bench.getMad(),
+      baselineMedian, baselineMad, tolerance);
+  if (isOutputEnabled(ok)) {
+    printAssertionBenchmarkMessage(Printer::getPrinter(), ok, file, line,
+        bench, recorded, baselineMedian, baselineMad, tolerance);
+  }
+  setPassOrFail(ok);
+  return ok;
+}
+
+bool Assertion::assertionAllocations(
+    const char* file,
+    uint16_t line,
+    const internal::AllocationScope& scope,
+    uint32_t maxCount
+) {
+  if (isDone()) return false;
+
+  // Skip the test, instead of passing an assertion which checks nothing.
+  if (! HeapMonitor::isUsageSupported()) {
+    if (isOutputEnabled(false)) {
+      printAssertionAllocationsSkippedMessage(Printer::getPrinter(), file,
+          line);
+    }
+    setStatus(kStatusSkipped);
+    return false;
+  }
+
+  bool ok = scope.getCount() <= maxCount;
+  if (isOutputEnabled(ok)) {
+    printAssertionAllocationsMessage(Printer::getPrinter(), ok, file, line,
+        scope.getCount(), maxCount);
+  }
+  setPassOrFail(ok);
+  return ok;
+}
+
+bool Assertion::assertionPrinted(
+    const char* file,
+    uint16_t line,
+    const ComparingPrint& output
+) {
+  if (isDone()) return false;
+  bool ok = output.isMatch();
+  if (isOutputEnabled(ok)) {
+    printAssertionPrintedMessage(Printer::getPrinter(), ok, file, line,
+        output);
+  }
+  setPassOrFail(ok);
+  return ok;
+}
+
+bool Assertion::assertionBytes(
+    const char* file,
+    uint16_t line,
+    const void* lhs,
+    const void* rhs,
+    size_t n,
+    uint8_t elementSize
+) {
+  if (isDone()) return false;
+  size_t size = n * elementSize;
+  size_t mismatchOffset = findBytesMismatch(lhs, rhs, size);
+  bool ok = (mismatchOffset == size);
+  if (isOutputEnabled(ok)) {
+    printAssertionBytesMessage(Printer::getPrinter(), ok, file, line,
+        lhs, false, rhs, false, n, elementSize, mismatchOffset);
+  }
+  setPassOrFail(ok);
+  return ok;
+}
+
+bool Assertion::assertionBytes(
+    const char* file,
+    uint16_t line,
+    const void* lhs,
+    const __FlashStringHelper* rhs,
+    size_t n,
+    uint8_t elementSize
+) {
+  if (isDone()) return false;
+  size_t size = n * elementSize;
+  size_t mismatchOffset = findBytesMismatch(lhs, rhs, size);
+  bool ok = (mismatchOffset == size);
+  if (isOutputEnabled(ok)) {
+    printAssertionBytesMessage(Printer::getPrinter(), ok, file, line,
+        lhs, false, rhs, true, n, elementSize, mismatchOffset);
+  }
+  setPassOrFail(ok);
+  return ok;
+}
+
+bool Assertion::assertionBytes(
+    const char* file,
+    uint16_t line,
+    const __FlashStringHelper* lhs,
+    const void* rhs,
+    size_t n,
+    uint8_t elementSize
+) {
+  if (isDone()) return false;
+  size_t size = n * elementSize;
+  size_t mismatchOffset = findBytesMismatch(lhs, rhs, size);
+  bool ok = (mismatchOffset == size);
+  if (isOutputEnabled(ok)) {
+    printAssertionBytesMessage(Printer::getPrinter(), ok, file, line,
+        lhs, true, rhs, false, n, elementSize, mismatchOffset);
+  }
+  setPassOrFail(ok);
+  return ok;
+}
+
+bool Assertion::assertionBytes(
+    const char* file,
+    uint16_t line,
+    const __FlashStringHelper* lhs,
+    const __FlashStringHelper* rhs,
+    size_t n,
+    uint8_t elementSize
+) {
+  if (isDone()) return false;
+  size_t size = n * elementSize;
+  size_t mismatchOffset = findBytesMismatch(lhs, rhs, size);
+  bool ok = (mismatchOffset == size);
+  if (isOutputEnabled(ok)) {
+    printAssertionBytesMessage(Printer::getPrinter(), ok, file, line,
+        lhs, true, rhs, true, n, elementSize, mismatchOffset);
+  }
+  setPassOrFail(ok);
+  return ok;
+}
+
+bool Assertion::assertionArrayNear(
+    const char* file,
+    uint16_t line,
+    const float* lhs,
+    const float* rhs,
+    size_t n,
+    float tolerance,
+    uint8_t mode
+) {
+  if (isDone()) return false;
+  ArrayNearResult result;
+  compareArrayNear(lhs, rhs, n, tolerance, mode, result);
+  bool ok = (result.numFailed == 0);
+  if (isOutputEnabled(ok)) {
+    printAssertionArrayNearMessage(Printer::getPrinter(), ok, file, line,
+        lhs, rhs, n, tolerance, mode, result);
+  }
+  setPassOrFail(ok);
+  return ok;
+}
+
+#if EPOXY_DUINO
+
+bool Assertion::stress(uint8_t numThreads, uint32_t numIterations,
+    const StressBody& body) {
+  if (isDone()) return false;
+  if (numThreads == 0) numThreads = 1;
+
+  struct Result {
+    uint32_t failedIteration;
+    bool isFailed;
+  };
+  std::vector<Result> results(numThreads, Result{0, false});
+  Print* printer = Printer::getPrinter();
+  std::atomic<uint8_t> numReady(0);
+
+  auto worker = [&](uint8_t thread) {
+    internal::LinePrint linePrint(printer);
+    Printer::setThreadPrinter(&linePrint);
+
+    // Start barrier.
+    numReady++;
+    while (numReady < numThreads) {
+      std::this_thread::yield();
+    }
+
+    uint32_t numFailures = getNumThreadFailures();
+    for (uint32_t i = 0; i < numIterations && isNotDone(); i++) {
+      body(thread, i);
+      if (getNumThreadFailures() != numFailures) {
+        results[thread] = Result{i, true};
+        break;
+      }
+    }
+
+    linePrint.flush();
+    Printer::setThreadPrinter(nullptr);
+  };
+
+  std::vector<std::thread> threads;
+  for (uint8_t i = 0; i < numThreads; i++) {
+    threads.emplace_back(worker, i);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  bool ok = true;
+  for (const Result& result : results) {
+    if (result.isFailed) ok = false;
+  }
+  if (ok) {
+    if (isOutputEnabled(ok)) {
+      printer->print(F("Stress passed: "));
+      printer->print(numThreads);
+      printer->print(F(" thread(s), "));
+      printer->print((unsigned long) numIterations);
+      printer->println(F(" iteration(s) each."));
+    }
+    return true;
+  }
+
+  // One line per failed thread, each tagged as an assertion message.
+  for (uint8_t i = 0; i < numThreads; i++) {
+    if (!results[i].isFailed || !isOutputEnabled(false)) continue;
+    printer->print(F("Stress failed: thread "));
+    printer->print(i);
+    printer->print(F(" at iteration "));
+    printer->print((unsigned long) results[i].failedIteration);
+    printer->print(F(" of "));
+    printer->print((unsigned long) numIterations);
+    printer->println('.');
+  }
+  return false;
+}
+
+#endif
+
 //---------------------------------------------------------------------------
 
 namespace internal {
@@ -1196,8 +1920,13 @@ bool Assertion::assertionVerbose(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessageVerbose(Printer::getPrinter(), ok, file, line,
-        lhs, lhsString, opName, rhs, rhsString);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        lhsString, opName, toFCString(rhs), rhsString,
+        isCaseInsensitive(op))) {
+      printAssertionMessageVerbose(printer, ok, file, line,
+          lhs, lhsString, opName, rhs, rhsString);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -1216,8 +1945,13 @@ bool Assertion::assertionVerbose(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessageVerbose(Printer::getPrinter(), ok, file, line,
-        lhs, lhsString, opName, rhs, rhsString);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        lhsString, opName, toFCString(rhs), rhsString,
+        isCaseInsensitive(op))) {
+      printAssertionMessageVerbose(printer, ok, file, line,
+          lhs, lhsString, opName, rhs, rhsString);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -1236,8 +1970,13 @@ bool Assertion::assertionVerbose(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessageVerbose(Printer::getPrinter(), ok, file, line,
-        lhs, lhsString, opName, rhs, rhsString);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        lhsString, opName, toFCString(rhs), rhsString,
+        isCaseInsensitive(op))) {
+      printAssertionMessageVerbose(printer, ok, file, line,
+          lhs, lhsString, opName, rhs, rhsString);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -1256,8 +1995,13 @@ bool Assertion::assertionVerbose(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessageVerbose(Printer::getPrinter(), ok, file, line,
-        lhs, lhsString, opName, rhs, rhsString);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        lhsString, opName, toFCString(rhs), rhsString,
+        isCaseInsensitive(op))) {
+      printAssertionMessageVerbose(printer, ok, file, line,
+          lhs, lhsString, opName, rhs, rhsString);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -1276,8 +2020,13 @@ bool Assertion::assertionVerbose(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessageVerbose(Printer::getPrinter(), ok, file, line,
-        lhs, lhsString, opName, rhs, rhsString);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        lhsString, opName, toFCString(rhs), rhsString,
+        isCaseInsensitive(op))) {
+      printAssertionMessageVerbose(printer, ok, file, line,
+          lhs, lhsString, opName, rhs, rhsString);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -1296,8 +2045,13 @@ bool Assertion::assertionVerbose(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessageVerbose(Printer::getPrinter(), ok, file, line,
-        lhs, lhsString, opName, rhs, rhsString);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        lhsString, opName, toFCString(rhs), rhsString,
+        isCaseInsensitive(op))) {
+      printAssertionMessageVerbose(printer, ok, file, line,
+          lhs, lhsString, opName, rhs, rhsString);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -1317,8 +2071,13 @@ bool Assertion::assertionVerbose(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessageVerbose(Printer::getPrinter(), ok, file, line,
-        lhs, lhsString, opName, rhs, rhsString);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        lhsString, opName, toFCString(rhs), rhsString,
+        isCaseInsensitive(op))) {
+      printAssertionMessageVerbose(printer, ok, file, line,
+          lhs, lhsString, opName, rhs, rhsString);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -1337,8 +2096,13 @@ bool Assertion::assertionVerbose(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessageVerbose(Printer::getPrinter(), ok, file, line,
-        lhs, lhsString, opName, rhs, rhsString);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        lhsString, opName, toFCString(rhs), rhsString,
+        isCaseInsensitive(op))) {
+      printAssertionMessageVerbose(printer, ok, file, line,
+          lhs, lhsString, opName, rhs, rhsString);
+    }
   }
   setPassOrFail(ok);
   return ok;
@@ -1357,8 +2121,13 @@ bool Assertion::assertionVerbose(
   if (isDone()) return false;
   bool ok = op(lhs, rhs);
   if (isOutputEnabled(ok)) {
-    printAssertionMessageVerbose(Printer::getPrinter(), ok, file, line,
-        lhs, lhsString, opName, rhs, rhsString);
+    Print* printer = Printer::getPrinter();
+    if (!printStringDiffMessage(printer, ok, file, line, toFCString(lhs),
+        lhsString, opName, toFCString(rhs), rhsString,
+        isCaseInsensitive(op))) {
+      printAssertionMessageVerbose(printer, ok, file, line,
+          lhs, lhsString, opName, rhs, rhsString);
+    }
   }
   setPassOrFail(ok);
   return ok;
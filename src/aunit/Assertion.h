@@ -25,6 +25,10 @@ SOFTWARE.
 #ifndef AUNIT_ASSERTION_H
 #define AUNIT_ASSERTION_H
 
+#if EPOXY_DUINO
+#include <functional>
+#endif
+#include <stddef.h> // size_t
 #include "Flash.h"
 #include "Test.h"
 
@@ -33,6 +37,14 @@ class String;
 
 namespace aunit {
 
+class Benchmark;
+struct BenchmarkBaseline;
+class ComparingPrint;
+
+namespace internal {
+class AllocationScope;
+}
+
 /**
  * An Assertion class is a subclass of Test and provides various overloaded
  * assertion() functions. Having this class inherit from Test allows it to
@@ -57,7 +69,10 @@ class Assertion: public Test {
     /** Empty constructor. */
     Assertion() = default;
 
-    /** Returns true if an assertion message should be printed. */
+    /**
+     * Returns true if an assertion message should be printed, and tags the
+     * message using Printer::setMessageVerbosity().
+     */
     bool isOutputEnabled(bool ok) const;
 
     // Terse assertions. Prints only the argument values.
@@ -298,6 +313,120 @@ class Assertion: public Test {
         const char* opName,
         bool (*compareNear)(double lhs, double rhs, double error));
 
+    /**
+     * Used by assertNoSlowerThan(). The 'baseline' is expected to be in
+     * PROGMEM. The same method is used by the terse and verbose macros.
+     */
+    bool assertionNoSlowerThan(
+        const char* file,
+        uint16_t line,
+        const Benchmark& bench,
+        const BenchmarkBaseline& baseline,
+        uint8_t tolerance);
+
+    /**
+     * Used by assertNoAllocations and assertAllocationsAtMost(). The same
+     * method is used by the terse and verbose macros. Skips the test if the
+     * heap is not tracked on this platform.
+     */
+    bool assertionAllocations(
+        const char* file,
+        uint16_t line,
+        const internal::AllocationScope& scope,
+        uint32_t maxCount);
+
+    /**
+     * Used by assertPrinted(). The same method is used by the terse and
+     * verbose macros.
+     */
+    bool assertionPrinted(
+        const char* file,
+        uint16_t line,
+        const ComparingPrint& output);
+
+    /**
+     * Used by assertBytesEqual() and assertArrayEqual(). Compares the first
+     * 'n' elements of 'elementSize' bytes. The same methods are used by the
+     * terse and verbose macros.
+     */
+    bool assertionBytes(
+        const char* file,
+        uint16_t line,
+        const void* lhs,
+        const void* rhs,
+        size_t n,
+        uint8_t elementSize);
+
+    /** Used by assertBytesEqual() and assertArrayEqual(), 'rhs' in PROGMEM. */
+    bool assertionBytes(
+        const char* file,
+        uint16_t line,
+        const void* lhs,
+        const __FlashStringHelper* rhs,
+        size_t n,
+        uint8_t elementSize);
+
+    /** Used by assertBytesEqual() and assertArrayEqual(), 'lhs' in PROGMEM. */
+    bool assertionBytes(
+        const char* file,
+        uint16_t line,
+        const __FlashStringHelper* lhs,
+        const void* rhs,
+        size_t n,
+        uint8_t elementSize);
+
+    /** Used by assertBytesEqual(), both 'lhs' and 'rhs' in PROGMEM. */
+    bool assertionBytes(
+        const char* file,
+        uint16_t line,
+        const __FlashStringHelper* lhs,
+        const __FlashStringHelper* rhs,
+        size_t n,
+        uint8_t elementSize);
+
+    /**
+     * Used by assertArrayNear(), assertArrayNearRelative() and
+     * assertArrayNearUlps(), with the 'mode' from internal::ArrayNearMode. The
+     * same method is used by the terse and verbose macros.
+     */
+    bool assertionArrayNear(
+        const char* file,
+        uint16_t line,
+        const float* lhs,
+        const float* rhs,
+        size_t n,
+        float tolerance,
+        uint8_t mode);
+
+  #if EPOXY_DUINO
+    /** Body of a stress() test, called with the thread and iteration index. */
+    typedef std::function<void(uint8_t thread, uint32_t iteration)>
+        StressBody;
+
+    /**
+     * Call 'body' 'numIterations' times on each of 'numThreads' new threads,
+     * which are released together to maximize the contention. The assertions
+     * made by the body are attributed to this test, and the lines printed by
+     * each thread are not mixed together. A thread stops at the first
+     * iteration where it fails an assertion, and every thread stops once the
+     * test is done. Returns true if no thread failed, otherwise prints the
+     * first failing iteration of each failed thread and returns false.
+     * Available only on EpoxyDuino. Usage:
+     *
+     * @verbatim
+     * test(QueueTest, pushPop) {
+     *   Queue queue;
+     *   stress(4, 10000, [&](uint8_t thread, uint32_t i) {
+     *     assertTrue(queue.push(i));
+     *     assertTrue(queue.pop() != Queue::kEmpty);
+     *   });
+     * }
+     * @endverbatim
+     */
+    bool stress(uint8_t numThreads, uint32_t numIterations,
+        const StressBody& body);
+  #endif
+
     // Verbose versions of above.
 
     /** Used by assertTrue() and assertFalse(). */
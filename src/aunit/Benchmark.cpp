@@ -0,0 +1,246 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#if EPOXY_DUINO
+#include <stdio.h>
+#include <string.h>
+#endif
+#include "Flash.h"
+#include "Timer.h"
+#include "Benchmark.h"
+
+namespace aunit {
+
+Benchmark::Benchmark(const char* name, uint8_t numSamples):
+    mName(name),
+    mNumSamples(numSamples > kMaxSamples ? kMaxSamples : numSamples) {
+  if (! Timer::isCalibrated()) Timer::calibrate();
+}
+
+Benchmark::Benchmark(const __FlashStringHelper* name, uint8_t numSamples):
+    mName(name),
+    mNumSamples(numSamples > kMaxSamples ? kMaxSamples : numSamples) {
+  if (! Timer::isCalibrated()) Timer::calibrate();
+}
+
+// The body of the loop is executed (mNumSamples + 1) times. The duration of
+// the first iteration is discarded because it often includes the cost of
+// filling caches or initializing lazy state. The overhead of the timer itself
+// is subtracted, so that very short blocks of code are not inflated by it.
+bool Benchmark::next() {
+  uint32_t now = Timer::ticks();
+  unsigned long nowMillis = millis();
+  // Keep the samples and the statistics of a completed benchmark.
+  if (mIteration > mNumSamples + 1) return false;
+  if (mIteration >= 2) {
+    // Same as TestRunner::stopTestTimer(), the ticks roll over after a few
+    // seconds on some platforms.
+    unsigned long elapsedMillis = nowMillis - mStartMillis;
+    uint32_t sample;
+    if (elapsedMillis < Timer::kMaxTickMillis) {
+      uint32_t elapsed = now - mStartTicks;
+      uint32_t overhead = Timer::overhead();
+      elapsed = (elapsed > overhead) ? elapsed - overhead : 0;
+      sample = Timer::toNanos(elapsed);
+    } else {
+      sample = (elapsedMillis > UINT32_MAX / 1000000)
+          ? UINT32_MAX : elapsedMillis * 1000000;
+    }
+    mSamples[mIteration - 2] = sample;
+  }
+  if (mIteration > mNumSamples) {
+    mMedian = internal::computeMedian(mSamples, mNumSamples);
+    mMad = internal::computeMad(mSamples, mNumSamples, mMedian);
+    mIteration++;
+    return false;
+  }
+  mIteration++;
+  mStartMillis = millis();
+  mStartTicks = Timer::ticks();
+  return true;
+}
+
+namespace internal {
+
+namespace {
+
+// Return (a + b), or UINT32_MAX if it overflows.
+uint32_t saturatingAdd(uint32_t a, uint32_t b) {
+  uint32_t sum = a + b;
+  return (sum < a) ? UINT32_MAX : sum;
+}
+
+// Insertion sort. The number of samples is small, so this is faster and
+// smaller than anything more clever.
+void sortValues(uint32_t values[], uint8_t n) {
+  for (uint8_t i = 1; i < n; i++) {
+    uint32_t value = values[i];
+    uint8_t j = i;
+    for (; j > 0 && values[j - 1] > value; j--) {
+      values[j] = values[j - 1];
+    }
+    values[j] = value;
+  }
+}
+
+}
+
+uint32_t computeMedian(uint32_t values[], uint8_t n) {
+  if (n == 0) return 0;
+  sortValues(values, n);
+  uint8_t mid = n / 2;
+  if (n & 0x1) return values[mid];
+  uint32_t a = values[mid - 1];
+  uint32_t b = values[mid];
+  return a + (b - a) / 2;
+}
+
+uint32_t computeMad(uint32_t values[], uint8_t n, uint32_t median) {
+  for (uint8_t i = 0; i < n; i++) {
+    values[i] = (values[i] > median)
+        ? values[i] - median
+        : median - values[i];
+  }
+  return computeMedian(values, n);
+}
+
+bool isNoSlowerThan(uint32_t median, uint32_t mad,
+    uint32_t baselineMedian, uint32_t baselineMad, uint8_t tolerance) {
+  // A median of 0 means that the baseline was never recorded.
+  if (baselineMedian == 0) return true;
+
+  // Avoid the overflow of (baselineMedian * tolerance).
+  uint32_t allowance = (baselineMedian / 100) * tolerance
+      + (baselineMedian % 100) * tolerance / 100;
+  uint32_t noise = (mad > baselineMad) ? mad : baselineMad;
+  uint32_t margin = (noise > UINT32_MAX / 3) ? UINT32_MAX : 3 * noise;
+  uint32_t limit = saturatingAdd(saturatingAdd(baselineMedian, allowance),
+      margin);
+  return median <= limit;
+}
+
+#if EPOXY_DUINO
+
+namespace {
+
+/** A baseline loaded from the file given by `--baseline`. */
+struct NamedBaseline {
+  char name[48];
+  uint32_t median;
+  uint32_t mad;
+};
+
+const uint8_t kMaxNamedBaselines = 128;
+NamedBaseline sBaselines[kMaxNamedBaselines];
+uint8_t sNumBaselines = 0;
+FILE* sSaveFile = nullptr;
+
+// Copy the name of the benchmark into a normal c-string.
+void copyName(const FCString& name, char* dst, size_t size) {
+  if (name.getType() == FCString::kCStringType) {
+    strncpy(dst, name.getCString(), size);
+  } else {
+    strncpy_P(dst, (const char*) name.getFString(), size);
+  }
+  dst[size - 1] = '\0';
+}
+
+}
+
+void readBaseline(const Benchmark& bench, const BenchmarkBaseline& baseline,
+    uint32_t& median, uint32_t& mad) {
+  char name[sizeof(NamedBaseline::name)];
+  copyName(bench.getName(), name, sizeof(name));
+  for (uint8_t i = 0; i < sNumBaselines; i++) {
+    if (strcmp(name, sBaselines[i].name) == 0) {
+      median = sBaselines[i].median;
+      mad = sBaselines[i].mad;
+      return;
+    }
+  }
+  median = pgm_read_dword(&baseline.median);
+  mad = pgm_read_dword(&baseline.mad);
+}
+
+bool recordBaseline(const Benchmark& bench) {
+  if (sSaveFile == nullptr) return false;
+
+  char name[sizeof(NamedBaseline::name)];
+  copyName(bench.getName(), name, sizeof(name));
+  fprintf(sSaveFile, "%s %lu %lu\n", name,
+      (unsigned long) bench.getMedian(), (unsigned long) bench.getMad());
+  fflush(sSaveFile);
+  return true;
+}
+
+#else
+
+void readBaseline(const Benchmark& /*bench*/,
+    const BenchmarkBaseline& baseline, uint32_t& median, uint32_t& mad) {
+  median = pgm_read_dword(&baseline.median);
+  mad = pgm_read_dword(&baseline.mad);
+}
+
+bool recordBaseline(const Benchmark& /*bench*/) {
+  return false;
+}
+
+#endif
+
+} // internal
+
+#if EPOXY_DUINO
+
+// The file contains one line per benchmark: "{name} {median} {mad}".
+bool Benchmark::loadBaselines(const char* fileName) {
+  using internal::sBaselines;
+  using internal::sNumBaselines;
+  using internal::kMaxNamedBaselines;
+
+  FILE* file = fopen(fileName, "r");
+  if (file == nullptr) return false;
+
+  sNumBaselines = 0;
+  unsigned long median;
+  unsigned long mad;
+  while (sNumBaselines < kMaxNamedBaselines
+      && fscanf(file, "%47s %lu %lu",
+          sBaselines[sNumBaselines].name, &median, &mad) == 3) {
+    sBaselines[sNumBaselines].median = median;
+    sBaselines[sNumBaselines].mad = mad;
+    sNumBaselines++;
+  }
+  fclose(file);
+  return true;
+}
+
+bool Benchmark::saveBaselines(const char* fileName) {
+  if (internal::sSaveFile) fclose(internal::sSaveFile);
+  internal::sSaveFile = fopen(fileName, "w");
+  return internal::sSaveFile != nullptr;
+}
+
+#endif
+
+}
@@ -0,0 +1,188 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_BENCHMARK_H
+#define AUNIT_BENCHMARK_H
+
+#include <stdint.h>
+#include "FCString.h"
+
+class __FlashStringHelper;
+
+namespace aunit {
+
+/**
+ * The expected timing of a Benchmark, in nanoseconds. On a microcontroller,
+ * the baseline is normally compiled into flash memory using PROGMEM, for
+ * example:
+ *
+ * @verbatim
+ * static const aunit::BenchmarkBaseline kCrcBaseline PROGMEM = {1200000, 10000};
+ * @endverbatim
+ *
+ * A baseline whose median is 0 means that no baseline has been recorded yet,
+ * and the assertNoSlowerThan() macro will always pass.
+ */
+struct BenchmarkBaseline {
+  /** Median duration of a single iteration. */
+  uint32_t median;
+
+  /** Median absolute deviation of the iterations. */
+  uint32_t mad;
+};
+
+/**
+ * Measures the duration of a block of code over a number of iterations, and
+ * summarizes them using robust statistics (median and median absolute
+ * deviation) which are insensitive to the occasional outlier caused by
+ * interrupts or a context switch. The first iteration is a warm up and is not
+ * recorded. Usage:
+ *
+ * @verbatim
+ * test(crc32) {
+ *   Benchmark bench("crc32");
+ *   while (bench.next()) {
+ *     crc32(buf, sizeof(buf));
+ *   }
+ *   assertNoSlowerThan(bench, kCrcBaseline, 10);
+ * }
+ * @endverbatim
+ *
+ * The durations are measured using the Timer class, and are reported in
+ * nanoseconds, although the actual resolution is only 1 microsecond on
+ * platforms without a cycle counter (e.g. AVR). An iteration which takes
+ * longer than Timer::kMaxTickMillis is measured using millis(), and the
+ * samples saturate at 4.29 seconds. The samples are stored inside the object,
+ * so no heap allocation is needed.
+ */
+class Benchmark {
+  public:
+    /** Maximum number of samples. */
+    static const uint8_t kMaxSamples = 31;
+
+    /** Default number of samples. */
+    static const uint8_t kDefaultSamples = 15;
+
+    /**
+     * Constructor. The 'name' identifies the baseline in the file given by
+     * the `--baseline` and `--save-baseline` flags on EpoxyDuino.
+     */
+    explicit Benchmark(const char* name,
+        uint8_t numSamples = kDefaultSamples);
+
+    /** Constructor using a flash string. */
+    explicit Benchmark(const __FlashStringHelper* name,
+        uint8_t numSamples = kDefaultSamples);
+
+    /**
+     * Record the duration of the previous iteration and return true if
+     * another iteration should be performed. The statistics are computed
+     * when it returns false.
+     */
+    bool next();
+
+    /** Return the name of the benchmark. */
+    const internal::FCString& getName() const { return mName; }
+
+    /** Return the number of recorded samples. */
+    uint8_t getNumSamples() const { return mNumSamples; }
+
+    /** Return the median duration of a single iteration, in nanos. */
+    uint32_t getMedian() const { return mMedian; }
+
+    /** Return the median absolute deviation of the iterations, in nanos. */
+    uint32_t getMad() const { return mMad; }
+
+  #if EPOXY_DUINO
+    /**
+     * Load the baselines from the given file, which was written by
+     * saveBaselines() in an earlier run. These take precedence over the
+     * baselines compiled into the program. Returns false if the file could
+     * not be read.
+     */
+    static bool loadBaselines(const char* fileName);
+
+    /**
+     * Write the result of every benchmark which is asserted using
+     * assertNoSlowerThan() to the given file. While recording, the assertion
+     * always passes. Returns false if the file could not be opened.
+     */
+    static bool saveBaselines(const char* fileName);
+  #endif
+
+  private:
+    // Disable copy-constructor and assignment operator
+    Benchmark(const Benchmark&) = delete;
+    Benchmark& operator=(const Benchmark&) = delete;
+
+    internal::FCString mName;
+    uint32_t mSamples[kMaxSamples];
+    uint32_t mMedian = 0;
+    uint32_t mMad = 0;
+    uint32_t mStartTicks = 0;
+    unsigned long mStartMillis = 0;
+    uint8_t mNumSamples;
+    uint8_t mIteration = 0;
+};
+
+namespace internal {
+
+/**
+ * Return the median of the given values. The values are sorted in place as a
+ * side effect. Returns 0 if n is 0.
+ */
+uint32_t computeMedian(uint32_t values[], uint8_t n);
+
+/**
+ * Return the median absolute deviation of the given values around the given
+ * median. The values are overwritten with their absolute deviations.
+ */
+uint32_t computeMad(uint32_t values[], uint8_t n, uint32_t median);
+
+/**
+ * Return true if the measured median is no slower than the baseline median
+ * plus 'tolerance' percent, with an allowance of 3 times the larger of the
+ * 2 median absolute deviations to absorb the noise of the measurements.
+ */
+bool isNoSlowerThan(uint32_t median, uint32_t mad,
+    uint32_t baselineMedian, uint32_t baselineMad, uint8_t tolerance);
+
+/**
+ * Retrieve the baseline of the given benchmark. The 'baseline' is in PROGMEM,
+ * but may be overridden by the file given by `--baseline` on EpoxyDuino.
+ */
+void readBaseline(const Benchmark& bench, const BenchmarkBaseline& baseline,
+    uint32_t& median, uint32_t& mad);
+
+/**
+ * Record the result of the benchmark if `--save-baseline` was given on
+ * EpoxyDuino. Returns true if the result was recorded.
+ */
+bool recordBaseline(const Benchmark& bench);
+
+}
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Clock.h"
+
+namespace aunit {
+
+unsigned long Clock::sSkippedMillis = 0;
+unsigned long Clock::sDeadline = 0;
+bool Clock::sIsVirtual = false;
+bool Clock::sHasDeadline = false;
+bool Clock::sIsStepIdle = true;
+bool Clock::sIsPassBusy = false;
+
+void Clock::delay(unsigned long ms) {
+  if (sIsVirtual) {
+    sSkippedMillis += ms;
+  } else {
+    ::delay(ms);
+  }
+}
+
+bool Clock::waitUntil(unsigned long deadline) {
+  // Handles the rollover of millis().
+  if ((long) (deadline - millis()) <= 0) return true;
+  idleUntil(deadline);
+  return false;
+}
+
+void Clock::idleUntil(unsigned long deadline) {
+  if (!sIsVirtual) return;
+
+  sIsStepIdle = true;
+  if (!sHasDeadline || (long) (deadline - sDeadline) < 0) {
+    sDeadline = deadline;
+    sHasDeadline = true;
+  }
+}
+
+void Clock::setVirtual(bool isVirtual) {
+  sIsVirtual = isVirtual;
+  sIsStepIdle = true;
+  sIsPassBusy = false;
+  sHasDeadline = false;
+}
+
+// The step before the current one was idle only if its test called
+// idleUntil(). A step which sets up, loops without waiting, or finishes a
+// test makes the whole pass busy.
+void Clock::runnerStep(bool isPassEnd) {
+  if (!sIsStepIdle) sIsPassBusy = true;
+
+  if (isPassEnd) {
+    if (!sIsPassBusy && sHasDeadline) {
+      long remaining = (long) (sDeadline - millis());
+      if (remaining > 0) sSkippedMillis += remaining;
+    }
+    sIsPassBusy = false;
+    sHasDeadline = false;
+
+    // No step is pending until the next one starts.
+    sIsStepIdle = true;
+  } else {
+    sIsStepIdle = false;
+  }
+}
+
+}
@@ -0,0 +1,115 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_CLOCK_H
+#define AUNIT_CLOCK_H
+
+#include <Arduino.h> // millis(), micros(), delay()
+
+namespace aunit {
+
+/**
+ * The clock of the tests. It is the same as millis() and micros(), unless
+ * TestRunner::setVirtualTime() is enabled. In that mode, the clock still runs
+ * at the speed of the real clock, but skips ahead whenever every runnable
+ * testing() test is waiting for a deadline, so that the tests which wait for
+ * seconds or minutes complete at the speed of the CPU. The code under test
+ * should read the time through the same source, e.g. by being given the
+ * Clock::millis function. Usage:
+ *
+ * @verbatim
+ * testing(retryBackoff) {
+ *   if (! Clock::waitUntil(nextRetry)) return;
+ *   client.retry();
+ *   nextRetry = Clock::millis() + 60000;
+ *   ...
+ * }
+ * @endverbatim
+ *
+ * On the hardware, the same tests run with the real clock by leaving
+ * setVirtualTime() disabled. On EpoxyDuino, the virtual time keeps all the
+ * tests on the main thread, even with TestRunner::setJobs(), because the clock
+ * is advanced by the loop of the TestRunner.
+ */
+class Clock {
+  public:
+    /** Return the milliseconds since the start, including the skipped time. */
+    static unsigned long millis() { return ::millis() + sSkippedMillis; }
+
+    /** Return the microseconds since the start, including the skipped time. */
+    static unsigned long micros() {
+      return ::micros() + sSkippedMillis * 1000;
+    }
+
+    /**
+     * Same as delay(). With the virtual time, the clock skips ahead
+     * immediately instead, as if the test had blocked for 'ms'.
+     */
+    static void delay(unsigned long ms);
+
+    /**
+     * Return true if the 'deadline' (in Clock::millis()) has been reached.
+     * Otherwise, call idleUntil(deadline) and return false, so that a testing()
+     * test can return from its loop() and be called again later.
+     */
+    static bool waitUntil(unsigned long deadline);
+
+    /**
+     * Tell the TestRunner that the current testing() test has nothing to do
+     * until the 'deadline'. When every test which runs in a pass over the
+     * tests is idle, the virtual time skips to the earliest deadline. Does
+     * nothing with the real clock.
+     */
+    static void idleUntil(unsigned long deadline);
+
+    /** Return true if the virtual time is enabled. */
+    static bool isVirtual() { return sIsVirtual; }
+
+  private:
+    friend class TestRunner;
+
+    /** Enable or disable the virtual time. Called by TestRunner. */
+    static void setVirtual(bool isVirtual);
+
+    /**
+     * Called by the TestRunner before each step of a test, and at the end of
+     * each pass over the tests ('isPassEnd'). Installed as
+     * TestRunner::sVirtualTimeHook.
+     */
+    static void runnerStep(bool isPassEnd);
+
+    /** Return the Clock::millis(). Installed as TestRunner::sMillisHook. */
+    static unsigned long runnerMillis() { return millis(); }
+
+    static unsigned long sSkippedMillis;
+    static unsigned long sDeadline;
+    static bool sIsVirtual;
+    static bool sHasDeadline;
+    static bool sIsStepIdle;
+    static bool sIsPassBusy;
+};
+
+}
+
+#endif
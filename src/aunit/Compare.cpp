@@ -119,7 +119,7 @@ inlining them because they are almost always used through a function pointer.
 
 #include <stdint.h>
 #include <string.h>
-#include <math.h> // fabs()
+#include <math.h> // fabs(), fabsf()
 #include <WString.h>
 #include "Flash.h"
 #include "Compare.h"
@@ -987,5 +987,181 @@ bool compareNotNear(double a, double b, double error) {
   return !compareNear(a, b, error);
 }
 
+//---------------------------------------------------------------------------
+// findBytesMismatch()
+//---------------------------------------------------------------------------
+
+namespace {
+
+/** Size of the blocks compared by memcmp() before scanning the bytes. */
+const size_t kMismatchBlockSize = 32;
+
+/** Compare 'n' bytes of 'a' and 'b', which may be in RAM or in PROGMEM. */
+bool isBytesEqual(const uint8_t* a, bool isFlashA, const uint8_t* b,
+    bool isFlashB, size_t n) {
+  if (!isFlashA && !isFlashB) return memcmp(a, b, n) == 0;
+  if (!isFlashA) return memcmp_P(a, b, n) == 0;
+  if (!isFlashB) return memcmp_P(b, a, n) == 0;
+
+  for (size_t i = 0; i < n; i++) {
+    if (pgm_read_byte(a + i) != pgm_read_byte(b + i)) return false;
+  }
+  return true;
+}
+
+size_t findMismatch(const void* a, bool isFlashA, const void* b, bool isFlashB,
+    size_t n) {
+  const uint8_t* pa = (const uint8_t*) a;
+  const uint8_t* pb = (const uint8_t*) b;
+
+  // Most calls are expected to pass, so compare everything at once first.
+  if (isBytesEqual(pa, isFlashA, pb, isFlashB, n)) return n;
+
+  size_t offset = 0;
+  while (n - offset > kMismatchBlockSize && isBytesEqual(
+      pa + offset, isFlashA, pb + offset, isFlashB, kMismatchBlockSize)) {
+    offset += kMismatchBlockSize;
+  }
+  while (offset < n
+      && isBytesEqual(pa + offset, isFlashA, pb + offset, isFlashB, 1)) {
+    offset++;
+  }
+  return offset;
+}
+
+} // namespace
+
+size_t findBytesMismatch(const void* a, const void* b, size_t n) {
+  return findMismatch(a, false, b, false, n);
+}
+
+size_t findBytesMismatch(const void* a, const __FlashStringHelper* b,
+    size_t n) {
+  return findMismatch(a, false, b, true, n);
+}
+
+size_t findBytesMismatch(const __FlashStringHelper* a, const void* b,
+    size_t n) {
+  return findMismatch(a, true, b, false, n);
+}
+
+size_t findBytesMismatch(const __FlashStringHelper* a,
+    const __FlashStringHelper* b, size_t n) {
+  return findMismatch(a, true, b, true, n);
+}
+
+//---------------------------------------------------------------------------
+// compareArrayNear()
+//---------------------------------------------------------------------------
+
+namespace {
+
+// The errors are compared as uint32_t keys instead of floats. The bits of a
+// non-negative float are in the same order as its value, with NaN after
+// infinity, so a NaN error is the largest one and fails any tolerance. The
+// compiler cannot vectorize the maximum of floats without -ffast-math, but it
+// can vectorize the maximum of integers. The error functions use masks instead
+// of conditional expressions for the same reason.
+
+uint32_t floatToKey(float x) {
+  uint32_t key;
+  memcpy(&key, &x, sizeof(key));
+  return key;
+}
+
+float keyToFloat(uint32_t key) {
+  float x;
+  memcpy(&x, &key, sizeof(x));
+  return x;
+}
+
+// Map the bits of a float to an integer in the same order as the floats,
+// with +0.0 and -0.0 both mapped to 0.
+int32_t toOrdered(float x) {
+  int32_t i;
+  memcpy(&i, &x, sizeof(i));
+  return (i < 0) ? (int32_t) (0x80000000u - (uint32_t) i) : i;
+}
+
+// 2 equal elements, including infinities of the same sign, have no error.
+uint32_t equalMask(float a, float b) {
+  return -(uint32_t) (a != b);
+}
+
+struct AbsoluteError {
+  uint32_t operator()(float a, float b) const {
+    return floatToKey(fabsf(a - b)) & equalMask(a, b);
+  }
+};
+
+struct RelativeError {
+  uint32_t operator()(float a, float b) const {
+    float absA = fabsf(a);
+    float absB = fabsf(b);
+    float error = fabsf(a - b) / ((absA > absB) ? absA : absB);
+    return floatToKey(error) & equalMask(a, b);
+  }
+};
+
+struct UlpsError {
+  uint32_t operator()(float a, float b) const {
+    int32_t orderedA = toOrdered(a);
+    int32_t orderedB = toOrdered(b);
+    uint32_t distance = (orderedA > orderedB)
+        ? (uint32_t) orderedA - (uint32_t) orderedB
+        : (uint32_t) orderedB - (uint32_t) orderedA;
+    return distance | -(uint32_t) ((a != a) | (b != b));
+  }
+};
+
+// Return the largest error, and fill the other fields of the result.
+template <typename ErrorFunction>
+uint32_t scanErrors(const float* a, const float* b, size_t n,
+    uint32_t tolerance, ArrayNearResult& result) {
+  ErrorFunction error;
+
+  uint32_t numFailed = 0;
+  uint32_t maxError = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint32_t e = error(a[i], b[i]);
+    numFailed += (e > tolerance);
+    maxError = (e > maxError) ? e : maxError;
+  }
+
+  result.numFailed = numFailed;
+  result.maxIndex = 0;
+  if (numFailed == 0) return maxError;
+
+  for (size_t i = 0; i < n; i++) {
+    if (error(a[i], b[i]) == maxError) {
+      result.maxIndex = i;
+      break;
+    }
+  }
+  return maxError;
+}
+
+} // namespace
+
+void compareArrayNear(const float* a, const float* b, size_t n,
+    float tolerance, uint8_t mode, ArrayNearResult& result) {
+  // Also catches -0.0 and NaN, whose keys would accept any error.
+  if (!(tolerance > 0)) tolerance = 0;
+
+  if (mode == ArrayNearMode::kUlps) {
+    // Converting a float beyond the range of uint32_t is undefined. The
+    // clamped tolerance stays below UINT32_MAX, which is the error of NaN.
+    uint32_t ulps = (tolerance < 4294967296.0f)
+        ? (uint32_t) tolerance : UINT32_MAX - 1;
+    result.maxError = (float) scanErrors<UlpsError>(a, b, n, ulps, result);
+  } else if (mode == ArrayNearMode::kRelative) {
+    result.maxError = keyToFloat(scanErrors<RelativeError>(
+        a, b, n, floatToKey(tolerance), result));
+  } else {
+    result.maxError = keyToFloat(scanErrors<AbsoluteError>(
+        a, b, n, floatToKey(tolerance), result));
+  }
+}
+
 }
 }
@@ -71,6 +71,7 @@ SOFTWARE.
 #define AUNIT_COMPARE_H
 
 #include <stddef.h> // size_t
+#include <stdint.h>
 
 class String;
 class __FlashStringHelper;
@@ -505,6 +506,111 @@ bool compareNotNear(unsigned long a, unsigned long b, unsigned long error);
 
 bool compareNotNear(double a, double b, double error);
 
+//---------------------------------------------------------------------------
+// findBytesMismatch()
+//
+// These functions are used to implement the assertBytesEqual() and
+// assertArrayEqual() macros. A (const __FlashStringHelper*) points to bytes in
+// PROGMEM, which may contain NUL characters.
+//---------------------------------------------------------------------------
+
+/**
+ * Return the offset of the first byte which differs between 'a' and 'b', or
+ * 'n' if their first 'n' bytes are equal. The bytes are compared in blocks
+ * using memcmp() or memcmp_P(), which use the widest loads of the platform,
+ * and only the block which differs is scanned byte by byte.
+ */
+size_t findBytesMismatch(const void* a, const void* b, size_t n);
+
+/** Same as above, with 'b' in PROGMEM. */
+size_t findBytesMismatch(const void* a, const __FlashStringHelper* b,
+    size_t n);
+
+/** Same as above, with 'a' in PROGMEM. */
+size_t findBytesMismatch(const __FlashStringHelper* a, const void* b,
+    size_t n);
+
+/** Same as above, with both 'a' and 'b' in PROGMEM. */
+size_t findBytesMismatch(const __FlashStringHelper* a,
+    const __FlashStringHelper* b, size_t n);
+
+/**
+ * Return the size of the elements of the arrays 'a' and 'b', which must be the
+ * same. Used by assertArrayEqual().
+ */
+template <typename A, typename B>
+uint8_t arrayElementSize(const A* /*a*/, const B* /*b*/) {
+  static_assert(sizeof(A) == sizeof(B), "Array elements of different sizes");
+  static_assert(sizeof(A) < 256, "Array elements too large");
+  return sizeof(A);
+}
+
+/** Same as above, with the array 'b' in PROGMEM. */
+template <typename A>
+uint8_t arrayElementSize(const A* /*a*/, const __FlashStringHelper* /*b*/) {
+  static_assert(sizeof(A) < 256, "Array elements too large");
+  return sizeof(A);
+}
+
+/** Same as above, with the array 'a' in PROGMEM. */
+template <typename B>
+uint8_t arrayElementSize(const __FlashStringHelper* /*a*/, const B* /*b*/) {
+  static_assert(sizeof(B) < 256, "Array elements too large");
+  return sizeof(B);
+}
+
+//---------------------------------------------------------------------------
+// compareArrayNear()
+//
+// These functions are used to implement the assertArrayNear(),
+// assertArrayNearRelative() and assertArrayNearUlps() macros. They use float
+// instead of double, because double is emulated in software on many
+// microcontrollers (and is the same as float on AVR).
+//---------------------------------------------------------------------------
+
+/** The measure of the error between 2 elements used by compareArrayNear(). */
+class ArrayNearMode {
+  public:
+    /** The absolute difference, |a - b|. */
+    static const uint8_t kAbsolute = 0;
+
+    /** The difference relative to the larger magnitude, |a - b| / max(|a|,|b|). */
+    static const uint8_t kRelative = 1;
+
+    /** The number of representable floats between a and b. */
+    static const uint8_t kUlps = 2;
+};
+
+/** Summary of the errors between 2 arrays computed by compareArrayNear(). */
+struct ArrayNearResult {
+  /** Number of elements whose error is larger than the tolerance, or NaN. */
+  size_t numFailed;
+
+  /**
+   * Index of the first element with the largest error. Set only if numFailed
+   * is not 0.
+   */
+  size_t maxIndex;
+
+  /** The largest error, in ULPs for ArrayNearMode::kUlps. NaN is largest. */
+  float maxError;
+};
+
+/**
+ * Compare the first 'n' elements of 'a' and 'b' using the given
+ * ArrayNearMode. The 'tolerance' is not negative, and is rounded down to an
+ * integer for ArrayNearMode::kUlps. 2 equal elements, including infinities of
+ * the same sign, have no error. An element which is NaN is always out of
+ * tolerance.
+ *
+ * The errors are first summarized by a loop of 2 integer reductions (a count
+ * and a maximum) without branches, which the compiler vectorizes on the host
+ * at -O3. The index of the largest error is found by a second pass, only if an
+ * element is out of tolerance.
+ */
+void compareArrayNear(const float* a, const float* b, size_t n,
+    float tolerance, uint8_t mode, ArrayNearResult& result);
+
 }
 }
 
@@ -0,0 +1,98 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <Arduino.h> // pgm_read_byte()
+#include "string_util.h"
+#include "ComparingPrint.h"
+
+namespace aunit {
+
+using internal::printEscaped;
+
+char ComparingPrint::expectedAt(size_t i) const {
+  return mIsFlash ? (char) pgm_read_byte(mExpected + i) : mExpected[i];
+}
+
+size_t ComparingPrint::write(uint8_t c) {
+  if (isMatch()) {
+    char expected = expectedAt(mNumWritten);
+    if (expected == '\0' || expected != (char) c) {
+      mMismatchOffset = mNumWritten;
+    }
+  }
+  if (!isMatch() && mNumActual < kContextSize) {
+    mActual[mNumActual++] = c;
+  }
+  mNumWritten++;
+  return 1;
+}
+
+size_t ComparingPrint::write(const uint8_t* buffer, size_t size) {
+  if (buffer == nullptr) return 0;
+  for (size_t i = 0; i < size; i++) {
+    write(buffer[i]);
+  }
+  return size;
+}
+
+void ComparingPrint::finish() {
+  if (isMatch() && expectedAt(mNumWritten) != '\0') {
+    mMismatchOffset = mNumWritten;
+  }
+  mIsFinished = true;
+}
+
+bool ComparingPrint::printExpected(Print* printer, size_t begin, size_t end)
+    const {
+  for (size_t i = begin; i < end; i++) {
+    char c = expectedAt(i);
+    if (c == '\0') return false;
+    printEscaped(printer, c);
+  }
+  return expectedAt(end) != '\0';
+}
+
+void ComparingPrint::printMismatch(Print* printer) const {
+  if (isMatch()) return;
+
+  // The bytes before the mismatch are the same in both strings.
+  size_t begin = (mMismatchOffset > kContextSize)
+      ? mMismatchOffset - kContextSize
+      : 0;
+  size_t end = mMismatchOffset + kContextSize;
+
+  printer->print("expected \"");
+  if (begin > 0) printer->print("...");
+  if (printExpected(printer, begin, end)) printer->print("...");
+  printer->print("\" but got \"");
+  if (begin > 0) printer->print("...");
+  printExpected(printer, begin, mMismatchOffset);
+  for (uint8_t i = 0; i < mNumActual; i++) {
+    printEscaped(printer, mActual[i]);
+  }
+  if (mNumWritten > mMismatchOffset + mNumActual) printer->print("...");
+  printer->print('"');
+}
+
+}
@@ -0,0 +1,132 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_COMPARING_PRINT_H
+#define AUNIT_COMPARING_PRINT_H
+
+#include <stddef.h> // size_t
+#include <stdint.h>
+#include <Print.h>
+
+class __FlashStringHelper;
+
+namespace aunit {
+
+/**
+ * An implementation of Print which compares each byte written to it with the
+ * expected string, instead of storing it. This allows an output of any length
+ * to be verified using a constant amount of memory, unlike
+ * aunit::fake::FakePrint which is limited to a small buffer. The expected
+ * string can be in RAM or in flash memory. Usually used through the
+ * assertPrinted() macro:
+ *
+ * @verbatim
+ * assertPrinted(out, F("{\"a\":1,\"b\":[1,2,3]}")) {
+ *   serializer.serialize(out);
+ * }
+ * @endverbatim
+ *
+ * The comparison stops at the first mismatch. The offset of the mismatch is
+ * recorded, along with the next few bytes that were actually written, so that
+ * printMismatch() can show the expected and actual output around it.
+ */
+class ComparingPrint: public Print {
+  public:
+    /** Number of bytes of context which are printed around a mismatch. */
+    static const uint8_t kContextSize = 8;
+
+    /** Value of getMismatchOffset() when the output matches. */
+    static const size_t kNoMismatch = (size_t) -1;
+
+    /** Constructor with an expected string in RAM. */
+    explicit ComparingPrint(const char* expected):
+        mExpected(expected),
+        mIsFlash(false) {}
+
+    /** Constructor with an expected string in flash memory. */
+    explicit ComparingPrint(const __FlashStringHelper* expected):
+        mExpected((const char*) expected),
+        mIsFlash(true) {}
+
+    size_t write(uint8_t c) override;
+
+    size_t write(const uint8_t* buffer, size_t size) override;
+
+    /**
+     * Signal the end of the output. An output which is shorter than the
+     * expected string is a mismatch at its end.
+     */
+    void finish();
+
+    /** Return true after finish() has been called. */
+    bool isFinished() const { return mIsFinished; }
+
+    /**
+     * Return true if the output matches the expected string so far, or
+     * completely after finish().
+     */
+    bool isMatch() const { return mMismatchOffset == kNoMismatch; }
+
+    /** Return the number of bytes written. */
+    size_t getNumWritten() const { return mNumWritten; }
+
+    /**
+     * Return the offset of the first byte which differs from the expected
+     * string, or kNoMismatch.
+     */
+    size_t getMismatchOffset() const { return mMismatchOffset; }
+
+    /**
+     * Print the expected and actual output around the mismatch, escaping the
+     * non-printable characters, for example:
+     * 'expected "...[1,2,3]}" but got "...[1,2,4]}"'.
+     */
+    void printMismatch(Print* printer) const;
+
+  private:
+    // Disable copy-constructor and assignment operator
+    ComparingPrint(const ComparingPrint&) = delete;
+    ComparingPrint& operator=(const ComparingPrint&) = delete;
+
+    /** Return the expected byte at offset i, or NUL at its end. */
+    char expectedAt(size_t i) const;
+
+    /**
+     * Print the expected string from 'begin', up to 'end' or its NUL. Return
+     * true if the expected string continues after 'end'.
+     */
+    bool printExpected(Print* printer, size_t begin, size_t end) const;
+
+    const char* const mExpected;
+    size_t mNumWritten = 0;
+    size_t mMismatchOffset = kNoMismatch;
+    char mActual[kContextSize];
+    uint8_t mNumActual = 0;
+    bool const mIsFlash;
+    bool mIsFinished = false;
+};
+
+}
+
+#endif
@@ -22,7 +22,9 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <string.h> // strlen()
 #include <Print.h>
+#include "Flash.h"
 #include "Compare.h"
 #include "FCString.h"
 
@@ -52,6 +54,24 @@ void FCString::println(Print* printer) const {
   }
 }
 
+size_t FCString::length() const {
+  if (mString.cstring == nullptr) return 0;
+
+  if (mStringType == kCStringType) {
+    return strlen(getCString());
+  } else {
+    return strlen_P((const char*) getFString());
+  }
+}
+
+char FCString::charAt(size_t i) const {
+  if (mStringType == kCStringType) {
+    return getCString()[i];
+  } else {
+    return (char) pgm_read_byte((const char*) getFString() + i);
+  }
+}
+
 int FCString::compareTo(const FCString& that) const {
   if (getType() == FCString::kCStringType) {
       if (that.getType() == FCString::kCStringType) {
@@ -92,5 +112,22 @@ bool FCString::hasSubstring(const char* substring) const {
   }
 }
 
+uint32_t FCString::hash() const {
+  uint32_t hash = 2166136261UL;
+  if (mString.cstring == nullptr) return hash;
+
+  if (mStringType == kCStringType) {
+    for (const char* s = getCString(); *s; s++) {
+      hash = (hash ^ (uint8_t) *s) * 16777619UL;
+    }
+  } else {
+    const char* s = (const char*) getFString();
+    for (char c; (c = pgm_read_byte(s)) != '\0'; s++) {
+      hash = (hash ^ (uint8_t) c) * 16777619UL;
+    }
+  }
+  return hash;
+}
+
 }
 }
@@ -26,6 +26,7 @@ SOFTWARE.
 #define AUNIT_FSTRING_H
 
 #include <stddef.h> // size_t
+#include <stdint.h>
 
 class Print;
 class __FlashStringHelper;
@@ -84,6 +85,15 @@ class FCString {
     /** Get the flash string pointer. */
     const __FlashStringHelper* getFString() const { return mString.fstring; }
 
+    /** Return the number of characters, or 0 for a nullptr. */
+    size_t length() const;
+
+    /**
+     * Return the character at index 'i', reading the flash memory directly
+     * instead of copying the flash string into RAM.
+     */
+    char charAt(size_t i) const;
+
     /** Convenience method for printing an FCString. */
     void print(Print* printer) const;
   
@@ -110,6 +120,13 @@ class FCString {
     /** Determine if given substring exists. */
     bool hasSubstring(const char* substring) const;
 
+    /**
+     * Return the 32-bit FNV-1a hash of the string, which is the same for a
+     * c-string and a flash string of the same characters. Used to identify a
+     * test by its name.
+     */
+    uint32_t hash() const;
+
   private:
     // NOTE: It might be possible just use a (void *) instead of a union.
     union {
@@ -0,0 +1,73 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_FUNCTION_TEST_H
+#define AUNIT_FUNCTION_TEST_H
+
+#include "TestOnce.h"
+
+class __FlashStringHelper;
+
+namespace aunit {
+
+/**
+ * A test whose body is a member function of this class, instead of the once()
+ * method of a new subclass of TestOnce. Created by the simpleTest() macro.
+ *
+ * Each test() macro creates a new class, which needs its own virtual table and
+ * constructor. On AVR, the virtual table is also copied into static memory.
+ * The simpleTest() macro instead creates an explicit specialization of the
+ * body() member function template, which is a plain function with access to
+ * the assertXxx() methods, and an instance of this class which points to it.
+ * All simple tests share the single virtual table of this class.
+ */
+class FunctionTest: public TestOnce {
+  public:
+    /** Pointer to the body of the test. */
+    typedef void (FunctionTest::*Body)();
+
+    /** Constructor. The 'name' is expected to be in PROGMEM. */
+    FunctionTest(const __FlashStringHelper* name, Body body);
+
+    /** Call the body of the test. */
+    void once() override;
+
+    /**
+     * The body of the test identified by the Tag type. Specialized by the
+     * simpleTest() macro. Never defined for the generic case.
+     */
+    template <typename Tag>
+    void body();
+
+  private:
+    // Disable copy-constructor and assignment operator
+    FunctionTest(const FunctionTest&) = delete;
+    FunctionTest& operator=(const FunctionTest&) = delete;
+
+    Body const mBody;
+};
+
+}
+
+#endif
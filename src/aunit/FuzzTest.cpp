@@ -0,0 +1,268 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#if EPOXY_DUINO
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#endif
+#include <Arduino.h>  // Print, SERIAL_PORT_MONITOR
+#include "Flash.h"
+#include "FCString.h"
+#include "Verbosity.h"
+#include "Printer.h"
+#include "FuzzTest.h"
+
+#if EPOXY_DUINO && defined(AUNIT_FUZZ)
+
+// Provided by libFuzzer, for programs which have their own main(), like
+// EpoxyDuino.
+extern "C" int LLVMFuzzerRunDriver(int* argc, char*** argv,
+    int (*callback)(const uint8_t* data, size_t size));
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  return aunit::FuzzTest::testOneInput(data, size);
+}
+
+#endif
+
+namespace aunit {
+
+#if EPOXY_DUINO
+
+namespace {
+
+const char* sCorpusDir = nullptr;
+
+const size_t kMaxPathLength = 256;
+
+bool isDirectory(const char* path) {
+  struct stat st;
+  return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool isRegularFile(const char* path) {
+  struct stat st;
+  return stat(path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+// Copy the name of the test into a normal c-string. A test which was never
+// registered has no name.
+void copyName(const internal::FCString& name, char* dst, size_t size) {
+  if (name.getCString() == nullptr) {
+    dst[0] = '\0';
+    return;
+  } else if (name.getType() == internal::FCString::kCStringType) {
+    strncpy(dst, name.getCString(), size);
+  } else {
+    strncpy_P(dst, (const char*) name.getFString(), size);
+  }
+  dst[size - 1] = '\0';
+}
+
+}
+
+void FuzzTest::setCorpus(const char* dir) {
+  sCorpusDir = dir;
+}
+
+#endif
+
+FuzzTest** FuzzTest::getFuzzRoot() {
+  static FuzzTest* root;
+  return &root;
+}
+
+void FuzzTest::insertFuzz() {
+  FuzzTest** root = getFuzzRoot();
+  mNextFuzz = *root;
+  *root = this;
+}
+
+void FuzzTest::init(const char* name) {
+  Test::init(name);
+  insertFuzz();
+}
+
+void FuzzTest::init(const __FlashStringHelper* name) {
+  Test::init(name);
+  insertFuzz();
+}
+
+void FuzzTest::once() {
+  mNumInputs = 0;
+#if EPOXY_DUINO
+  if (sCorpusDir) {
+    replayDirectory(sCorpusDir);
+    return;
+  }
+#endif
+
+  static const uint8_t kEmpty[1] = {0};
+  mNumInputs = 1;
+  runInput(kEmpty, 0);
+}
+
+bool FuzzTest::runInput(const uint8_t* data, size_t size) {
+  setStatus(kStatusUnknown);
+  setLifeCycle(kLifeCycleSetup);
+  fuzzInput(data, size);
+  return isFailed();
+}
+
+#if EPOXY_DUINO
+
+void FuzzTest::replayDirectory(const char* corpusDir) {
+  Print* printer = Printer::getPrinter();
+
+  // Prefer the subdirectory named after the test, so that the corpora of
+  // several fuzz targets can be kept side by side.
+  char name[kMaxPathLength];
+  copyName(getName(), name, sizeof(name));
+  char dir[kMaxPathLength];
+  int n = snprintf(dir, sizeof(dir), "%s/%s", corpusDir, name);
+  if (name[0] == '\0' || n < 0 || (size_t) n >= sizeof(dir)
+      || !isDirectory(dir)) {
+    snprintf(dir, sizeof(dir), "%s", corpusDir);
+  }
+
+  // Replay the inputs in the order of their names, not in the order of
+  // readdir(), so that a run is reproducible on every file system.
+  struct dirent** entries;
+  int numEntries = scandir(dir, &entries, nullptr, alphasort);
+  if (numEntries < 0) {
+    if (isVerbosity(Verbosity::kAssertionFailed)) {
+      Printer::setMessageVerbosity(Verbosity::kAssertionFailed);
+      printer->print(F("Fuzz "));
+      printer->print(name);
+      printer->print(F(" unable to open corpus '"));
+      printer->print(dir);
+      printer->println(F("'."));
+    }
+    fail();
+    return;
+  }
+
+  char path[kMaxPathLength];
+  for (int i = 0; i < numEntries; i++) {
+    n = snprintf(path, sizeof(path), "%s/%s", dir, entries[i]->d_name);
+    if (n < 0 || (size_t) n >= sizeof(path)) continue;
+    if (!isRegularFile(path)) continue;
+
+    mNumInputs++;
+    bool isRead = replayFile(path);
+    if (!isRead || isFailed()) {
+      if (isVerbosity(Verbosity::kAssertionFailed)) {
+        Printer::setMessageVerbosity(Verbosity::kAssertionFailed);
+        printer->print(F("Fuzz "));
+        printer->print(name);
+        printer->print(isRead
+            ? F(" failed on input '")
+            : F(" unable to read input '"));
+        printer->print(path);
+        printer->println(F("'."));
+      }
+      if (!isRead) fail();
+      break;
+    }
+    if (isDone()) break;
+  }
+  for (int i = 0; i < numEntries; i++) free(entries[i]);
+  free(entries);
+}
+
+bool FuzzTest::replayFile(const char* path) {
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) return false;
+
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  // Allocate exactly the size of the input, so that AddressSanitizer can
+  // catch the reads past its end.
+  uint8_t* data = (uint8_t*) malloc(size > 0 ? size : 1);
+  bool isRead = data != nullptr && size >= 0
+      && fread(data, 1, size, file) == (size_t) size;
+  fclose(file);
+  if (isRead) runInput(data, size);
+  free(data);
+  return isRead;
+}
+
+#endif
+
+#if EPOXY_DUINO && defined(AUNIT_FUZZ)
+
+FuzzTest* FuzzTest::findTarget() {
+  if (! Printer::getPrinter()) {
+    Printer::setPrinter(&SERIAL_PORT_MONITOR);
+  }
+  Print* printer = Printer::getPrinter();
+
+  const char* wanted = getenv("AUNIT_FUZZ_TARGET");
+  FuzzTest* target = nullptr;
+  uint16_t numTargets = 0;
+  for (FuzzTest* p = *getFuzzRoot(); p != nullptr; p = p->mNextFuzz) {
+    numTargets++;
+    if (wanted == nullptr
+        || p->getName().compareToN(wanted, strlen(wanted) + 1) == 0) {
+      target = p;
+    }
+  }
+
+  if (target == nullptr || (wanted == nullptr && numTargets > 1)) {
+    printer->println(F("Set AUNIT_FUZZ_TARGET to one of:"));
+    for (FuzzTest* p = *getFuzzRoot(); p != nullptr; p = p->mNextFuzz) {
+      printer->print(F("  "));
+      p->getName().println(printer);
+    }
+    exit(1);
+  }
+
+  target->enableVerbosity(Verbosity::kAssertionFailed);
+  return target;
+}
+
+int FuzzTest::testOneInput(const uint8_t* data, size_t size) {
+  static FuzzTest* target = findTarget();
+  if (target->runInput(data, size)) {
+    // Make sure that the assertion message is seen before the crash report.
+    Printer::getPrinter()->flush();
+    abort();
+  }
+  return 0;
+}
+
+void FuzzTest::runFuzzer() {
+  int argc = epoxy_argc;
+  char** argv = const_cast<char**>(epoxy_argv);
+  exit(LLVMFuzzerRunDriver(&argc, &argv, LLVMFuzzerTestOneInput));
+}
+
+#endif
+
+}
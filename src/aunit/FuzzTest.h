@@ -0,0 +1,145 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_FUZZ_TEST_H
+#define AUNIT_FUZZ_TEST_H
+
+#include <stddef.h> // size_t
+#include <stdint.h>
+#include "TestOnce.h"
+
+class __FlashStringHelper;
+
+namespace aunit {
+
+/**
+ * A test whose body receives an arbitrary input as a byte buffer, and checks
+ * it using the normal assertion macros. Created by the testFuzz() macro, for
+ * example:
+ *
+ * @verbatim
+ * testFuzz(ParserTest, parse) {
+ *   Parser parser;
+ *   bool ok = parser.parse(data, size);
+ *   assertTrue(ok || parser.hasError());
+ * }
+ * @endverbatim
+ *
+ * It is used in 2 ways:
+ *
+ * 1) When the program is compiled normally, it is an ordinary test which
+ * replays the inputs saved in a corpus directory, given by the `--corpus` flag
+ * on EpoxyDuino. If the directory contains a subdirectory with the name of the
+ * test, the inputs are read from that subdirectory. On other platforms, or
+ * without a corpus, the body is called once with an empty input.
+ *
+ * 2) When the program is compiled on EpoxyDuino with `-DAUNIT_FUZZ` and linked
+ * with libFuzzer, the TestRunner is bypassed, and TestRunner::run() hands
+ * control to libFuzzer, which calls the body of the fuzz target directly
+ * through LLVMFuzzerTestOneInput(). A failed assertion calls abort(), so that
+ * libFuzzer records the input as a crash. If the program has more than one
+ * testFuzz() test, the target must be selected by setting the AUNIT_FUZZ_TARGET
+ * environment variable to its name.
+ */
+class FuzzTest: public TestOnce {
+  public:
+  #if EPOXY_DUINO
+    /** Set the corpus directory whose inputs are replayed by once(). */
+    static void setCorpus(const char* dir);
+  #endif
+
+  #if EPOXY_DUINO && defined(AUNIT_FUZZ)
+    /**
+     * Pass the given input to the selected fuzz target. Called by
+     * LLVMFuzzerTestOneInput() when compiled with AUNIT_FUZZ. Calls abort()
+     * if an assertion fails.
+     */
+    static int testOneInput(const uint8_t* data, size_t size);
+
+    /**
+     * Run libFuzzer on the selected fuzz target, then exit. Called by
+     * TestRunner::run() when compiled with AUNIT_FUZZ.
+     */
+    static void runFuzzer();
+  #endif
+
+    /** Constructor. */
+    FuzzTest() {}
+
+    /** Replay the inputs of the corpus. */
+    void once() override;
+
+    /** User-provided body, called once for each input. */
+    virtual void fuzzInput(const uint8_t* data, size_t size) = 0;
+
+    /** Return the number of inputs which were run by once(). */
+    uint16_t getNumInputs() const { return mNumInputs; }
+
+  protected:
+    /**
+     * Register the test with the TestRunner and as a fuzz target. Instances
+     * which are not initialized are neither run nor fuzzed.
+     */
+    void init(const char* name);
+
+    /** Same as init(const char*) using a flash string. */
+    void init(const __FlashStringHelper* name);
+
+  private:
+    // Disable copy-constructor and assignment operator
+    FuzzTest(const FuzzTest&) = delete;
+    FuzzTest& operator=(const FuzzTest&) = delete;
+
+    /** Return the root of the list of registered fuzz targets. */
+    static FuzzTest** getFuzzRoot();
+
+    /** Add this test to the list of fuzz targets. */
+    void insertFuzz();
+
+    /** Run the body on a single input. Return true if it failed. */
+    bool runInput(const uint8_t* data, size_t size);
+
+  #if EPOXY_DUINO && defined(AUNIT_FUZZ)
+    /**
+     * Return the fuzz target selected by AUNIT_FUZZ_TARGET, after preparing
+     * it to print the assertion messages.
+     */
+    static FuzzTest* findTarget();
+  #endif
+
+  #if EPOXY_DUINO
+    /** Replay each file of the directory. */
+    void replayDirectory(const char* dir);
+
+    /** Replay the given file. Return false if it could not be read. */
+    bool replayFile(const char* path);
+  #endif
+
+    FuzzTest* mNextFuzz = nullptr;
+    uint16_t mNumInputs = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,247 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdlib.h> // defines __GLIBC__ or __NEWLIB__
+#include <Arduino.h> // Print
+#include "Flash.h"
+#include "Printer.h"
+#include "Test.h"
+#include "HeapMonitor.h"
+
+// The malloc() family is replaced only in the programs compiled with
+// -DAUNIT_HEAP_MONITOR, so that the other programs keep the allocator of the
+// C library untouched. The sanitizers replace the malloc() family themselves,
+// so the allocations are not tracked under them.
+#if EPOXY_DUINO && defined(AUNIT_HEAP_MONITOR) && defined(__GLIBC__) \
+    && ! defined(__SANITIZE_ADDRESS__) && ! defined(__SANITIZE_THREAD__)
+  #define AUNIT_HEAP_INTERPOSE 1
+  #include <errno.h> // ENOMEM
+  #include <malloc.h> // malloc_usable_size()
+#elif defined(__arm__) && defined(__NEWLIB__)
+  #define AUNIT_HEAP_MALLINFO 1
+  #include <malloc.h> // mallinfo()
+#endif
+
+#if AUNIT_HEAP_INTERPOSE
+
+// Replace the malloc() family of glibc, forwarding to its internal
+// implementation. Every function which returns a block that can be passed to
+// free() must be replaced, otherwise free() subtracts bytes which were never
+// added. The operator new and delete of libstdc++ call malloc() and
+// free(), so they are tracked as well. The usable size of each block is used
+// instead of the requested size, so that free() can subtract the same amount.
+// The counters are updated atomically in case the test creates threads.
+
+static uint32_t sAllocationCount;
+static size_t sBytesInUse;
+
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void* __libc_valloc(size_t size);
+void* __libc_pvalloc(size_t size);
+void __libc_free(void* ptr);
+
+static void recordAllocation(void* ptr) {
+  if (ptr == nullptr) return;
+  __atomic_add_fetch(&sAllocationCount, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&sBytesInUse, malloc_usable_size(ptr), __ATOMIC_RELAXED);
+}
+
+static void recordFree(void* ptr) {
+  if (ptr == nullptr) return;
+  __atomic_sub_fetch(&sBytesInUse, malloc_usable_size(ptr), __ATOMIC_RELAXED);
+}
+
+void* malloc(size_t size) {
+  void* ptr = __libc_malloc(size);
+  recordAllocation(ptr);
+  return ptr;
+}
+
+void* calloc(size_t count, size_t size) {
+  void* ptr = __libc_calloc(count, size);
+  recordAllocation(ptr);
+  return ptr;
+}
+
+void* realloc(void* ptr, size_t size) {
+  if (ptr == nullptr) return malloc(size);
+  size_t oldSize = malloc_usable_size(ptr);
+  void* newPtr = __libc_realloc(ptr, size);
+  if (newPtr != nullptr) {
+    // A realloc() which grows the block counts as a new allocation.
+    size_t newSize = malloc_usable_size(newPtr);
+    __atomic_add_fetch(&sBytesInUse, newSize, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&sBytesInUse, oldSize, __ATOMIC_RELAXED);
+    if (newSize > oldSize) {
+      __atomic_add_fetch(&sAllocationCount, 1, __ATOMIC_RELAXED);
+    }
+  } else if (size == 0) {
+    __atomic_sub_fetch(&sBytesInUse, oldSize, __ATOMIC_RELAXED);
+  }
+  return newPtr;
+}
+
+void* memalign(size_t alignment, size_t size) {
+  void* ptr = __libc_memalign(alignment, size);
+  recordAllocation(ptr);
+  return ptr;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+  return memalign(alignment, size);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) {
+  void* ptr = memalign(alignment, size);
+  if (ptr == nullptr) return ENOMEM;
+  *result = ptr;
+  return 0;
+}
+
+void* valloc(size_t size) {
+  void* ptr = __libc_valloc(size);
+  recordAllocation(ptr);
+  return ptr;
+}
+
+void* pvalloc(size_t size) {
+  void* ptr = __libc_pvalloc(size);
+  recordAllocation(ptr);
+  return ptr;
+}
+
+void* reallocarray(void* ptr, size_t count, size_t size) {
+  size_t total;
+  if (__builtin_mul_overflow(count, size, &total)) {
+    errno = ENOMEM;
+    return nullptr;
+  }
+  return realloc(ptr, total);
+}
+
+void free(void* ptr) {
+  recordFree(ptr);
+  __libc_free(ptr);
+}
+
+}
+
+#endif
+
+namespace aunit {
+
+bool HeapMonitor::isCountSupported() {
+#if AUNIT_HEAP_INTERPOSE
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool HeapMonitor::isUsageSupported() {
+#if AUNIT_HEAP_INTERPOSE || AUNIT_HEAP_MALLINFO
+  return true;
+#else
+  return false;
+#endif
+}
+
+uint32_t HeapMonitor::getAllocationCount() {
+#if AUNIT_HEAP_INTERPOSE
+  return __atomic_load_n(&sAllocationCount, __ATOMIC_RELAXED);
+#else
+  return 0;
+#endif
+}
+
+size_t HeapMonitor::getBytesInUse() {
+#if AUNIT_HEAP_INTERPOSE
+  return __atomic_load_n(&sBytesInUse, __ATOMIC_RELAXED);
+#elif AUNIT_HEAP_MALLINFO
+  return mallinfo().uordblks;
+#else
+  return 0;
+#endif
+}
+
+void HeapMonitor::testStarting(Test& test) {
+  // The test is isolated only if no other test is running, and no other test
+  // starts before it finishes.
+  mIsIsolated = (mNumActiveTests == 0);
+  mNumActiveTests++;
+  mTest = &test;
+  mStartCount = getAllocationCount();
+  mStartBytes = getBytesInUse();
+}
+
+void HeapMonitor::testFinished(Test& test) {
+  mNumActiveTests--;
+  if (! mIsIsolated || mTest != &test) {
+    mAllocations = 0;
+    mLeakedBytes = 0;
+    return;
+  }
+
+  mAllocations = getAllocationCount() - mStartCount;
+  mLeakedBytes = (long) getBytesInUse() - (long) mStartBytes;
+
+  Print* printer = Printer::getPrinter();
+  if (isCountSupported()) {
+    printer->print(F("Test "));
+    test.getName().print(printer);
+    printer->print(F(" allocations: "));
+    printer->print((unsigned long) mAllocations);
+    printer->println('.');
+  }
+
+  // Freeing memory which was allocated by an earlier test is not a leak.
+  if (mLeakedBytes > 0) {
+    printer->print(F("Test "));
+    test.getName().print(printer);
+    printer->print(F(" leaked "));
+    printer->print(mLeakedBytes);
+    printer->println(F(" bytes."));
+    test.setStatus(Test::kStatusFailed);
+  }
+}
+
+namespace internal {
+
+void AllocationScope::finish() {
+  if (HeapMonitor::isCountSupported()) {
+    mCount = HeapMonitor::getAllocationCount() - mCount;
+  } else {
+    mCount = (HeapMonitor::getBytesInUse() > mBytes) ? 1 : 0;
+  }
+  mIsFinished = true;
+}
+
+}
+
+}
@@ -0,0 +1,142 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_HEAP_MONITOR_H
+#define AUNIT_HEAP_MONITOR_H
+
+#include <stddef.h> // size_t
+#include <stdint.h>
+#include "TestListener.h"
+
+namespace aunit {
+
+/**
+ * A TestListener which tracks the heap allocations of each test, and fails the
+ * tests which leak memory, i.e. whose net heap usage increased between their
+ * setup() and their teardown(). Usage:
+ *
+ * @verbatim
+ * aunit::HeapMonitor heapMonitor;
+ *
+ * void setup() {
+ *   ...
+ *   TestRunner::addListener(&heapMonitor);
+ * }
+ * @endverbatim
+ *
+ * The tracking depends on the platform:
+ *
+ *  - EpoxyDuino on Linux (glibc), when the program is compiled with
+ *    -DAUNIT_HEAP_MONITOR: the malloc() family and free() (and therefore also
+ *    new and delete) are interposed, so that both the number of allocations
+ *    and the bytes in use are tracked.
+ *  - ARM processors using newlib (e.g. SAMD, STM32, Teensy): the bytes in use
+ *    are retrieved from mallinfo(), but the allocations are not counted.
+ *  - all others: nothing is tracked, and the tests which use the
+ *    assertNoAllocations or assertAllocationsAtMost() macros are skipped.
+ *
+ * A testing() test which is interleaved with other tests is not checked,
+ * because the allocations of the other tests cannot be separated from its own.
+ *
+ * The static methods can be used without registering a HeapMonitor with the
+ * TestRunner. They are used by the assertNoAllocations and
+ * assertAllocationsAtMost() macros.
+ */
+class HeapMonitor: public TestListener {
+  public:
+    /** Return true if the allocations are counted on this platform. */
+    static bool isCountSupported();
+
+    /** Return true if the heap usage is tracked on this platform. */
+    static bool isUsageSupported();
+
+    /**
+     * Return the number of allocations since the start of the program, or 0
+     * if not supported.
+     */
+    static uint32_t getAllocationCount();
+
+    /**
+     * Return the number of bytes currently allocated on the heap, or 0 if not
+     * supported. The bytes include the padding added by the allocator.
+     */
+    static size_t getBytesInUse();
+
+    /** Return the number of allocations made by the most recent test. */
+    uint32_t getAllocations() const { return mAllocations; }
+
+    /**
+     * Return the net number of bytes allocated by the most recent test, which
+     * was not freed by its teardown().
+     */
+    long getLeakedBytes() const { return mLeakedBytes; }
+
+    void testStarting(Test& test) override;
+    void testFinished(Test& test) override;
+
+  private:
+    const Test* mTest = nullptr;
+    uint16_t mNumActiveTests = 0;
+    bool mIsIsolated = false;
+    uint32_t mStartCount = 0;
+    size_t mStartBytes = 0;
+    uint32_t mAllocations = 0;
+    long mLeakedBytes = 0;
+};
+
+namespace internal {
+
+/**
+ * Captures the allocations made inside the block of the assertNoAllocations
+ * and assertAllocationsAtMost() macros. On platforms which track only the heap
+ * usage, an increase of the heap usage is counted as a single allocation, so
+ * only the allocations which are still alive at the end of the block are
+ * detected.
+ */
+class AllocationScope {
+  public:
+    AllocationScope():
+        mCount(HeapMonitor::getAllocationCount()),
+        mBytes(HeapMonitor::getBytesInUse()) {}
+
+    /** Return true after finish() has been called. */
+    bool isFinished() const { return mIsFinished; }
+
+    /** Compute the number of allocations since the constructor. */
+    void finish();
+
+    /** Return the number of allocations inside the block. */
+    uint32_t getCount() const { return mCount; }
+
+  private:
+    uint32_t mCount;
+    size_t mBytes;
+    bool mIsFinished = false;
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,155 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <Arduino.h> // F(), Print
+#include "Printer.h"
+#include "Verbosity.h"
+#include "Test.h"
+#include "TestRunner.h"
+#include "IsrMonitor.h"
+
+// Keeps the compiler from moving the accesses to a record across the update
+// of the index which publishes it. A single core needs no hardware barrier
+// against its own interrupt handlers. On EpoxyDuino, the std::atomic indexes
+// already order the accesses between the threads.
+#if EPOXY_DUINO
+  #define AUNIT_ISR_BARRIER()
+#else
+  #define AUNIT_ISR_BARRIER() __asm__ __volatile__("" ::: "memory")
+#endif
+
+namespace aunit {
+
+namespace {
+
+void printValue(Print* printer, const IsrRecord& record, long value) {
+  if (record.isUnsigned) {
+    printer->print((unsigned long) value);
+  } else {
+    printer->print(value);
+  }
+}
+
+}
+
+IsrMonitor* IsrMonitor::sInstance = nullptr;
+
+IsrMonitor::IsrMonitor(IsrRecord* records, uint8_t size):
+    mRecords(records),
+    mSize(size) {
+  sInstance = this;
+  TestRunner::sDrainIsrHook = &drainHook;
+}
+
+void IsrMonitor::testStarting(Test& /*test*/) {
+  drain(nullptr);
+}
+
+void IsrMonitor::testFinished(Test& test) {
+  drain(&test);
+}
+
+uint16_t IsrMonitor::getNumDropped() const {
+  // Read until stable, because the 2 bytes of a uint16_t are read separately
+  // on an 8-bit processor, and an interrupt may increment it in between.
+  uint16_t n;
+  do {
+    n = mNumDropped;
+  } while (n != mNumDropped);
+  return n;
+}
+
+void IsrMonitor::isrAssertion(const char* file, uint16_t line, long lhs,
+    const char* opName, bool (*op)(long lhs, long rhs), long rhs) {
+  if (op(lhs, rhs) || sInstance == nullptr) return;
+  sInstance->push(IsrRecord{file, opName, lhs, rhs, line, false});
+}
+
+void IsrMonitor::isrAssertion(const char* file, uint16_t line,
+    unsigned long lhs, const char* opName,
+    bool (*op)(unsigned long lhs, unsigned long rhs), unsigned long rhs) {
+  if (op(lhs, rhs) || sInstance == nullptr) return;
+  sInstance->push(IsrRecord{file, opName, (long) lhs, (long) rhs, line, true});
+}
+
+void IsrMonitor::drainHook(Test& test) {
+  sInstance->drain(&test);
+}
+
+void IsrMonitor::push(const IsrRecord& record) {
+  uint8_t head = mHead;
+  uint8_t next = (head + 1 == mSize) ? 0 : head + 1;
+  if (next == mTail) {
+    mNumDropped = mNumDropped + 1;
+    return;
+  }
+  mRecords[head] = record;
+  AUNIT_ISR_BARRIER();
+  mHead = next;
+}
+
+void IsrMonitor::drain(Test* test) {
+  Print* printer = Printer::getPrinter();
+  bool isFailed = false;
+
+  uint8_t tail = mTail;
+  while (tail != mHead) {
+    AUNIT_ISR_BARRIER();
+    IsrRecord record = mRecords[tail];
+    AUNIT_ISR_BARRIER();
+    tail = (tail + 1 == mSize) ? 0 : tail + 1;
+    mTail = tail;
+
+    // Don't use F() strings here, same as printAssertionMessage().
+    Printer::setMessageVerbosity(Verbosity::kAssertionFailed);
+    printer->print(record.file);
+    printer->print(':');
+    printer->print(record.line);
+    printer->print(": ISR assertion failed: (");
+    printValue(printer, record, record.lhs);
+    printer->print(") ");
+    printer->print(record.opName);
+    printer->print(" (");
+    printValue(printer, record, record.rhs);
+    printer->print(')');
+    printer->println('.');
+    isFailed = true;
+  }
+
+  uint16_t numDropped = getNumDropped();
+  if (numDropped != mNumReportedDropped) {
+    Printer::setMessageVerbosity(Verbosity::kAssertionFailed);
+    printer->print(F("ISR assertions dropped: "));
+    printer->print((unsigned) (numDropped - mNumReportedDropped));
+    printer->println('.');
+    mNumReportedDropped = numDropped;
+    isFailed = true;
+  }
+
+  if (isFailed && test != nullptr) {
+    test->setStatus(Test::kStatusFailed);
+  }
+}
+
+}
@@ -0,0 +1,167 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_ISR_MONITOR_H
+#define AUNIT_ISR_MONITOR_H
+
+#if EPOXY_DUINO
+#include <atomic>
+#endif
+#include <stdint.h>
+#include "TestListener.h"
+
+namespace aunit {
+
+/**
+ * A failed assertion made by an interrupt handler. Only the values are kept,
+ * so the record takes 15 bytes on AVR. The values of an unsigned comparison
+ * are stored as long, and printed as unsigned long.
+ */
+struct IsrRecord {
+  const char* file;
+  const char* opName;
+  long lhs;
+  long rhs;
+  uint16_t line;
+  bool isUnsigned;
+};
+
+namespace internal {
+
+/**
+ * The type to which the operands of an isrAssertXxx() macro are converted,
+ * given the type T of their sum, i.e. the type of their comparison after the
+ * usual arithmetic conversions. Floating point and 64-bit operands do not
+ * compile.
+ */
+template <typename T>
+struct IsrOperand {
+  static_assert(sizeof(T) == 0,
+      "isrAssertXxx() supports only integers no wider than long");
+};
+
+template <> struct IsrOperand<int> { typedef long type; };
+template <> struct IsrOperand<long> { typedef long type; };
+template <> struct IsrOperand<unsigned int> { typedef unsigned long type; };
+template <> struct IsrOperand<unsigned long> { typedef unsigned long type; };
+
+}
+
+/**
+ * A TestListener which collects the failed isrAssertXxx() assertions made by
+ * the interrupt handlers, and reports them from the loop() context of the
+ * TestRunner, where printing is safe. Each failed assertion is attributed to
+ * the test which is running, and fails it. Usage:
+ *
+ * @verbatim
+ * aunit::IsrRecord isrRecords[8];
+ * aunit::IsrMonitor isrMonitor(isrRecords, 8);
+ *
+ * void onTimer() {
+ *   isrAssertLess(ticks, kMaxTicks);
+ * }
+ *
+ * void setup() {
+ *   ...
+ *   TestRunner::addListener(&isrMonitor);
+ * }
+ * @endverbatim
+ *
+ * The records are kept in a lock-free ring buffer with a single producer (the
+ * interrupt handlers) and a single consumer (the TestRunner), so it never
+ * disables the interrupts. A ring of 'size' records holds 'size - 1' failed
+ * assertions. When it is full, the new assertion is dropped and counted, and
+ * the next test to be reported is failed. Interrupt handlers which can
+ * preempt each other (e.g. nested priorities on ARM) count as several
+ * producers, and must not both use the isrAssertXxx() macros.
+ *
+ * The ring is drained after each call to the loop() of the test, and after
+ * its teardown(). The assertions made between 2 tests are printed, but do not
+ * fail any test. Only one IsrMonitor can be defined. On EpoxyDuino, it keeps
+ * all the tests on the main thread, even with TestRunner::setJobs(), so that
+ * each assertion is attributed to the only test which is running.
+ */
+class IsrMonitor: public TestListener {
+  public:
+    /** Constructor. The 'records' must have at least 2 elements. */
+    IsrMonitor(IsrRecord* records, uint8_t size);
+
+    void testStarting(Test& test) override;
+
+    void testFinished(Test& test) override;
+
+    /** Return the number of assertions dropped because the ring was full. */
+    uint16_t getNumDropped() const;
+
+    /**
+     * Record a failed assertion if 'op(lhs, rhs)' is false. Called by the
+     * isrAssertXxx() macros, from any interrupt handler.
+     */
+    static void isrAssertion(const char* file, uint16_t line, long lhs,
+        const char* opName, bool (*op)(long lhs, long rhs), long rhs);
+
+    /** Same as above, for an unsigned comparison. */
+    static void isrAssertion(const char* file, uint16_t line,
+        unsigned long lhs, const char* opName,
+        bool (*op)(unsigned long lhs, unsigned long rhs), unsigned long rhs);
+
+  private:
+  #if EPOXY_DUINO
+    // An "interrupt" is simulated by another thread.
+    typedef std::atomic<uint8_t> Index;
+    typedef std::atomic<uint16_t> DropCounter;
+  #else
+    typedef volatile uint8_t Index;
+    typedef volatile uint16_t DropCounter;
+  #endif
+
+    // Disable copy-constructor and assignment operator
+    IsrMonitor(const IsrMonitor&) = delete;
+    IsrMonitor& operator=(const IsrMonitor&) = delete;
+
+    /** Installed as TestRunner::sDrainIsrHook. */
+    static void drainHook(Test& test);
+
+    /** Add a record to the ring, or count it as dropped. */
+    void push(const IsrRecord& record);
+
+    /**
+     * Print the pending records, and fail the test if any. The 'test' is
+     * nullptr between 2 tests.
+     */
+    void drain(Test* test);
+
+    static IsrMonitor* sInstance;
+
+    IsrRecord* const mRecords;
+    uint8_t const mSize;
+    Index mHead{0}; // written by the producer
+    Index mTail{0}; // written by the consumer
+    DropCounter mNumDropped{0}; // written by the producer
+    uint16_t mNumReportedDropped = 0;
+};
+
+}
+
+#endif
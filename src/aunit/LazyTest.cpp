@@ -0,0 +1,77 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "LazyTest.h"
+
+namespace aunit {
+
+LazyTest::LazyTest(const __FlashStringHelper* name, const TestSuite* suite,
+    Factory factory, Destroyer destroyer):
+  mSuite(suite),
+  mFactory(factory),
+  mDestroyer(destroyer) {
+  init(name);
+}
+
+void LazyTest::setup() {
+  startFixture();
+}
+
+void LazyTest::loop() {
+  // If the arena was in use during setup(), keep trying on each iteration.
+  // The TestRunner moves on to the other tests in the meantime.
+  if (mFixture == nullptr) {
+    startFixture();
+    return;
+  }
+
+  mFixture->loop();
+  copyStatus();
+}
+
+void LazyTest::teardown() {
+  if (mFixture == nullptr) return;
+
+  mFixture->teardown();
+  mDestroyer(mFixture);
+  mFixture = nullptr;
+}
+
+bool LazyTest::startFixture() {
+  mFixture = mFactory();
+  if (mFixture == nullptr) return false;
+
+  mFixture->enableVerbosity(getVerbosity());
+  mFixture->setup();
+  copyStatus();
+  return true;
+}
+
+void LazyTest::copyStatus() {
+  if (mFixture->isDone()) {
+    setStatus(mFixture->getStatus());
+  }
+}
+
+}
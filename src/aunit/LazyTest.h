@@ -0,0 +1,192 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_LAZY_TEST_H
+#define AUNIT_LAZY_TEST_H
+
+#include <stddef.h> // size_t
+#if defined(ARDUINO_ARCH_AVR)
+  #include <new.h> // placement new
+#else
+  #include <new> // placement new
+#endif
+#if EPOXY_DUINO
+  #include <atomic>
+#endif
+#include "Test.h"
+
+/**
+ * Size of the arena in which the fixtures of the lazyTestF() and
+ * lazyTestingF() tests are constructed. It can be overridden by defining it
+ * before including AUnit.h. A fixture which does not fit causes a compiler
+ * error.
+ */
+#ifndef AUNIT_FIXTURE_ARENA_SIZE
+  #define AUNIT_FIXTURE_ARENA_SIZE 128
+#endif
+
+class __FlashStringHelper;
+
+namespace aunit {
+
+class TestSuite;
+
+/**
+ * A proxy for a test whose fixture is constructed only while the test is
+ * running, instead of being a static instance for the entire program. Created
+ * by the lazyTestF() and lazyTestingF() macros. The proxy holds only the name
+ * of the test and the functions which construct and destroy the fixture. The
+ * fixture is placement-constructed into a static arena just before its
+ * setup(), and destroyed just after its teardown(), so the static memory
+ * consumed by all fixtures is the size of the arena, instead of the sum of the
+ * sizes of the fixtures.
+ *
+ * Only one fixture can occupy an arena at a time. If the arena is still in use
+ * by another lazyTestingF() test, the test waits until the arena becomes
+ * available, so lazyTestingF() tests run one after the other instead of being
+ * interleaved.
+ */
+class LazyTest: public Test {
+  public:
+    /**
+     * Construct the fixture in the arena, and return it. Return nullptr if the
+     * arena is in use.
+     */
+    typedef Test* (*Factory)();
+
+    /** Destroy the fixture, and release the arena. */
+    typedef void (*Destroyer)(Test* fixture);
+
+    /**
+     * Constructor. The 'name' is expected to be in PROGMEM. The 'suite' is
+     * the suite of the fixture class, or nullptr.
+     */
+    LazyTest(const __FlashStringHelper* name, const TestSuite* suite,
+        Factory factory, Destroyer destroyer);
+
+    const TestSuite* getSuite() const override { return mSuite; }
+
+    /** Construct the fixture, then call its setup(). */
+    void setup() override;
+
+    /** Call the loop() of the fixture, and copy its status. */
+    void loop() override;
+
+    /** Call the teardown() of the fixture, then destroy it. */
+    void teardown() override;
+
+    /** Return the fixture, or nullptr if the test is not running. */
+    Test* getFixture() const { return mFixture; }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    LazyTest(const LazyTest&) = delete;
+    LazyTest& operator=(const LazyTest&) = delete;
+
+    /**
+     * Construct the fixture and call its setup(). Return false if the arena
+     * is in use.
+     */
+    bool startFixture();
+
+    /** Copy the status of the fixture once it has been resolved. */
+    void copyStatus();
+
+    const TestSuite* const mSuite;
+    Factory const mFactory;
+    Destroyer const mDestroyer;
+    Test* mFixture = nullptr;
+};
+
+namespace internal {
+
+/**
+ * A static buffer of N bytes, aligned for any fixture. Each arena size is a
+ * different instantiation, so files using different values of
+ * AUNIT_FIXTURE_ARENA_SIZE do not overflow each other's arena.
+ */
+template <size_t N>
+struct FixtureArena {
+  union Storage {
+    unsigned char bytes[N];
+    long long alignLongLong;
+    long double alignLongDouble;
+    void* alignPointer;
+  };
+
+  static Storage sStorage;
+#if EPOXY_DUINO
+  // The tests may run on several threads, see TestRunner::setJobs().
+  static std::atomic<bool> sIsBusy;
+#else
+  static bool sIsBusy;
+#endif
+
+  /** Claim the arena. Return false if it is in use. */
+  static bool acquire() {
+  #if EPOXY_DUINO
+    return !sIsBusy.exchange(true);
+  #else
+    if (sIsBusy) return false;
+    sIsBusy = true;
+    return true;
+  #endif
+  }
+
+  /** Release the arena. */
+  static void release() { sIsBusy = false; }
+};
+
+template <size_t N>
+typename FixtureArena<N>::Storage FixtureArena<N>::sStorage;
+
+#if EPOXY_DUINO
+template <size_t N>
+std::atomic<bool> FixtureArena<N>::sIsBusy(false);
+#else
+template <size_t N>
+bool FixtureArena<N>::sIsBusy = false;
+#endif
+
+/** Implementation of LazyTest::Factory for the fixture T. */
+template <typename T, size_t N>
+Test* createFixture() {
+  static_assert(sizeof(T) <= N,
+      "Fixture too large, increase AUNIT_FIXTURE_ARENA_SIZE");
+  if (!FixtureArena<N>::acquire()) return nullptr;
+  return new (FixtureArena<N>::sStorage.bytes) T();
+}
+
+/** Implementation of LazyTest::Destroyer for the fixture T. */
+template <typename T, size_t N>
+void destroyFixture(Test* fixture) {
+  static_cast<T*>(fixture)->~T();
+  FixtureArena<N>::release();
+}
+
+}
+
+}
+
+#endif
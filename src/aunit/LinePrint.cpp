@@ -0,0 +1,78 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#if EPOXY_DUINO
+
+#include "Printer.h"
+#include "Verbosity.h"
+#include "LinePrint.h"
+
+namespace aunit {
+namespace internal {
+
+std::mutex& LinePrint::getMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+size_t LinePrint::write(uint8_t c) {
+  if (mLength == 0) {
+    mVerbosity = Printer::getMessageVerbosity();
+  }
+  mBuffer[mLength++] = c;
+  if (c == '\n') {
+    flush();
+    Printer::setMessageVerbosity(Verbosity::kNone);
+  } else if (mLength == kBufSize) {
+    flush();
+  }
+  return 1;
+}
+
+size_t LinePrint::write(const uint8_t* buffer, size_t size) {
+  if (buffer == nullptr) return 0;
+  for (size_t i = 0; i < size; i++) {
+    write(buffer[i]);
+  }
+  return size;
+}
+
+void LinePrint::flush() {
+  if (mLength == 0) return;
+
+  uint8_t verbosity = Printer::getMessageVerbosity();
+  Printer::setMessageVerbosity(mVerbosity);
+  {
+    std::lock_guard<std::mutex> lock(getMutex());
+    Print* target = mTarget ? mTarget : Printer::sPrinter;
+    target->write((const uint8_t*) mBuffer, mLength);
+  }
+  Printer::setMessageVerbosity(verbosity);
+  mLength = 0;
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,92 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_LINE_PRINT_H
+#define AUNIT_LINE_PRINT_H
+
+#if EPOXY_DUINO
+
+#include <stddef.h> // size_t
+#include <stdint.h>
+#include <mutex>
+#include <Print.h>
+
+namespace aunit {
+namespace internal {
+
+/**
+ * A Print which collects the output of a single thread one line at a time,
+ * and writes each line to its target printer while holding the lock returned
+ * by getMutex(). The lines of several threads can then be interleaved, but
+ * not their characters. The Verbosity flag of each line (see
+ * Printer::setMessageVerbosity()) is restored while it is written, so that a
+ * TeePrint can still select it.
+ *
+ * Used by Printer::getPrinter() for the threads created by a test, and by
+ * Assertion::stress(). Available only on EpoxyDuino.
+ */
+class LinePrint: public Print {
+  public:
+    /** Size of the line buffer. A longer line is written in several pieces. */
+    static const uint8_t kBufSize = 128;
+
+    /**
+     * Constructor. If 'target' is nullptr, the lines are written to the
+     * printer given to Printer::setPrinter().
+     */
+    explicit LinePrint(Print* target): mTarget(target) {}
+
+    /** Write the incomplete line, if any. */
+    ~LinePrint() { flush(); }
+
+    size_t write(uint8_t c) override;
+
+    size_t write(const uint8_t* buffer, size_t size) override;
+
+    /** Write the buffered bytes to the target, even without a newline. */
+    void flush() override;
+
+    /**
+     * Return the lock held while a line is written to a printer shared by
+     * several threads.
+     */
+    static std::mutex& getMutex();
+
+  private:
+    // Disable copy-constructor and assignment operator
+    LinePrint(const LinePrint&) = delete;
+    LinePrint& operator=(const LinePrint&) = delete;
+
+    Print* const mTarget;
+    uint8_t mLength = 0;
+    uint8_t mVerbosity = 0;
+    char mBuffer[kBufSize];
+};
+
+}
+}
+
+#endif
+
+#endif
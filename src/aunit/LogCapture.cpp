@@ -0,0 +1,106 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <Arduino.h> // Print
+#include "Flash.h"
+#include "Printer.h"
+#include "Verbosity.h"
+#include "Test.h"
+#include "LogCapture.h"
+
+namespace aunit {
+
+size_t LogCapture::write(uint8_t c) {
+  if (! isCapturing()) {
+    // Forward to the Printer, unless it is this object.
+    Print* printer = Printer::getPrinter();
+    return (printer && printer != this) ? printer->write(c) : 0;
+  }
+  if (mSize == 0) {
+    mDropped++;
+    return 1;
+  }
+
+  mBuffer[mHead] = c;
+  mHead = (mHead + 1 < mSize) ? mHead + 1 : 0;
+  if (mLength < mSize) {
+    mLength++;
+  } else {
+    mDropped++;
+  }
+  return 1;
+}
+
+size_t LogCapture::write(const uint8_t* buffer, size_t size) {
+  if (buffer == nullptr) return 0;
+  if (! isCapturing()) {
+    Print* printer = Printer::getPrinter();
+    return (printer && printer != this) ? printer->write(buffer, size) : 0;
+  }
+  for (size_t i = 0; i < size; i++) {
+    write(buffer[i]);
+  }
+  return size;
+}
+
+void LogCapture::replay(Print* printer) {
+  // The captured output is a mixture of messages, so it is not tagged.
+  Printer::setMessageVerbosity(Verbosity::kNone);
+  if (mDropped > 0) {
+    printer->print(F("LogCapture: "));
+    printer->print((unsigned long) mDropped);
+    printer->println(F(" byte(s) dropped"));
+  }
+
+  // The oldest byte is at mHead when the buffer is full, otherwise at 0.
+  uint16_t tail = (mLength < mSize) ? 0 : mHead;
+  uint16_t firstLength = (mLength < mSize) ? mLength : mSize - tail;
+  printer->write((const uint8_t*) mBuffer + tail, firstLength);
+  printer->write((const uint8_t*) mBuffer, mLength - firstLength);
+  clear();
+}
+
+void LogCapture::testStarting(Test& /*test*/) {
+  if (mNumRunning++ > 0) return;
+
+  clear();
+  mPrinter = Printer::getPrinter();
+  Printer::setPrinter(this);
+}
+
+void LogCapture::testFinished(Test& test) {
+  if (mNumRunning == 0) return;
+
+  mNumRunning--;
+  if (! isCapturing()) {
+    Printer::setPrinter(mPrinter);
+  }
+  if (test.isFailed() || test.isExpired()) {
+    replay(mPrinter);
+  } else if (! isCapturing()) {
+    clear();
+  }
+}
+
+}
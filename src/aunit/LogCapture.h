@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_LOG_CAPTURE_H
+#define AUNIT_LOG_CAPTURE_H
+
+#include <stddef.h> // size_t
+#include <stdint.h>
+#include <Print.h>
+#include "TestListener.h"
+
+namespace aunit {
+
+/**
+ * A TestListener which captures the output of each test into a ring buffer,
+ * instead of printing it, and prints it only if the test fails or times out.
+ * The buffer is supplied by the caller, so no heap allocation is needed.
+ * Usage:
+ *
+ * @verbatim
+ * char logBuffer[512];
+ * aunit::LogCapture logCapture(logBuffer, sizeof(logBuffer));
+ *
+ * void setup() {
+ *   ...
+ *   TestRunner::addListener(&logCapture);
+ *   logger.setOutput(&logCapture); // optional
+ * }
+ * @endverbatim
+ *
+ * While a test runs, the Printer of AUnit is replaced by the LogCapture, so
+ * the assertion messages are captured along with anything else which is
+ * printed through Printer::getPrinter(). Library code which logs to its own
+ * Print can be given the LogCapture as well. Outside of a test, the bytes
+ * written to the LogCapture are forwarded to the Printer.
+ *
+ * When the buffer is full, the oldest bytes are dropped, so the output
+ * closest to the failure is kept. The number of dropped bytes is printed
+ * before the replayed output.
+ *
+ * The output of testing() tests which are interleaved with each other is
+ * captured into the same buffer, and is printed when any of them fails.
+ */
+class LogCapture: public Print, public TestListener {
+  public:
+    /** Constructor. The 'buffer' of 'size' bytes holds the captured output. */
+    LogCapture(char* buffer, uint16_t size):
+        mBuffer(buffer),
+        mSize(size) {}
+
+    size_t write(uint8_t c) override;
+
+    size_t write(const uint8_t* buffer, size_t size) override;
+
+    /** Return true while a test is running and its output is captured. */
+    bool isCapturing() const { return mNumRunning > 0; }
+
+    /** Return the number of bytes currently in the buffer. */
+    uint16_t getLength() const { return mLength; }
+
+    /** Return the number of bytes dropped since the buffer was cleared. */
+    uint32_t getDropped() const { return mDropped; }
+
+    /** Print the captured output, then clear the buffer. */
+    void replay(Print* printer);
+
+    /** Discard the captured output. */
+    void clear() {
+      mHead = 0;
+      mLength = 0;
+      mDropped = 0;
+    }
+
+    void testStarting(Test& test) override;
+    void testFinished(Test& test) override;
+
+  private:
+    // Disable copy-constructor and assignment operator
+    LogCapture(const LogCapture&) = delete;
+    LogCapture& operator=(const LogCapture&) = delete;
+
+    char* const mBuffer;
+    uint16_t const mSize;
+    uint16_t mHead = 0;
+    uint16_t mLength = 0;
+    uint32_t mDropped = 0;
+    Print* mPrinter = nullptr;
+    uint8_t mNumRunning = 0;
+};
+
+}
+
+#endif
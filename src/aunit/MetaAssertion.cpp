@@ -99,10 +99,21 @@ void printStatusNowMessage(const char* file, uint16_t line,
 }
 
 bool MetaAssertion::isOutputEnabledForStatus(uint8_t status) const {
-  return (status == kStatusFailed && isVerbosity(Verbosity::kTestFailed))
-      || (status == kStatusPassed && isVerbosity(Verbosity::kTestPassed))
-      || (status == kStatusSkipped && isVerbosity(Verbosity::kTestSkipped))
-      || (status == kStatusExpired && isVerbosity(Verbosity::kTestExpired));
+  uint8_t verbosity;
+  if (status == kStatusFailed) {
+    verbosity = Verbosity::kTestFailed;
+  } else if (status == kStatusPassed) {
+    verbosity = Verbosity::kTestPassed;
+  } else if (status == kStatusSkipped) {
+    verbosity = Verbosity::kTestSkipped;
+  } else if (status == kStatusExpired) {
+    verbosity = Verbosity::kTestExpired;
+  } else {
+    return false;
+  }
+  if (!isVerbosity(verbosity)) return false;
+  Printer::setMessageVerbosity(verbosity);
+  return true;
 }
 
 void MetaAssertion::setStatusNow(const char* file, uint16_t line,
@@ -66,7 +66,10 @@ class MetaAssertion: public Assertion {
         const char* testName, const __FlashStringHelper* statusMessage,
         bool ok);
 
-    /** Return true if setting of status should print a message. */
+    /**
+     * Return true if setting of status should print a message, and tag the
+     * message using Printer::setMessageVerbosity().
+     */
     bool isOutputEnabledForStatus(uint8_t status) const;
 
     /** Set the status of the current test to 'status' and print a message. */
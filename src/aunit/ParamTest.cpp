@@ -0,0 +1,265 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <string.h>
+#include <Arduino.h>  // Print
+#include "Flash.h"
+#include "FCString.h"
+#include "Verbosity.h"
+#include "Printer.h"
+#include "Test.h"
+#include "TestRunner.h"
+#include "ParamTest.h"
+
+namespace aunit {
+
+using internal::FCString;
+
+namespace {
+
+// Copy the name of the test into a normal c-string.
+void copyName(const FCString& name, char* dst, size_t size) {
+  if (name.getType() == FCString::kCStringType) {
+    strncpy(dst, name.getCString(), size);
+  } else {
+    strncpy_P(dst, (const char*) name.getFString(), size);
+  }
+  dst[size - 1] = '\0';
+}
+
+// Write "/i" into 'dst', which must have room for 7 characters, including the
+// NUL terminator.
+void formatRowSuffix(char* dst, uint16_t i) {
+  char digits[5];
+  uint8_t n = 0;
+  do {
+    digits[n++] = '0' + (i % 10);
+    i /= 10;
+  } while (i > 0);
+
+  *dst++ = '/';
+  while (n > 0) *dst++ = digits[--n];
+  *dst = '\0';
+}
+
+// Rank the status of the rows, so that the status of the test is the
+// "worst" status of its rows.
+uint8_t rankStatus(uint8_t status) {
+  switch (status) {
+    case Test::kStatusFailed: return 4;
+    case Test::kStatusExpired: return 3;
+    case Test::kStatusPassed: return 2;
+    case Test::kStatusSkipped: return 1;
+    default: return 0;
+  }
+}
+
+}
+
+ParamTest::ParamTest(const __FlashStringHelper* name, const void* rows,
+    uint16_t numRows, uint8_t* excludedRows, Invoker invoker):
+  mRows(rows),
+  mExcludedRows(excludedRows),
+  mInvoker(invoker),
+  mNumRows(numRows) {
+  init(name);
+
+  ParamTest** root = getParamRoot();
+  mNextParam = *root;
+  *root = this;
+
+  TestRunner::sFilterRowsHook = &ParamTest::filterRows;
+  TestRunner::sCountRowsHook = &ParamTest::countRows;
+  TestRunner::sCountTestHook = &ParamTest::countTest;
+}
+
+ParamTest** ParamTest::getParamRoot() {
+  static ParamTest* root;
+  return &root;
+}
+
+void ParamTest::setup() {
+  mRow = 0;
+  mAggregateStatus = kStatusUnknown;
+}
+
+// Run a single row per call, so that the rows of a long table are
+// interleaved with the testing() tests, and the timeout of the TestRunner is
+// checked between the rows.
+void ParamTest::loop() {
+  skipExcludedRows();
+  if (mRow < mNumRows) {
+    (this->*mInvoker)(mRows, mRow);
+    resolveRow(mRow, isDone() ? getStatus() : kStatusPassed);
+    mRow++;
+
+    // Clear the status of the row, so that the assertions of the next row
+    // are not short-circuited.
+    setStatus(kStatusUnknown);
+    setLifeCycle(kLifeCycleSetup);
+    skipExcludedRows();
+  }
+
+  if (mRow >= mNumRows) {
+    setStatus(mAggregateStatus);
+  }
+}
+
+void ParamTest::teardown() {
+  if (isExpired()) {
+    while (mRow < mNumRows) {
+      resolveRow(mRow, isRowExcluded(mRow) ? kStatusSkipped : kStatusExpired);
+      mRow++;
+    }
+  }
+
+  // Every row has been counted and printed, so the status of the test is
+  // the worst status of its rows, and the TestRunner does not print it.
+  setStatus(mAggregateStatus);
+  disableVerbosity(Verbosity::kTestAll);
+}
+
+void ParamTest::skipExcludedRows() {
+  while (mRow < mNumRows && isRowExcluded(mRow)) {
+    resolveRow(mRow, kStatusSkipped);
+    mRow++;
+  }
+}
+
+void ParamTest::setRowExcluded(uint16_t i, bool excluded) {
+  uint8_t mask = 1 << (i % 8);
+  if (excluded) {
+    mExcludedRows[i / 8] |= mask;
+  } else {
+    mExcludedRows[i / 8] &= ~mask;
+  }
+}
+
+void ParamTest::resolveRow(uint16_t i, uint8_t status) {
+  TestRunner::getRunner()->countStatus(status, 1);
+  if (rankStatus(status) > rankStatus(mAggregateStatus)) {
+    mAggregateStatus = status;
+  }
+
+  if (!isVerbosity(Verbosity::kTestAll)) return;
+
+  const __FlashStringHelper* statusString;
+  uint8_t verbosity;
+  if (status == kStatusPassed) {
+    statusString = F(" passed.");
+    verbosity = Verbosity::kTestPassed;
+  } else if (status == kStatusFailed) {
+    statusString = F(" failed.");
+    verbosity = Verbosity::kTestFailed;
+  } else if (status == kStatusSkipped) {
+    statusString = F(" skipped.");
+    verbosity = Verbosity::kTestSkipped;
+  } else if (status == kStatusExpired) {
+    statusString = F(" timed out.");
+    verbosity = Verbosity::kTestExpired;
+  } else {
+    return;
+  }
+  if (!isVerbosity(verbosity)) return;
+
+  Printer::setMessageVerbosity(verbosity);
+  Print* printer = Printer::getPrinter();
+  printer->print(F("Test "));
+  printRowName(printer, i);
+  printer->println(statusString);
+}
+
+void ParamTest::printRowName(Print* printer, uint16_t i) const {
+  getName().print(printer);
+  printer->print('/');
+  printer->print(i);
+}
+
+// A row matches if the test itself matches, or if the name of the row
+// matches. The name of the row is built in a buffer of the same size as the
+// patterns of the TestRunner, and a row whose name does not fit can be
+// selected only through the name of its test.
+void ParamTest::filterRows(const char* pattern, size_t length,
+    bool isSubstring, uint8_t lifeCycle) {
+  const size_t kSuffixSize = 7; // "/65535" and NUL
+  char name[TestRunner::kMaxPatternLength];
+
+  for (ParamTest* p = *getParamRoot(); p != nullptr; p = p->mNextParam) {
+    copyName(p->getName(), name, sizeof(name));
+    size_t nameLength = strlen(name);
+    bool hasRoom = nameLength + kSuffixSize <= sizeof(name);
+    bool testMatches = isSubstring
+        ? strstr(name, pattern) != nullptr
+        : strncmp(name, pattern, length) == 0;
+
+    bool isIncluded = false;
+    for (uint16_t i = 0; i < p->mNumRows; i++) {
+      bool matches = testMatches;
+      if (!matches && hasRoom) {
+        formatRowSuffix(name + nameLength, i);
+        matches = isSubstring
+            ? strstr(name, pattern) != nullptr
+            : strncmp(name, pattern, length) == 0;
+      }
+      if (matches) {
+        p->setRowExcluded(i, lifeCycle == kLifeCycleExcluded);
+      }
+      if (!p->isRowExcluded(i)) isIncluded = true;
+    }
+
+    // The test runs if any of its rows are selected, regardless of whether
+    // the pattern matched the name of the test itself.
+    p->setLifeCycle(isIncluded ? kLifeCycleNew : kLifeCycleExcluded);
+  }
+}
+
+// The rows were counted by resolveRow(), so the test itself is not counted.
+// If a TestListener changed the status of the test after its rows were
+// counted (e.g. a HeapMonitor found a leak), the count of one row is moved to
+// the new status.
+bool ParamTest::countTest(TestRunner& runner, Test& test) {
+  for (ParamTest* p = *getParamRoot(); p != nullptr; p = p->mNextParam) {
+    if (p != &test) continue;
+    if (p->getStatus() != p->mAggregateStatus) {
+      runner.countStatus(p->mAggregateStatus, -1);
+      runner.countStatus(p->getStatus(), 1);
+    }
+    return true;
+  }
+  return false;
+}
+
+// The TestRunner counts each test once, so add the other rows. The excluded
+// tests are counted as skipped without running, so their other rows are
+// counted as skipped here.
+void ParamTest::countRows(TestRunner& runner) {
+  for (ParamTest* p = *getParamRoot(); p != nullptr; p = p->mNextParam) {
+    runner.mCount += p->mNumRows - 1;
+    if (p->getLifeCycle() == kLifeCycleExcluded) {
+      runner.mSkippedCount += p->mNumRows - 1;
+    }
+  }
+}
+
+}
@@ -0,0 +1,164 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_PARAM_TEST_H
+#define AUNIT_PARAM_TEST_H
+
+#include <stddef.h> // size_t
+#include <stdint.h>
+#include <Arduino.h> // memcpy_P()
+#include "MetaAssertion.h"
+
+class __FlashStringHelper;
+
+namespace aunit {
+
+class TestRunner;
+
+/**
+ * A test whose body is executed once for each row of a table of parameters
+ * stored in PROGMEM. Created by the testP() macro. Each row is reported as its
+ * own test case, named after the test with the index of the row appended (e.g.
+ * "Suite_name/17"), and is counted separately in the summary of the
+ * TestRunner. The rows can be selected individually using the include() and
+ * exclude() filters of the TestRunner, for example, include("Suite_name/1*").
+ *
+ * Only a single instance of this class is created for the entire table,
+ * instead of a Test for each row. The rows are copied from flash into a local
+ * variable on the stack one at a time, one row per iteration of the global
+ * loop(), so that the rows of the table consume neither static memory nor heap.
+ * The only static memory consumed per row is 1 bit which records whether the
+ * row was excluded by a filter.
+ *
+ * The body is an explicit specialization of the body() member function
+ * template, like the simpleTest() macro, so that it has access to the
+ * assertXxx() methods.
+ */
+class ParamTest: public MetaAssertion {
+  public:
+    /** Pointer to the function which copies row 'i' and calls the body. */
+    typedef void (ParamTest::*Invoker)(const void* rows, uint16_t i);
+
+    /**
+     * Constructor. The 'name' and the 'rows' are expected to be in PROGMEM.
+     * The 'excludedRows' is a bit array of at least (numRows + 7) / 8 bytes,
+     * initialized to zero, which records the rows excluded by the filters.
+     */
+    ParamTest(const __FlashStringHelper* name, const void* rows,
+        uint16_t numRows, uint8_t* excludedRows, Invoker invoker);
+
+    /** Start at the first row. */
+    void setup() override;
+
+    /** Run the next row which is not excluded. */
+    void loop() override;
+
+    /**
+     * Count the rows which were not run if the test timed out, and set the
+     * status of the test to the worst status of its rows.
+     */
+    void teardown() override;
+
+    /** Return the number of rows in the table. */
+    uint16_t getNumRows() const { return mNumRows; }
+
+    /** Return the index of the row being run. */
+    uint16_t getRow() const { return mRow; }
+
+    /** Return true if the given row was excluded by a filter. */
+    bool isRowExcluded(uint16_t i) const {
+      return mExcludedRows[i / 8] & (1 << (i % 8));
+    }
+
+    /**
+     * The body of the test identified by the Tag type, called with a copy of
+     * each row. Specialized by the testP() macro. Never defined for the
+     * generic case.
+     */
+    template <typename Tag, typename P>
+    void body(const P& param);
+
+    /** Copy row 'i' of the table from flash and pass it to the body. */
+    template <typename Tag, typename P>
+    void invoke(const void* rows, uint16_t i) {
+      P param;
+      memcpy_P(&param, static_cast<const P*>(rows) + i, sizeof(P));
+      body<Tag, P>(param);
+    }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    ParamTest(const ParamTest&) = delete;
+    ParamTest& operator=(const ParamTest&) = delete;
+
+    /** Return the root of the list of ParamTest instances. */
+    static ParamTest** getParamRoot();
+
+    /**
+     * Apply a filter of the TestRunner to the rows of every ParamTest. If
+     * 'isSubstring' is true, the rows whose names contain 'pattern' are
+     * matched. Otherwise, the first 'length' characters of the names are
+     * compared with 'pattern', in the same way as the names of the tests.
+     * Installed as a hook of the TestRunner by the constructor.
+     */
+    static void filterRows(const char* pattern, size_t length,
+        bool isSubstring, uint8_t lifeCycle);
+
+    /**
+     * Add the rows of every ParamTest to the test counts of the TestRunner.
+     * Installed as a hook of the TestRunner by the constructor.
+     */
+    static void countRows(TestRunner& runner);
+
+    /**
+     * Count the status of the given test if it is a ParamTest, whose rows
+     * have already been counted, and return true. Return false for the other
+     * tests. Installed as a hook of the TestRunner by the constructor.
+     */
+    static bool countTest(TestRunner& runner, Test& test);
+
+    /** Set or clear the excluded bit of the given row. */
+    void setRowExcluded(uint16_t i, bool excluded);
+
+    /** Skip over the excluded rows, counting them as skipped. */
+    void skipExcludedRows();
+
+    /** Count and print the result of the given row. */
+    void resolveRow(uint16_t i, uint8_t status);
+
+    /** Print the name of the given row, e.g. "Suite_name/17". */
+    void printRowName(Print* printer, uint16_t i) const;
+
+    const void* const mRows;
+    uint8_t* const mExcludedRows;
+    Invoker const mInvoker;
+    ParamTest* mNextParam;
+    uint16_t const mNumRows;
+    uint16_t mRow = 0;
+    uint8_t mAggregateStatus = kStatusUnknown;
+};
+
+}
+
+#endif
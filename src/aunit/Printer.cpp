@@ -22,12 +22,36 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#if EPOXY_DUINO
+#include <thread>
+#endif
 #include <Arduino.h> // Serial
 #include "Flash.h"
 #include "Printer.h"
+#include "LinePrint.h"
 
 namespace aunit {
 
 Print* Printer::sPrinter = nullptr;
+AUNIT_THREAD_LOCAL uint8_t Printer::sMessageVerbosity = 0;
+#if EPOXY_DUINO
+thread_local Print* Printer::sThreadPrinter = nullptr;
+
+namespace {
+
+// Static initializers run on the main thread.
+const std::thread::id sMainThreadId = std::this_thread::get_id();
+
+}
+
+bool Printer::isMainThread() {
+  return std::this_thread::get_id() == sMainThreadId;
+}
+
+Print* Printer::getLinePrinter() {
+  static thread_local internal::LinePrint linePrint(nullptr);
+  return &linePrint;
+}
+#endif
 
 }
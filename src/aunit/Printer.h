@@ -25,10 +25,17 @@ SOFTWARE.
 #ifndef AUNIT_PRINTER_H
 #define AUNIT_PRINTER_H
 
+#include <stdint.h>
+#include "ThreadLocal.h"
+
 class Print;
 
 namespace aunit {
 
+namespace internal {
+class LinePrint;
+}
+
 /**
  * Utility class that provides a level of indirection to the Print class where
  * test results can be sent. By default, the Print object will be the Serial
@@ -44,18 +51,66 @@ class Printer {
      * Get the output printer used by the various assertion() methods and the
      * TestRunner. The default is the predefined Serial object. Can be changed
      * using the setPrinter() method.
+     *
+     * On EpoxyDuino, a thread created by a test, other than the main thread,
+     * gets a printer which writes each of its lines in one piece, so that the
+     * assertion messages of several threads are not mixed together.
      */
-    static Print* getPrinter() { return sPrinter; }
+    static Print* getPrinter() {
+    #if EPOXY_DUINO
+      if (sThreadPrinter) return sThreadPrinter;
+      if (! isMainThread()) return getLinePrinter();
+    #endif
+      return sPrinter;
+    }
 
     /** Set the printer. */
     static void setPrinter(Print* printer) { sPrinter = printer; }
 
+  #if EPOXY_DUINO
+    /**
+     * Set the printer of the current thread, which takes precedence over
+     * setPrinter(). Used by the worker threads of TestRunner::setJobs() to
+     * buffer the output of each test. Set to nullptr to restore the printer.
+     */
+    static void setThreadPrinter(Print* printer) { sThreadPrinter = printer; }
+  #endif
+
+    /**
+     * Return the Verbosity flag of the message being printed, or
+     * Verbosity::kNone for other output. Used by TeePrint to send each line
+     * to the sinks which want it.
+     */
+    static uint8_t getMessageVerbosity() { return sMessageVerbosity; }
+
+    /**
+     * Set the Verbosity flag of the message which is about to be printed. It
+     * applies until the end of the line, if the printer is a TeePrint.
+     */
+    static void setMessageVerbosity(uint8_t verbosity) {
+      sMessageVerbosity = verbosity;
+    }
+
   private:
+    friend class internal::LinePrint;
+
+  #if EPOXY_DUINO
+    /** Return true if called from the thread which started the program. */
+    static bool isMainThread();
+
+    /** Return the LinePrint of the current thread. */
+    static Print* getLinePrinter();
+  #endif
+
     // Disable copy-constructor and assignment operator
     Printer(const Printer&) = delete;
     Printer& operator=(const Printer&) = delete;
 
     static Print* sPrinter;
+    static AUNIT_THREAD_LOCAL uint8_t sMessageVerbosity;
+  #if EPOXY_DUINO
+    static thread_local Print* sThreadPrinter;
+  #endif
 };
 
 }
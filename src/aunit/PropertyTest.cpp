@@ -0,0 +1,409 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <string.h>
+#if EPOXY_DUINO
+  #include <time.h> // time()
+#endif
+#include <Arduino.h>  // micros(), analogRead(), Print
+#include "Flash.h"
+#include "Verbosity.h"
+#include "Printer.h"
+#include "Random.h"
+#include "ThreadLocal.h"
+#include "PropertyTest.h"
+
+namespace aunit {
+
+namespace {
+
+// Bit flags of the mode of a case. Without kModeGenerate, the recorded
+// choices are replayed.
+const uint8_t kModeReplay = 0x00;
+const uint8_t kModeGenerate = 0x01;
+const uint8_t kModeReport = 0x02;
+
+const uint8_t kMaxChoices = AUNIT_PROPERTY_MAX_CHOICES;
+
+uint32_t sSeed = 0;
+uint16_t sIterations = PropertyTest::kDefaultIterations;
+
+// Only one property runs at a time on each thread, so the state of the current
+// case is shared by all of them.
+AUNIT_THREAD_LOCAL Random sRandom;
+AUNIT_THREAD_LOCAL uint32_t sChoices[kMaxChoices];
+AUNIT_THREAD_LOCAL uint8_t sNumChoices;
+AUNIT_THREAD_LOCAL uint16_t sNumDrawn;
+AUNIT_THREAD_LOCAL uint8_t sMode;
+AUNIT_THREAD_LOCAL uint8_t sArgIndex;
+
+// The characters generated by genString(), starting from the simplest.
+const char kFirstChar = 'a';
+const uint8_t kNumChars = '~' - ' ' + 1;
+
+char toPrintable(uint32_t choice) {
+  return ' ' + (choice + (kFirstChar - ' ')) % kNumChars;
+}
+
+void printHexByte(Print* printer, uint8_t b) {
+  printer->print(F("0x"));
+  if (b < 0x10) printer->print('0');
+  printer->print(b, HEX);
+}
+
+}
+
+void PropertyTest::setSeed(uint32_t seed) {
+  sSeed = seed;
+}
+
+uint32_t PropertyTest::getSeed() {
+  if (sSeed == 0) {
+  #if EPOXY_DUINO
+    // The micros() of a host process may start near 0, so mix in the wall
+    // clock, which differs between runs.
+    sSeed = micros() ^ (uint32_t) time(nullptr);
+  #else
+    // A microcontroller reaches the first property at nearly the same micros()
+    // after every reset, so mix in the noise of a floating analog pin.
+    uint32_t noise = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+      noise = (noise << 4) ^ analogRead(A0);
+    }
+    sSeed = micros() ^ noise;
+  #endif
+    if (sSeed == 0) sSeed = 1;
+  }
+  return sSeed;
+}
+
+void PropertyTest::setIterations(uint16_t iterations) {
+  sIterations = iterations;
+}
+
+uint16_t PropertyTest::getIterations() {
+  return sIterations;
+}
+
+void PropertyTest::once() {
+  // The assertion messages of the thousands of cases and of the shrinking
+  // would drown the output, so they are printed only for the final replay.
+  uint8_t assertionVerbosity = getVerbosity() & Verbosity::kAssertionAll;
+  disableVerbosity(Verbosity::kAssertionAll);
+
+  // Hash the name, so that the sequence of each property is independent of
+  // the other properties selected by the filters.
+  sRandom.setSeed(getSeed() ^ getName().hash());
+  mNumShrinks = 0;
+  uint32_t caseState = 0;
+  bool hasFailed = false;
+  unsigned long startMicros = micros();
+  for (mNumCases = 0; mNumCases < sIterations; ) {
+    caseState = sRandom.getState();
+    hasFailed = runCase(kModeGenerate);
+    mNumCases++;
+    if (hasFailed || isSkipped()) break;
+  }
+  unsigned long elapsedMicros = micros() - startMicros;
+
+  if (!hasFailed) {
+    enableVerbosity(assertionVerbosity);
+    if (isNotDone()) printPassed(elapsedMicros);
+    return;
+  }
+
+  // A case which made too many choices cannot be replayed from the recorded
+  // choices, so regenerate it from the state of the Random instead.
+  bool isShrinkable = sNumDrawn <= kMaxChoices;
+  if (isShrinkable) {
+    sNumChoices = sNumDrawn;
+    shrink();
+  }
+
+  enableVerbosity(assertionVerbosity);
+  printFalsified(isShrinkable);
+  if (isShrinkable) {
+    runCase(kModeReplay | kModeReport);
+  } else {
+    sRandom.setSeed(caseState);
+    runCase(kModeGenerate | kModeReport);
+  }
+
+  // A property which depends on something other than its generated inputs
+  // may pass when it is replayed, but it did fail.
+  if (isNotFailed()) fail();
+}
+
+bool PropertyTest::runCase(uint8_t mode) {
+  sMode = mode;
+  sNumDrawn = 0;
+  sArgIndex = 0;
+  setStatus(kStatusUnknown);
+  setLifeCycle(kLifeCycleSetup);
+  check();
+  return isFailed();
+}
+
+bool PropertyTest::replay() {
+  if (!runCase(kModeReplay)) return false;
+
+  // Drop the trailing choices which were not used by the shrunk case.
+  if (sNumDrawn < sNumChoices) sNumChoices = sNumDrawn;
+  mNumShrinks++;
+  return true;
+}
+
+bool PropertyTest::tryChoice(uint8_t i, uint32_t value) {
+  uint32_t original = sChoices[i];
+  sChoices[i] = value;
+  if (replay()) return true;
+
+  sChoices[i] = original;
+  return false;
+}
+
+bool PropertyTest::tryDeleteChoice(uint8_t i) {
+  uint8_t numChoices = sNumChoices;
+  uint32_t deleted = sChoices[i];
+  size_t numMoved = (numChoices - i - 1) * sizeof(uint32_t);
+  memmove(&sChoices[i], &sChoices[i + 1], numMoved);
+  sNumChoices--;
+  if (replay()) return true;
+
+  memmove(&sChoices[i + 1], &sChoices[i], numMoved);
+  sChoices[i] = deleted;
+  sNumChoices = numChoices;
+  return false;
+}
+
+// Each pass deletes the choices which are not needed for the case to fail,
+// then minimizes each remaining choice using a binary search. This assumes
+// that a case which fails for a choice also fails for most larger ones, which
+// is not always true, so the counterexample is small but not always minimal.
+void PropertyTest::shrink() {
+  uint16_t attempts = 0;
+  bool isImproved = true;
+  while (isImproved && attempts < kMaxShrinkAttempts) {
+    isImproved = false;
+
+    for (uint8_t i = sNumChoices; i > 0 && attempts < kMaxShrinkAttempts; ) {
+      i--;
+      if (i >= sNumChoices) continue;
+      attempts++;
+      if (tryDeleteChoice(i)) isImproved = true;
+    }
+
+    for (uint8_t i = 0; i < sNumChoices; i++) {
+      uint32_t lo = 0;
+      uint32_t hi = sChoices[i];
+      while (lo < hi && i < sNumChoices && attempts < kMaxShrinkAttempts) {
+        // The sign of genInt() and genFloat() comes from the parity of the
+        // choice, so 'mid' and 'mid + 1' are tried together, in case only
+        // one of the two signs still fails.
+        uint32_t mid = lo + (hi - lo) / 2;
+        attempts++;
+        if (tryChoice(i, mid)) {
+          hi = mid;
+          isImproved = true;
+        } else if (mid + 1 >= hi) {
+          lo = mid + 1;
+        } else if (attempts++, tryChoice(i, mid + 1)) {
+          hi = mid + 1;
+          isImproved = true;
+        } else {
+          lo = mid + 2;
+        }
+      }
+    }
+  }
+}
+
+uint32_t PropertyTest::drawChoice(uint32_t bound) {
+  uint32_t choice;
+  if (sMode & kModeGenerate) {
+    choice = sRandom.next();
+    if (bound) choice %= bound;
+    if (sNumDrawn < kMaxChoices) sChoices[sNumDrawn] = choice;
+  } else {
+    choice = (sNumDrawn < sNumChoices) ? sChoices[sNumDrawn] : 0;
+    if (bound) choice %= bound;
+  }
+  if (sNumDrawn < UINT16_MAX) sNumDrawn++;
+  return choice;
+}
+
+// The choices are mapped so that the choice 0 is the value closest to 0, and
+// larger choices alternate above and below it: 0, 1, -1, 2, -2, ... The
+// arithmetic is done on unsigned integers to avoid signed overflow.
+int32_t PropertyTest::genInt(int32_t lo, int32_t hi) {
+  uint32_t range = (uint32_t) hi - (uint32_t) lo + 1;
+  int32_t origin = (lo > 0) ? lo : (hi < 0) ? hi : 0;
+  uint32_t up = (uint32_t) hi - (uint32_t) origin;
+  uint32_t down = (uint32_t) origin - (uint32_t) lo;
+  uint32_t both = (up < down) ? up : down;
+
+  uint32_t k = drawChoice(range);
+  uint32_t offset;
+  bool isUp;
+  if (k <= 2 * both) {
+    isUp = k & 1;
+    offset = isUp ? (k + 1) / 2 : k / 2;
+  } else {
+    isUp = up > down;
+    offset = k - both;
+  }
+  int32_t value = (int32_t) (isUp
+      ? (uint32_t) origin + offset
+      : (uint32_t) origin - offset);
+
+  if (printArgLabel()) Printer::getPrinter()->println(value);
+  return value;
+}
+
+bool PropertyTest::genBool() {
+  bool value = drawChoice(2) != 0;
+
+  if (printArgLabel()) {
+    Printer::getPrinter()->println(value ? F("true") : F("false"));
+  }
+  return value;
+}
+
+// The magnitude is taken from the upper 24 bits of the choice, which is the
+// precision of a float, and the sign from the lowest bit.
+float PropertyTest::genFloat(float lo, float hi) {
+  uint32_t k = drawChoice(0);
+  float fraction = (k >> 8) * (1.0f / 16777216.0f);
+  float value;
+  if (lo <= 0 && hi >= 0) {
+    value = (fraction == 0) ? 0 : (k & 1) ? fraction * lo : fraction * hi;
+  } else {
+    float origin = (lo > 0) ? lo : hi;
+    float other = (lo > 0) ? hi : lo;
+    value = origin + fraction * (other - origin);
+  }
+
+  if (printArgLabel()) Printer::getPrinter()->println(value, 6);
+  return value;
+}
+
+size_t PropertyTest::genBytes(uint8_t* buf, size_t maxLength) {
+  size_t length = drawChoice(maxLength + 1);
+  for (size_t i = 0; i < length; i++) {
+    buf[i] = drawChoice(256);
+  }
+
+  if (printArgLabel()) {
+    Print* printer = Printer::getPrinter();
+    printer->print('{');
+    for (size_t i = 0; i < length; i++) {
+      if (i > 0) printer->print(F(", "));
+      printHexByte(printer, buf[i]);
+    }
+    printer->println('}');
+  }
+  return length;
+}
+
+size_t PropertyTest::genString(char* buf, size_t size) {
+  if (size == 0) return 0;
+  size_t length = drawChoice(size);
+  for (size_t i = 0; i < length; i++) {
+    buf[i] = toPrintable(drawChoice(kNumChars));
+  }
+  buf[length] = '\0';
+
+  if (printArgLabel()) {
+    Print* printer = Printer::getPrinter();
+    printer->print('"');
+    printer->print(buf);
+    printer->println('"');
+  }
+  return length;
+}
+
+bool PropertyTest::printArgLabel() {
+  if (!(sMode & kModeReport)) return false;
+  if (!isVerbosity(Verbosity::kAssertionFailed)) return false;
+
+  Printer::setMessageVerbosity(Verbosity::kAssertionFailed);
+  Print* printer = Printer::getPrinter();
+  printer->print(F("  arg "));
+  printer->print(sArgIndex++);
+  printer->print(F(": "));
+  return true;
+}
+
+void PropertyTest::printPassed(unsigned long elapsedMicros) const {
+  if (!isVerbosity(Verbosity::kTestPassed)) return;
+
+  Printer::setMessageVerbosity(Verbosity::kTestPassed);
+  Print* printer = Printer::getPrinter();
+  printer->print(F("Property "));
+  getName().print(printer);
+  printer->print(F(" held for "));
+  printer->print(mNumCases);
+  printer->print(F(" case(s) in "));
+  unsigned long us = elapsedMicros % 1000;
+  printer->print(elapsedMicros / 1000);
+  printer->print('.');
+  if (us < 100) printer->print('0');
+  if (us < 10) printer->print('0');
+  printer->print(us);
+  printer->print(F(" ms, "));
+  if (elapsedMicros > 0) {
+    // The number of cases times 10^6 overflows 32 bits.
+    printer->print((unsigned long)
+        ((uint64_t) mNumCases * 1000000UL / elapsedMicros));
+  } else {
+    printer->print('>');
+    printer->print(mNumCases);
+    printer->print(F("000000"));
+  }
+  printer->print(F(" cases/sec, seed "));
+  printer->print(getSeed());
+  printer->println('.');
+}
+
+void PropertyTest::printFalsified(bool isShrunk) const {
+  if (!isVerbosity(Verbosity::kAssertionFailed)) return;
+
+  Printer::setMessageVerbosity(Verbosity::kAssertionFailed);
+  Print* printer = Printer::getPrinter();
+  printer->print(F("Property "));
+  getName().print(printer);
+  printer->print(F(" falsified after "));
+  printer->print(mNumCases);
+  if (isShrunk) {
+    printer->print(F(" case(s), shrunk in "));
+    printer->print(mNumShrinks);
+    printer->print(F(" step(s), seed "));
+  } else {
+    printer->print(F(" case(s), too many choices to shrink, seed "));
+  }
+  printer->print(getSeed());
+  printer->println(':');
+}
+
+}
@@ -0,0 +1,179 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_PROPERTY_TEST_H
+#define AUNIT_PROPERTY_TEST_H
+
+#include <stddef.h> // size_t
+#include <stdint.h>
+#include "TestOnce.h"
+
+/**
+ * Maximum number of random choices recorded for a single case of a property.
+ * Each generator consumes 1 choice, except genBytes() and genString(), which
+ * consume 1 choice for the length and 1 choice for each byte, so that the
+ * shrinking can delete individual bytes. A case which makes more choices
+ * still runs, but cannot be shrunk if it fails. Each choice
+ * consumes 4 bytes of static memory. It can be overridden by defining it
+ * before including AUnit.h.
+ */
+#ifndef AUNIT_PROPERTY_MAX_CHOICES
+  #define AUNIT_PROPERTY_MAX_CHOICES 32
+#endif
+
+namespace aunit {
+
+/**
+ * A test which checks that a property holds for many randomly generated
+ * inputs. Created by the testProperty() macro. The body is called once per
+ * case, up to getIterations() times, and obtains its inputs from the genXxx()
+ * methods. For example:
+ *
+ * @verbatim
+ * testProperty(reverseTwice) {
+ *   char s[8];
+ *   size_t n = genString(s, sizeof(s));
+ *   reverse(s, n);
+ *   reverse(s, n);
+ *   ...
+ * }
+ * @endverbatim
+ *
+ * The generators are driven by the Random generator, which is seeded from the
+ * seed of the run (see setSeed()) and the name of the property, so that a run
+ * can be replayed with the same seed.
+ *
+ * When a case fails, the random choices which produced its inputs are
+ * replayed with smaller values and fewer choices, as long as the case still
+ * fails, which shrinks the inputs towards a minimal counterexample (the
+ * integers towards 0, the buffers and strings towards short ones). The
+ * counterexample is printed, then replayed once more with the assertion
+ * messages enabled. The choices are recorded in a single static buffer, so no
+ * heap is used.
+ */
+class PropertyTest: public TestOnce {
+  public:
+    /** Default number of cases per property. */
+    static const uint16_t kDefaultIterations = 1000;
+
+    /** Maximum number of replays while shrinking a counterexample. */
+    static const uint16_t kMaxShrinkAttempts = 2000;
+
+    /**
+     * Set the seed of the run. A seed of 0 (the default) picks a seed from
+     * micros() when the first property runs, mixed with the wall clock on
+     * EpoxyDuino, or with the noise of the analog pin A0 on a
+     * microcontroller. Set by the `--seed` flag on
+     * EpoxyDuino.
+     */
+    static void setSeed(uint32_t seed);
+
+    /** Return the seed of the run, picking one if none was set. */
+    static uint32_t getSeed();
+
+    /** Set the number of cases of each property. */
+    static void setIterations(uint16_t iterations);
+
+    /** Return the number of cases of each property. */
+    static uint16_t getIterations();
+
+    /** Constructor. */
+    PropertyTest() {}
+
+    /** Run the cases, then shrink and print the counterexample if any. */
+    void once() override;
+
+    /** User-provided property, called once per case. */
+    virtual void check() = 0;
+
+    /** Return the number of cases which were generated. */
+    uint16_t getNumCases() const { return mNumCases; }
+
+    /** Return the number of successful shrinking steps. */
+    uint16_t getNumShrinks() const { return mNumShrinks; }
+
+  protected:
+    /** Generate an integer in the inclusive range [lo, hi]. */
+    int32_t genInt(int32_t lo, int32_t hi);
+
+    /** Generate a boolean. */
+    bool genBool();
+
+    /** Generate a float in the range [lo, hi]. */
+    float genFloat(float lo, float hi);
+
+    /**
+     * Fill 'buf' with random bytes and return the length, which is between 0
+     * and 'maxLength' inclusive.
+     */
+    size_t genBytes(uint8_t* buf, size_t maxLength);
+
+    /**
+     * Fill 'buf' with a NUL-terminated string of printable ASCII characters
+     * and return its length, which is between 0 and size - 1 inclusive.
+     */
+    size_t genString(char* buf, size_t size);
+
+  private:
+    // Disable copy-constructor and assignment operator
+    PropertyTest(const PropertyTest&) = delete;
+    PropertyTest& operator=(const PropertyTest&) = delete;
+
+    /**
+     * Return the next choice, in the range [0, bound), or the full 32 bits if
+     * 'bound' is 0.
+     */
+    uint32_t drawChoice(uint32_t bound);
+
+    /** Run a single case in the given mode. Return true if it failed. */
+    bool runCase(uint8_t mode);
+
+    /** Replay the recorded choices. Return true if the case still fails. */
+    bool replay();
+
+    /** Replace choice 'i' with 'value', keeping it if the case still fails. */
+    bool tryChoice(uint8_t i, uint32_t value);
+
+    /** Remove choice 'i', keeping the removal if the case still fails. */
+    bool tryDeleteChoice(uint8_t i);
+
+    /** Shrink the recorded choices of the failed case. */
+    void shrink();
+
+    /** Print the start of the line of a generated argument in report mode. */
+    bool printArgLabel();
+
+    /** Print the summary of a property which held for every case. */
+    void printPassed(unsigned long elapsedMicros) const;
+
+    /** Print the header of the counterexample. */
+    void printFalsified(bool isShrunk) const;
+
+    uint16_t mNumCases = 0;
+    uint16_t mNumShrinks = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_RANDOM_H
+#define AUNIT_RANDOM_H
+
+#include <stdint.h>
+
+namespace aunit {
+
+/**
+ * A small and fast pseudo random number generator, using the 32-bit xorshift
+ * algorithm of George Marsaglia. It uses only shifts and xors on 32-bit
+ * integers, which are cheap on 8-bit processors, unlike the 64-bit
+ * multiplications of PCG. It is not suitable for cryptography. The same seed
+ * always produces the same sequence on every platform.
+ */
+class Random {
+  public:
+    /** Constructor. */
+    explicit Random(uint32_t seed = 1) { setSeed(seed); }
+
+    /**
+     * Restart the sequence using the given seed. A seed of 0 is replaced with
+     * a non-zero constant, because 0 is a fixed point of xorshift.
+     */
+    void setSeed(uint32_t seed) { mState = seed ? seed : 0x9E3779B9; }
+
+    /**
+     * Return the internal state, which can be passed to setSeed() to replay
+     * the sequence from this point.
+     */
+    uint32_t getState() const { return mState; }
+
+    /** Return the next 32-bit random number. */
+    uint32_t next() {
+      uint32_t x = mState;
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      mState = x;
+      return x;
+    }
+
+  private:
+    uint32_t mState;
+};
+
+}
+
+#endif
@@ -0,0 +1,117 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <Arduino.h> // Print
+#include "Flash.h"
+#include "Printer.h"
+#include "Test.h"
+#include "StackMonitor.h"
+
+#if defined(ARDUINO_ARCH_AVR)
+// Defined by the avr-libc linker script and malloc() implementation.
+extern char __heap_start;
+extern char* __brkval;
+#endif
+
+namespace aunit {
+
+namespace {
+
+const uint8_t kSentinel = 0xA5;
+
+#if defined(ARDUINO_ARCH_AVR)
+
+// Bytes left unpainted just above the heap, so that a small malloc() inside the
+// test is not mistaken for stack usage, and just below the frame of
+// paintStack() itself.
+const uint8_t kMargin = 32;
+
+// Paint the free memory between the end of the heap and the current stack
+// pointer. Must not be inlined, so that the frame of this function is at the
+// same depth as the setup() of the test.
+__attribute__((noinline))
+void paintStack(uintptr_t& bottom, uintptr_t& top) {
+  uint8_t marker;
+  uintptr_t heapEnd = (uintptr_t) (__brkval ? __brkval : &__heap_start);
+  bottom = heapEnd + kMargin;
+  top = (uintptr_t) &marker;
+  for (uintptr_t p = bottom; p < top - kMargin; p++) {
+    *(volatile uint8_t*) p = kSentinel;
+  }
+}
+
+#else
+
+// Paint a guard region of kGuardSize bytes allocated on the stack. The memory
+// remains mapped after this function returns, and is reused by the frames of
+// the test. Must not be inlined, so that the guard region begins at the same
+// depth as the frame of the setup() of the test.
+__attribute__((noinline))
+void paintStack(uintptr_t& bottom, uintptr_t& top) {
+  volatile uint8_t guard[StackMonitor::kGuardSize];
+  for (size_t i = 0; i < StackMonitor::kGuardSize; i++) {
+    guard[i] = kSentinel;
+  }
+  bottom = (uintptr_t) guard;
+  top = bottom + StackMonitor::kGuardSize;
+}
+
+#endif
+
+// Find the lowest address which no longer contains the sentinel, and return
+// the number of bytes between it and the top of the painted region.
+size_t measureStack(uintptr_t bottom, uintptr_t top) {
+  uintptr_t p = bottom;
+  while (p < top && *(const volatile uint8_t*) p == kSentinel) {
+    p++;
+  }
+  return top - p;
+}
+
+}
+
+void StackMonitor::testStarting(Test& /*test*/) {
+  paintStack(mBottom, mTop);
+}
+
+void StackMonitor::testFinished(Test& test) {
+  mUsage = measureStack(mBottom, mTop);
+  if (mUsage > mMaxUsage) mMaxUsage = mUsage;
+
+  Print* printer = Printer::getPrinter();
+  printer->print(F("Test "));
+  test.getName().print(printer);
+  printer->print(F(" stack usage: "));
+  printer->print((unsigned long) mUsage);
+  printer->println(F(" bytes."));
+}
+
+void StackMonitor::runFinished() {
+  Print* printer = Printer::getPrinter();
+  printer->print(F("TestRunner max stack usage: "));
+  printer->print((unsigned long) mMaxUsage);
+  printer->println(F(" bytes."));
+}
+
+}
@@ -0,0 +1,91 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_STACK_MONITOR_H
+#define AUNIT_STACK_MONITOR_H
+
+#include <stddef.h> // size_t
+#include <stdint.h> // uintptr_t
+#include "TestListener.h"
+
+namespace aunit {
+
+/**
+ * A TestListener which measures the peak stack usage of each test. Before the
+ * setup() of the test, the free stack region below the TestRunner is painted
+ * with a sentinel byte. After the teardown() of the test, the region is scanned
+ * for the deepest byte which was overwritten. Usage:
+ *
+ * @verbatim
+ * aunit::StackMonitor stackMonitor;
+ *
+ * void setup() {
+ *   ...
+ *   TestRunner::addListener(&stackMonitor);
+ * }
+ * @endverbatim
+ *
+ * The stack usage of each test is printed after its teardown(), and the
+ * maximum across all tests is printed after the TestRunner summary.
+ *
+ * On AVR, the painted region extends from the end of the heap to the current
+ * stack pointer, so a test which overflows into the heap or `.bss` is
+ * reported as using the entire region. On other platforms, including
+ * EpoxyDuino, the stack size is not easily known, so a guard region of
+ * kGuardSize bytes below the TestRunner is painted instead, and the usage
+ * saturates at kGuardSize.
+ *
+ * The usage of a testing() test which is interleaved with other testing()
+ * tests includes the stack usage of those other tests.
+ */
+class StackMonitor: public TestListener {
+  public:
+  #if EPOXY_DUINO
+    /** Size of the painted region, the size of a typical thread stack. */
+    static const size_t kGuardSize = 16384;
+  #elif ! defined(ARDUINO_ARCH_AVR)
+    /** Size of the painted region. */
+    static const size_t kGuardSize = 1024;
+  #endif
+
+    /** Return the stack usage of the most recent test, in bytes. */
+    size_t getUsage() const { return mUsage; }
+
+    /** Return the maximum stack usage of all tests so far, in bytes. */
+    size_t getMaxUsage() const { return mMaxUsage; }
+
+    void testStarting(Test& test) override;
+    void testFinished(Test& test) override;
+    void runFinished() override;
+
+  private:
+    uintptr_t mBottom = 0;
+    uintptr_t mTop = 0;
+    size_t mUsage = 0;
+    size_t mMaxUsage = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <Arduino.h> // Print
+#include "Printer.h"
+#include "TeePrint.h"
+
+namespace aunit {
+
+bool TeePrint::addSink(Print* sink, uint8_t verbosity) {
+  if (sink == nullptr || mNumSinks >= kMaxSinks) return false;
+  mSinks[mNumSinks].print = sink;
+  mSinks[mNumSinks].verbosity = verbosity;
+  mNumSinks++;
+  return true;
+}
+
+uint8_t TeePrint::getVerbosity() const {
+  uint8_t verbosity = Verbosity::kNone;
+  for (uint8_t i = 0; i < mNumSinks; i++) {
+    verbosity |= mSinks[i].verbosity;
+  }
+  return verbosity;
+}
+
+size_t TeePrint::write(uint8_t c) {
+  if (mIsLineStart) {
+    mLineVerbosity = Printer::getMessageVerbosity();
+    mIsLineStart = false;
+  }
+
+  mBuf[mLength++] = c;
+  if (c == '\n') {
+    writeChunk();
+    mIsLineStart = true;
+    // The tag of a message applies only to its line.
+    Printer::setMessageVerbosity(Verbosity::kNone);
+  } else if (mLength >= kBufSize) {
+    writeChunk();
+  }
+  return 1;
+}
+
+size_t TeePrint::write(const uint8_t* buffer, size_t size) {
+  if (buffer == nullptr) return 0;
+  for (size_t i = 0; i < size; i++) {
+    write(buffer[i]);
+  }
+  return size;
+}
+
+void TeePrint::flush() {
+  writeChunk();
+  for (uint8_t i = 0; i < mNumSinks; i++) {
+    mSinks[i].print->flush();
+  }
+}
+
+void TeePrint::writeChunk() {
+  if (mLength == 0) return;
+  for (uint8_t i = 0; i < mNumSinks; i++) {
+    const Sink& sink = mSinks[i];
+    if (mLineVerbosity == Verbosity::kNone
+        || (sink.verbosity & mLineVerbosity)) {
+      sink.print->write(mBuf, mLength);
+    }
+  }
+  mLength = 0;
+}
+
+}
@@ -0,0 +1,115 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_TEE_PRINT_H
+#define AUNIT_TEE_PRINT_H
+
+#include <stddef.h> // size_t
+#include <stdint.h>
+#include <Print.h>
+#include "Verbosity.h"
+
+namespace aunit {
+
+/**
+ * An implementation of Print which sends the output of AUnit to several
+ * sinks, for example the Serial port and a log file. Each message is
+ * formatted only once into a small line buffer, which is written to each
+ * sink in a single chunk at the end of the line, or when the buffer is full.
+ * Usage:
+ *
+ * @verbatim
+ * aunit::TeePrint teePrint;
+ *
+ * void setup() {
+ *   ...
+ *   teePrint.addSink(&Serial, Verbosity::kAssertionFailed
+ *       | Verbosity::kTestFailed | Verbosity::kTestExpired
+ *       | Verbosity::kTestRunSummary);
+ *   teePrint.addSink(&logFile, Verbosity::kAll);
+ *   TestRunner::setPrinter(&teePrint);
+ *   TestRunner::setVerbosity(teePrint.getVerbosity());
+ * }
+ * @endverbatim
+ *
+ * The 'verbosity' of each sink selects the messages which it receives. Each
+ * line is tagged with the Verbosity flag given by
+ * Printer::getMessageVerbosity() when it starts, and lines which are not
+ * tagged (e.g. the output of a TestListener) are sent to every sink. The
+ * TestRunner verbosity must include the flags of all sinks, otherwise the
+ * messages are not printed at all, so it is normally set to getVerbosity().
+ * The Verbosity::kTestDuration flag is part of the test status message, so it
+ * is controlled only by the TestRunner verbosity.
+ */
+class TeePrint: public Print {
+  public:
+    /** Maximum number of sinks. */
+    static const uint8_t kMaxSinks = 4;
+
+    /** Size of the line buffer. Longer lines are written in several chunks. */
+    static const uint8_t kBufSize = 64;
+
+    /**
+     * Add a sink which receives the messages selected by 'verbosity'. Returns
+     * false if kMaxSinks have already been added.
+     */
+    bool addSink(Print* sink, uint8_t verbosity = Verbosity::kAll);
+
+    /** Return the number of sinks. */
+    uint8_t getNumSinks() const { return mNumSinks; }
+
+    /** Return the union of the verbosity of all sinks. */
+    uint8_t getVerbosity() const;
+
+    size_t write(uint8_t c) override;
+
+    size_t write(const uint8_t* buffer, size_t size) override;
+
+// ESP32 and STM32duino do not provide a virtual Print::flush() method.
+#if defined(ESP32) || defined(ARDUINO_ARCH_STM32)
+    void flush();
+#else
+    void flush() override;
+#endif
+
+  private:
+    struct Sink {
+      Print* print;
+      uint8_t verbosity;
+    };
+
+    /** Write the buffered bytes to the sinks which want the current line. */
+    void writeChunk();
+
+    Sink mSinks[kMaxSinks];
+    uint8_t mBuf[kBufSize];
+    uint8_t mNumSinks = 0;
+    uint8_t mLength = 0;
+    uint8_t mLineVerbosity = Verbosity::kNone;
+    bool mIsLineStart = true;
+};
+
+}
+
+#endif
@@ -38,6 +38,10 @@ Test** Test::getRoot() {
   return &root;
 }
 
+#if EPOXY_DUINO
+thread_local uint32_t Test::sNumThreadFailures = 0;
+#endif
+
 Test::Test():
   mLifeCycle(kLifeCycleNew),
   mStatus(kStatusUnknown),
@@ -70,32 +74,58 @@ void Test::insert() {
   *p = this;
 }
 
-void Test::resolve() {
+namespace {
+
+// Print the duration as milliseconds with 3 decimal places, followed by the
+// period which ends the sentence, e.g. " in 12.345 ms.".
+void printDuration(Print* printer, uint32_t durationMicros) {
+  uint32_t ms = durationMicros / 1000;
+  uint16_t us = durationMicros % 1000;
+  printer->print(F(" in "));
+  printer->print((unsigned long) ms);
+  printer->print('.');
+  if (us < 100) printer->print('0');
+  if (us < 10) printer->print('0');
+  printer->print(us);
+  printer->println(F(" ms."));
+}
+
+}
+
+void Test::resolve(uint32_t durationMicros) {
   const __FlashStringHelper* const TEST_STRING = F("Test ");
 
   if (!isVerbosity(Verbosity::kTestAll)) return;
 
+  const __FlashStringHelper* statusString;
+  uint8_t verbosity;
+  if (mStatus == Test::kStatusPassed) {
+    statusString = F(" passed");
+    verbosity = Verbosity::kTestPassed;
+  } else if (mStatus == Test::kStatusFailed) {
+    statusString = F(" failed");
+    verbosity = Verbosity::kTestFailed;
+  } else if (mStatus == Test::kStatusSkipped) {
+    statusString = F(" skipped");
+    verbosity = Verbosity::kTestSkipped;
+  } else if (mStatus == Test::kStatusExpired) {
+    statusString = F(" timed out");
+    verbosity = Verbosity::kTestExpired;
+  } else {
+    return;
+  }
+  if (!isVerbosity(verbosity)) return;
+
+  Printer::setMessageVerbosity(verbosity);
   Print* printer = Printer::getPrinter();
-  if (mStatus == Test::kStatusPassed
-      && isVerbosity(Verbosity::kTestPassed)) {
-    printer->print(TEST_STRING);
-    mName.print(printer);
-    printer->println(F(" passed."));
-  } else if (mStatus == Test::kStatusFailed
-      && isVerbosity(Verbosity::kTestFailed)) {
-    printer->print(TEST_STRING);
-    mName.print(printer);
-    printer->println(F(" failed."));
-  } else if (mStatus == Test::kStatusSkipped
-      && isVerbosity(Verbosity::kTestSkipped)) {
-    printer->print(TEST_STRING);
-    mName.print(printer);
-    printer->println(F(" skipped."));
-  } else if (mStatus == Test::kStatusExpired
-      && isVerbosity(Verbosity::kTestExpired)) {
-    printer->print(TEST_STRING);
-    mName.print(printer);
-    printer->println(F(" timed out."));
+  printer->print(TEST_STRING);
+  mName.print(printer);
+  printer->print(statusString);
+  if (durationMicros != kDurationUnknown
+      && isVerbosity(Verbosity::kTestDuration)) {
+    printDuration(printer, durationMicros);
+  } else {
+    printer->println('.');
   }
 }
 
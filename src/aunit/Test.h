@@ -28,12 +28,17 @@ SOFTWARE.
 #ifndef AUNIT_TEST_H
 #define AUNIT_TEST_H
 
+#if EPOXY_DUINO
+#include <atomic>
+#endif
 #include <stdint.h>
 #include "FCString.h"
 #include "Verbosity.h"
 
 namespace aunit {
 
+class TestSuite;
+
 /**
  * Base class of all test cases. The test() and testing() macros define
  * subclasses of Test or TestOnce (respectively), and allow the code following
@@ -58,7 +63,8 @@ class Test {
 
     /**
      * Test is Excluded by an exclude() method. The setup() and teardown()
-     * methods are bypassed and the test goes directly to kLifeCycleFinished.
+     * methods are bypassed and the test is resolved and removed from the list
+     * directly.
      * For reporting purposes, an excluded test is counted as a "skipped" test.
      * The include() method puts the test back into the kLifeCycleNew state.
      */
@@ -107,6 +113,19 @@ class Test {
     /** Test has timed out, or expire() called. */
     static const uint8_t kStatusExpired = 4;
 
+    /** The duration passed to resolve() when it was not measured. */
+    static const uint32_t kDurationUnknown = 0xFFFFFFFF;
+
+  #if EPOXY_DUINO
+    /**
+     * Storage of the life cycle and the status, which may be changed by
+     * assertions made on other threads (see Assertion::stress()).
+     */
+    typedef std::atomic<uint8_t> State;
+  #else
+    typedef uint8_t State;
+  #endif
+
     /**
      * Get the pointer to the root pointer. Implemented as a function static so
      * fixes the C++ static initialization problem making it safe to use this in
@@ -144,6 +163,26 @@ class Test {
      */
     virtual void teardown() {}
 
+    /**
+     * Optional suite-level setup, called once before the first selected test
+     * of a fixture class which is registered using the suiteF() macro. A
+     * fixture class defines its own static setupSuite() to hide this one.
+     */
+    static void setupSuite() {}
+
+    /**
+     * Optional suite-level teardown, called once after the last selected test
+     * of a fixture class which is registered using the suiteF() macro.
+     */
+    static void teardownSuite() {}
+
+    /**
+     * Return the suite registered by suiteF() for the fixture class of this
+     * test, or nullptr if the test does not belong to a suite. Overridden by
+     * the testF(), testingF(), lazyTestF() and lazyTestingF() macros.
+     */
+    virtual const TestSuite* getSuite() const { return nullptr; }
+
     /**
      * The user-provided test case function. Each call to Test::run() makes one
      * call to this loop() method. The assertXxx() macros, as well as pass(),
@@ -151,8 +190,12 @@ class Test {
      */
     virtual void loop() = 0;
 
-    /** Print out the summary of the current test. */
-    void resolve();
+    /**
+     * Print out the summary of the current test. The 'durationMicros' is
+     * printed if Verbosity::kTestDuration is enabled and the duration is
+     * known.
+     */
+    void resolve(uint32_t durationMicros = kDurationUnknown);
 
     /** Get the name of the test. */
     const internal::FCString& getName() const { return mName; }
@@ -168,18 +211,42 @@ class Test {
     /**
      * Set the status of the test. All changes to getStatus() should happen
      * through this method because it also changes the getLifeCycle() of the
-     * test.
+     * test. A kStatusFailed is kept until the status is reset to
+     * kStatusUnknown: pass(), skip() and expire() do not replace it.
      */
     void setStatus(uint8_t status) {
       if (status != kStatusUnknown) {
         setLifeCycle(kLifeCycleAsserted);
       }
-      mStatus = status;
+    #if EPOXY_DUINO
+      if (status == kStatusFailed) sNumThreadFailures++;
+    #endif
+      if (status == kStatusUnknown || status == kStatusFailed) {
+        mStatus = status;
+        return;
+      }
+    #if EPOXY_DUINO
+      // A failure asserted by another thread must not be lost.
+      uint8_t expected = mStatus;
+      while (expected != kStatusFailed
+          && !mStatus.compare_exchange_weak(expected, status)) {}
+    #else
+      if (mStatus != kStatusFailed) mStatus = status;
+    #endif
     }
 
     /** Set the status to Passed or Failed depending on ok. */
     void setPassOrFail(bool ok);
 
+  #if EPOXY_DUINO
+    /**
+     * Return the number of times that the calling thread has failed a test,
+     * through an assertion or fail(). Used by Assertion::stress() to find the
+     * threads which failed.
+     */
+    static uint32_t getNumThreadFailures() { return sNumThreadFailures; }
+  #endif
+
     /**
      * Return the next pointer as a pointer to the pointer, similar to
      * getRoot(). This makes it much easier to manipulate a singly-linked list.
@@ -278,6 +345,8 @@ class Test {
     uint8_t getVerbosity() const { return mVerbosity; }
 
   private:
+    friend class TestRunner;
+
     // Disable copy-constructor and assignment operator
     Test(const Test&) = delete;
     Test& operator=(const Test&) = delete;
@@ -285,9 +354,13 @@ class Test {
     /** Insert into the linked list. */
     void insert();
 
+  #if EPOXY_DUINO
+    static thread_local uint32_t sNumThreadFailures;
+  #endif
+
     internal::FCString mName;
-    uint8_t mLifeCycle;
-    uint8_t mStatus;
+    State mLifeCycle;
+    State mStatus;
     uint8_t mVerbosity;
     Test* mNext;
 };
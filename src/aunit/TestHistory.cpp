@@ -0,0 +1,275 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#if EPOXY_DUINO
+#include <stdio.h>
+#include <stdlib.h> // qsort(), bsearch()
+#include <string.h>
+#include <stdint.h>
+#include <Arduino.h>
+#include "Printer.h"
+#include "Test.h"
+#include "TestRunner.h"
+#endif
+#include "TestHistory.h"
+
+namespace aunit {
+
+#if EPOXY_DUINO
+
+namespace {
+
+// Identifies the format of the history file.
+const char kMagic[4] = {'A', 'U', 'H', '1'};
+
+// The record of a single test in the history file.
+struct Record {
+  uint32_t hash;
+  uint32_t duration;
+  uint8_t status;
+  uint8_t reserved[3];
+};
+
+static_assert(sizeof(Record) == 12, "Unexpected padding of history Record");
+
+// A record of the history file, and its position in the file.
+struct Entry {
+  Record record;
+  uint32_t slot;
+};
+
+FILE* sFile = nullptr;
+
+// The records of the history file, sorted by hash, including those appended
+// by this run.
+Entry* sEntries = nullptr;
+uint32_t sNumEntries = 0;
+uint32_t sMaxEntries = 0;
+
+// The number of records in the file, including those appended by this run.
+uint32_t sNumSlots = 0;
+
+bool sRerunFailed = false;
+bool sOrderByHistory = false;
+
+int compareEntries(const void* a, const void* b) {
+  uint32_t hashA = static_cast<const Entry*>(a)->record.hash;
+  uint32_t hashB = static_cast<const Entry*>(b)->record.hash;
+  return (hashA < hashB) ? -1 : (hashA > hashB) ? 1 : 0;
+}
+
+// Same as compareEntries(), then by slot, so that the duplicate records of a
+// test are sorted from the oldest to the most recent.
+int compareEntrySlots(const void* a, const void* b) {
+  int result = compareEntries(a, b);
+  if (result != 0) return result;
+  uint32_t slotA = static_cast<const Entry*>(a)->slot;
+  uint32_t slotB = static_cast<const Entry*>(b)->slot;
+  return (slotA < slotB) ? -1 : (slotA > slotB) ? 1 : 0;
+}
+
+// Return the entry of the given test, or nullptr if it has no history.
+Entry* findEntry(const Test& test) {
+  Entry key;
+  key.record.hash = test.getName().hash();
+  return static_cast<Entry*>(bsearch(&key, sEntries, sNumEntries,
+      sizeof(Entry), compareEntries));
+}
+
+bool hasFailed(const Entry* entry) {
+  return entry->record.status == Test::kStatusFailed
+      || entry->record.status == Test::kStatusExpired;
+}
+
+// Return true if test 'a' should run after test 'b'. The tests which failed
+// come first, then the tests without a history, then the others from the
+// fastest to the slowest.
+bool isRunAfter(const Entry* a, const Entry* b) {
+  uint8_t rankA = (a == nullptr) ? 1 : hasFailed(a) ? 0 : 2;
+  uint8_t rankB = (b == nullptr) ? 1 : hasFailed(b) ? 0 : 2;
+  if (rankA != rankB) return rankA > rankB;
+  if (rankA == 1) return false;
+  return a->record.duration > b->record.duration;
+}
+
+// Read the records of the file. Returns false if it is not a history file.
+bool readRecords(FILE* file) {
+  char magic[sizeof(kMagic)];
+  if (fread(magic, sizeof(magic), 1, file) != 1) return false;
+  if (memcmp(magic, kMagic, sizeof(kMagic)) != 0) return false;
+
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  uint32_t numRecords = (size - sizeof(kMagic)) / sizeof(Record);
+  fseek(file, sizeof(kMagic), SEEK_SET);
+
+  // Read all the records with a single fread(), then unpack them in place
+  // from the back, since an Entry is larger than a Record.
+  sEntries = static_cast<Entry*>(malloc(numRecords * sizeof(Entry) + 1));
+  if (sEntries == nullptr) return false;
+  Record* records = reinterpret_cast<Record*>(sEntries);
+  sNumEntries = fread(records, sizeof(Record), numRecords, file);
+  for (uint32_t i = sNumEntries; i-- > 0; ) {
+    Record record = records[i];
+    sEntries[i].record = record;
+    sEntries[i].slot = i;
+  }
+  sNumSlots = sNumEntries;
+  sMaxEntries = numRecords;
+
+  // Keep only the most recent record of each test, in case the file was
+  // written by a run which appended the same test more than once.
+  qsort(sEntries, sNumEntries, sizeof(Entry), compareEntrySlots);
+  uint32_t numUnique = 0;
+  for (uint32_t i = 0; i < sNumEntries; i++) {
+    if (i + 1 < sNumEntries
+        && sEntries[i + 1].record.hash == sEntries[i].record.hash) {
+      continue;
+    }
+    sEntries[numUnique++] = sEntries[i];
+  }
+  sNumEntries = numUnique;
+  return true;
+}
+
+// Add the entry of a record appended to the file, keeping the entries sorted,
+// so that the next iteration of the run finds the slot of the record.
+void insertEntry(const Record& record, uint32_t slot) {
+  if (sNumEntries == sMaxEntries) {
+    uint32_t maxEntries = (sMaxEntries < 8) ? 16 : 2 * sMaxEntries;
+    Entry* entries = static_cast<Entry*>(
+        realloc(sEntries, maxEntries * sizeof(Entry)));
+    if (entries == nullptr) return;
+    sEntries = entries;
+    sMaxEntries = maxEntries;
+  }
+
+  uint32_t i = sNumEntries;
+  while (i > 0 && sEntries[i - 1].record.hash > record.hash) i--;
+  memmove(&sEntries[i + 1], &sEntries[i], (sNumEntries - i) * sizeof(Entry));
+  sEntries[i].record = record;
+  sEntries[i].slot = slot;
+  sNumEntries++;
+}
+
+}
+
+bool TestHistory::open(const char* fileName) {
+  static TestHistory listener;
+
+  if (sFile) return true;
+  sFile = fopen(fileName, "r+b");
+  if (sFile == nullptr || !readRecords(sFile)) {
+    if (sFile) fclose(sFile);
+    free(sEntries);
+    sEntries = nullptr;
+    sNumEntries = 0;
+    sMaxEntries = 0;
+    sNumSlots = 0;
+
+    sFile = fopen(fileName, "w+b");
+    if (sFile == nullptr) return false;
+    fwrite(kMagic, sizeof(kMagic), 1, sFile);
+    fflush(sFile);
+  }
+
+  TestRunner::addListener(&listener);
+  return true;
+}
+
+void TestHistory::setRerunFailed(bool rerunFailed) {
+  sRerunFailed = rerunFailed;
+}
+
+void TestHistory::setOrderByHistory(bool orderByHistory) {
+  sOrderByHistory = orderByHistory;
+}
+
+bool TestHistory::apply() {
+  if (!sRerunFailed && !sOrderByHistory) return true;
+  if (sFile == nullptr) return false;
+
+  if (sRerunFailed) excludePassed();
+  if (sOrderByHistory) sortTests();
+  return true;
+}
+
+void TestHistory::excludePassed() {
+  for (Test** p = Test::getRoot(); *p != nullptr; p = (*p)->getNext()) {
+    const Entry* entry = findEntry(**p);
+    if (entry == nullptr || !hasFailed(entry)) {
+      (*p)->setLifeCycle(Test::kLifeCycleExcluded);
+    }
+  }
+}
+
+// A stable insertion sort, like the one used by Test::insert(), so that the
+// tests with the same history are still run in the order of their names.
+void TestHistory::sortTests() {
+  Test** root = Test::getRoot();
+  Test* unsorted = *root;
+  *root = nullptr;
+  while (unsorted != nullptr) {
+    Test* test = unsorted;
+    unsorted = *test->getNext();
+
+    const Entry* entry = findEntry(*test);
+    Test** p = root;
+    while (*p != nullptr && !isRunAfter(findEntry(**p), entry)) {
+      p = (*p)->getNext();
+    }
+    *test->getNext() = *p;
+    *p = test;
+  }
+}
+
+void TestHistory::testFinished(Test& test) {
+  Record record;
+  memset(&record, 0, sizeof(record));
+  record.hash = test.getName().hash();
+  record.duration = TestRunner::getRunner()->mTestDuration;
+  record.status = test.getStatus();
+
+  uint32_t slot;
+  Entry* entry = findEntry(test);
+  if (entry) {
+    slot = entry->slot;
+    entry->record = record;
+  } else {
+    slot = sNumSlots++;
+    insertEntry(record, slot);
+  }
+  fseek(sFile, sizeof(kMagic) + slot * sizeof(Record), SEEK_SET);
+  fwrite(&record, sizeof(record), 1, sFile);
+  fflush(sFile);
+}
+
+void TestHistory::runFinished() {
+  fclose(sFile);
+  sFile = nullptr;
+}
+
+#endif
+
+}
@@ -0,0 +1,94 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_TEST_HISTORY_H
+#define AUNIT_TEST_HISTORY_H
+
+#include "TestListener.h"
+
+namespace aunit {
+
+#if EPOXY_DUINO
+
+class Test;
+
+/**
+ * A TestListener which records the last status and duration of each test in a
+ * binary history file on EpoxyDuino, and uses the history of the previous runs
+ * to select and order the tests of the current run, so that a CI job which
+ * fails reports its first failure as early as possible. It is enabled by the
+ * `--history file` command line flag:
+ *
+ *  - `--rerun-failed` runs only the tests which failed or timed out in the
+ *    previous run in which they were not excluded,
+ *  - `--order history` runs the tests which failed or timed out first, then
+ *    the tests without a history, then the others from the fastest to the
+ *    slowest.
+ *
+ * The file is a 4-byte header followed by a fixed-size record for each test,
+ * containing the FNV-1a hash of its name, its last status and its duration in
+ * microseconds, in the byte order of the host. It is read with a single
+ * fread() at startup, and the record of each test is rewritten in place as
+ * soon as the test finishes, so that the history survives a crash. The file is
+ * created if it does not exist, and reset if it is not a history file.
+ */
+class TestHistory: public TestListener {
+  public:
+    /**
+     * Load the history from the given file, and register the listener which
+     * records the result of each test into it. Returns false if the file
+     * could not be opened for writing.
+     */
+    static bool open(const char* fileName);
+
+    /** Run only the tests which failed or timed out in the previous run. */
+    static void setRerunFailed(bool rerunFailed);
+
+    /** Order the tests by their history, instead of by their name. */
+    static void setOrderByHistory(bool orderByHistory);
+
+    /**
+     * Apply the --rerun-failed and --order flags to the tests. Called by the
+     * TestRunner after all the other filters. Returns false if one of these
+     * flags was given without a history file.
+     */
+    static bool apply();
+
+    void testFinished(Test& test) override;
+
+    void runFinished() override;
+
+  private:
+    /** Exclude the tests which did not fail in the previous run. */
+    static void excludePassed();
+
+    /** Sort the list of tests using their history. */
+    static void sortTests();
+};
+
+#endif
+
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_TEST_LISTENER_H
+#define AUNIT_TEST_LISTENER_H
+
+namespace aunit {
+
+class Test;
+
+/**
+ * Receives notifications from the TestRunner about the life cycle of each
+ * test. A listener is registered using TestRunner::addListener(), and is
+ * typically a global object, so that the instrumentation code is pulled into
+ * the final binary only by the programs which use it. Excluded tests do not
+ * generate any notification.
+ */
+class TestListener {
+  public:
+    /** Called just before the setup() of the test. */
+    virtual void testStarting(Test& /*test*/) {}
+
+    /**
+     * Called just after the teardown() of the test, before its status is
+     * counted and printed. The listener may fail the test by calling
+     * test.setStatus(Test::kStatusFailed).
+     */
+    virtual void testFinished(Test& /*test*/) {}
+
+    /** Called after the summary of the entire run has been printed. */
+    virtual void runFinished() {}
+
+    // NOTE: Don't create a virtual destructor, for the same reason as Test.
+
+  private:
+    friend class TestRunner;
+    friend class ThreadRunner;
+
+    TestListener* mNext = nullptr;
+};
+
+}
+
+#endif
@@ -28,9 +28,9 @@ SOFTWARE.
 /**
  * @file TestMacros.h
  *
- * Various macros (test(), testF(), testing(), testingF(), externTest(),
- * externTestF(), externTesting(), externTestingF()) are defined in this
- * header.
+ * Various macros (test(), simpleTest(), testF(), testing(), testingF(),
+ * lazyTestF(), lazyTestingF(), suiteF(), externTest(), externTestF(),
+ * externTesting(), externTestingF()) are defined in this header.
  */
 
 #ifndef AUNIT_TEST_MACROS_H
@@ -42,6 +42,9 @@ SOFTWARE.
 #include "FCString.h"
 #include "TestOnce.h"
 #include "TestAgain.h"
+#include "LazyTest.h"
+#include "FunctionTest.h"
+#include "TestSuite.h"
 
 /**
  * Macro to define a test that will be run only once.
@@ -77,6 +80,151 @@ suiteName##_##name :: suiteName##_##name() {\
 }\
 void suiteName##_##name :: once()
 
+/**
+ * Macro to define a test that will be run only once, like test(), but which
+ * does not create a new class. The body becomes a specialization of the
+ * FunctionTest::body() member function, so it can use the assertXxx() macros
+ * but cannot hold any state of its own. This saves the flash (and on AVR, the
+ * static memory) consumed by the virtual table and constructor of each test.
+ * The test can be referenced by externSimpleTest().
+ *
+ * Two versions are supported: simpleTest(name) and simpleTest(suiteName, name).
+ */
+#define simpleTest(...) \
+    GET_SIMPLE_TEST(__VA_ARGS__, SIMPLE_TEST2, SIMPLE_TEST1)(__VA_ARGS__)
+
+#define GET_SIMPLE_TEST(_1, _2, NAME, ...) NAME
+
+#define SIMPLE_TEST1(name) \
+  SIMPLE_TEST_IMPL(test_##name, #name)
+
+#define SIMPLE_TEST2(suiteName, name) \
+  SIMPLE_TEST_IMPL(suiteName##_##name, #suiteName "_" #name)
+
+#define SIMPLE_TEST_IMPL(id, nameString) \
+struct id##_tag;\
+template <> void aunit::FunctionTest::body<id##_tag>();\
+static const char id##_name[] PROGMEM = nameString;\
+aunit::FunctionTest id##_instance(\
+    AUNIT_FPSTR(id##_name), &aunit::FunctionTest::body<id##_tag>);\
+template <> void aunit::FunctionTest::body<id##_tag>()
+
+/**
+ * Macro to define a test whose body is run once for each row of a table of
+ * parameters in PROGMEM. Each row is reported and counted as its own test,
+ * named "name/i" where 'i' is the index of the row, and can be selected by the
+ * include() and exclude() filters. The row is available in the body as the
+ * 'param' variable, a const reference to a copy of the row in RAM. For
+ * example:
+ *
+ * @verbatim
+ * struct AddCase { int a; int b; int sum; };
+ * static const AddCase kAddCases[] PROGMEM = {{1, 2, 3}, {2, 2, 4}};
+ *
+ * testP(MathTest, add, AddCase, kAddCases) {
+ *   assertEqual(param.a + param.b, param.sum);
+ * }
+ * @endverbatim
+ *
+ * The 'rows' must be an array, not a pointer, because its number of elements
+ * is determined using sizeof(). The parameter type must be trivially copyable.
+ *
+ * Two versions are supported: testP(name, paramType, rows) and
+ * testP(suiteName, name, paramType, rows).
+ */
+#define testP(...) \
+    GET_PARAM_TEST(__VA_ARGS__, PARAM_TEST4, PARAM_TEST3)(__VA_ARGS__)
+
+#define GET_PARAM_TEST(_1, _2, _3, _4, NAME, ...) NAME
+
+#define PARAM_TEST3(name, paramType, rows) \
+  PARAM_TEST_IMPL(test_##name, #name, paramType, rows)
+
+#define PARAM_TEST4(suiteName, name, paramType, rows) \
+  PARAM_TEST_IMPL(suiteName##_##name, #suiteName "_" #name, paramType, rows)
+
+#define PARAM_TEST_IMPL(id, nameString, paramType, rows) \
+struct id##_tag;\
+template <> void aunit::ParamTest::body<id##_tag, paramType>(\
+    const paramType& param);\
+static const char id##_name[] PROGMEM = nameString;\
+static uint8_t id##_excluded[(sizeof(rows) / sizeof(rows[0]) + 7) / 8];\
+aunit::ParamTest id##_instance(\
+    AUNIT_FPSTR(id##_name), rows, sizeof(rows) / sizeof(rows[0]),\
+    id##_excluded, &aunit::ParamTest::invoke<id##_tag, paramType>);\
+template <> void aunit::ParamTest::body<id##_tag, paramType>(\
+    __attribute__((unused)) const paramType& param)
+
+/**
+ * Macro to define a property which is checked against many randomly generated
+ * inputs, obtained from the genXxx() methods of PropertyTest. A failing case
+ * is shrunk to a small counterexample, which is printed. See PropertyTest.
+ *
+ * Two versions are supported: testProperty(name) and
+ * testProperty(suiteName, name).
+ */
+#define testProperty(...) \
+    GET_PROPERTY(__VA_ARGS__, PROPERTY2, PROPERTY1)(__VA_ARGS__)
+
+#define GET_PROPERTY(_1, _2, NAME, ...) NAME
+
+#define PROPERTY1(name) \
+class test_##name : public aunit::PropertyTest {\
+public:\
+  test_##name();\
+  void check() override;\
+} test_##name##_instance;\
+test_##name :: test_##name() {\
+  init(AUNIT_F(#name)); \
+}\
+void test_##name :: check()
+
+#define PROPERTY2(suiteName, name) \
+class suiteName##_##name : public aunit::PropertyTest {\
+public:\
+  suiteName##_##name();\
+  void check() override;\
+} suiteName##_##name##_instance;\
+suiteName##_##name :: suiteName##_##name() {\
+  init(AUNIT_F(#suiteName "_" #name)); \
+}\
+void suiteName##_##name :: check()
+
+/**
+ * Macro to define a fuzz target, whose body receives an input as the 'data'
+ * and 'size' parameters, and checks it using the assertion macros. It is
+ * normally run as a test which replays a corpus of saved inputs, and is
+ * passed to libFuzzer when compiled with AUNIT_FUZZ. See FuzzTest.
+ *
+ * Two versions are supported: testFuzz(name) and testFuzz(suiteName, name).
+ */
+#define testFuzz(...) \
+    GET_FUZZ(__VA_ARGS__, FUZZ2, FUZZ1)(__VA_ARGS__)
+
+#define GET_FUZZ(_1, _2, NAME, ...) NAME
+
+#define FUZZ1(name) \
+class test_##name : public aunit::FuzzTest {\
+public:\
+  test_##name();\
+  void fuzzInput(const uint8_t* data, size_t size) override;\
+} test_##name##_instance;\
+test_##name :: test_##name() {\
+  init(AUNIT_F(#name)); \
+}\
+void test_##name :: fuzzInput(const uint8_t* data, size_t size)
+
+#define FUZZ2(suiteName, name) \
+class suiteName##_##name : public aunit::FuzzTest {\
+public:\
+  suiteName##_##name();\
+  void fuzzInput(const uint8_t* data, size_t size) override;\
+} suiteName##_##name##_instance;\
+suiteName##_##name :: suiteName##_##name() {\
+  init(AUNIT_F(#suiteName "_" #name)); \
+}\
+void suiteName##_##name :: fuzzInput(const uint8_t* data, size_t size)
+
 /**
  * Macro to define a test that will run repeatly upon each iteration of the
  * global loop() method, stopping when the something calls Test::pass(),
@@ -143,6 +291,23 @@ public:\
 };\
 extern suiteName##_##name suiteName##_##name##_instance
 
+/**
+ * Create an extern reference to a simpleTest() test case object defined
+ * elsewhere. The meta assertions use the same names as test(), e.g.
+ * assertTestPass(name) or assertTestPass(suiteName, name).
+ */
+#define externSimpleTest(...) \
+    GET_EXTERN_SIMPLE_TEST(__VA_ARGS__, \
+        EXTERN_SIMPLE_TEST2, EXTERN_SIMPLE_TEST1)(__VA_ARGS__)
+
+#define GET_EXTERN_SIMPLE_TEST(_1, _2, NAME, ...) NAME
+
+#define EXTERN_SIMPLE_TEST1(name) \
+extern aunit::FunctionTest test_##name##_instance
+
+#define EXTERN_SIMPLE_TEST2(suiteName, name) \
+extern aunit::FunctionTest suiteName##_##name##_instance
+
 /**
  * Create an extern reference to a testing() test case object defined
  * elsewhere.  This is only necessary if you use assertTestXxx() or
@@ -182,11 +347,15 @@ extern suiteName##_##name suiteName##_##name##_instance
 class testClass ## _ ## name : public testClass {\
 public:\
   testClass ## _ ## name();\
+  const aunit::TestSuite* getSuite() const override;\
   void once() override;\
 } testClass ## _ ## name ## _instance;\
 testClass ## _ ## name :: testClass ## _ ## name() {\
   init(AUNIT_F(#testClass "_" #name));\
 }\
+const aunit::TestSuite* testClass ## _ ## name :: getSuite() const {\
+  return aunitFixtureSuite((const testClass*) nullptr);\
+}\
 void testClass ## _ ## name :: once()
 
 /**
@@ -201,13 +370,204 @@ void testClass ## _ ## name :: once()
 class testClass ## _ ## name : public testClass {\
 public:\
   testClass ## _ ## name();\
+  const aunit::TestSuite* getSuite() const override;\
   void again() override;\
 } testClass ## _ ## name ## _instance;\
 testClass ## _ ## name :: testClass ## _ ## name() {\
   init(AUNIT_F(#testClass "_" #name));\
 }\
+const aunit::TestSuite* testClass ## _ ## name :: getSuite() const {\
+  return aunitFixtureSuite((const testClass*) nullptr);\
+}\
 void testClass ## _ ## name :: again()
 
+/**
+ * Create a test that is derived from a custom TestOnce class, like testF(),
+ * but whose fixture is constructed in a shared arena only while the test is
+ * running. See LazyTest. The static memory consumed by the fixtures of all
+ * lazy tests is AUNIT_FIXTURE_ARENA_SIZE, instead of the sum of their sizes.
+ * The test cannot be referenced by externTestF().
+ */
+#define lazyTestF(testClass, name) \
+class testClass ## _ ## name : public testClass {\
+public:\
+  void once() override;\
+};\
+static const char testClass ## _ ## name ## _lazyName[] PROGMEM = \
+    #testClass "_" #name;\
+aunit::LazyTest testClass ## _ ## name ## _instance(\
+    AUNIT_FPSTR(testClass ## _ ## name ## _lazyName),\
+    aunitFixtureSuite((const testClass*) nullptr),\
+    aunit::internal::createFixture<\
+        testClass ## _ ## name, AUNIT_FIXTURE_ARENA_SIZE>,\
+    aunit::internal::destroyFixture<\
+        testClass ## _ ## name, AUNIT_FIXTURE_ARENA_SIZE>);\
+void testClass ## _ ## name :: once()
+
+/**
+ * Create a test that is derived from a custom TestAgain class, like
+ * testingF(), but whose fixture is constructed in a shared arena only while
+ * the test is running. See lazyTestF().
+ */
+#define lazyTestingF(testClass, name) \
+class testClass ## _ ## name : public testClass {\
+public:\
+  void again() override;\
+};\
+static const char testClass ## _ ## name ## _lazyName[] PROGMEM = \
+    #testClass "_" #name;\
+aunit::LazyTest testClass ## _ ## name ## _instance(\
+    AUNIT_FPSTR(testClass ## _ ## name ## _lazyName),\
+    aunitFixtureSuite((const testClass*) nullptr),\
+    aunit::internal::createFixture<\
+        testClass ## _ ## name, AUNIT_FIXTURE_ARENA_SIZE>,\
+    aunit::internal::destroyFixture<\
+        testClass ## _ ## name, AUNIT_FIXTURE_ARENA_SIZE>);\
+void testClass ## _ ## name :: again()
+
+/**
+ * Register the static setupSuite() and teardownSuite() methods of the
+ * 'testClass' fixture, so that they are called once before the first and
+ * after the last selected test of the fixture. See TestSuite. Should appear
+ * only once for each fixture class, before the testF(), testingF(),
+ * lazyTestF() and lazyTestingF() tests of the fixture, which are the members
+ * of the suite. The tests of a subclass of the
+ * fixture are not members. The class templates of typedTestF() and
+ * typedTestingF() cannot be registered.
+ */
+#define suiteF(testClass) \
+extern aunit::TestSuite testClass ## _suite;\
+inline const aunit::TestSuite* aunitFixtureSuite(const testClass*) {\
+  return &testClass ## _suite;\
+}\
+aunit::TestSuite testClass ## _suite(\
+    testClass::setupSuite,\
+    testClass::teardownSuite)
+
+/**
+ * Create a test derived from the class template 'testClass', for each type in
+ * the parenthesized list 'types', for example:
+ *
+ * @verbatim
+ * template <typename T>
+ * class RingBufferTest: public aunit::TestOnce {
+ *   protected:
+ *     RingBuffer<T, 8> buffer;
+ * };
+ *
+ * #define RING_BUFFER_TYPES (uint8_t, uint16_t, uint32_t, float)
+ *
+ * typedTestF(RingBufferTest, RING_BUFFER_TYPES, push) {
+ *   this->buffer.push(TypeParam(1));
+ *   assertEqual(this->buffer.size(), 1);
+ * }
+ * @endverbatim
+ *
+ * The test for type T is named '{testClass}<T>_{name}' and its instance is
+ * '{testClass}_{name}_instance{i}', where 'i' is the index of T in the list.
+ * The body is compiled once per type, with the type available as 'TypeParam'.
+ * The members of the fixture must be accessed through 'this->' because the
+ * base class depends on the template parameter, but the assertion macros and
+ * pass(), fail(), skip() and expire() can be used as usual. A type list holds up to 8
+ * types, which must not contain a comma.
+ */
+#define typedTestF(testClass, types, name) \
+template <typename TypeParam>\
+class testClass ## _ ## name : public testClass<TypeParam> {\
+public:\
+  TYPED_TEST_USING(testClass<TypeParam>)\
+  explicit testClass ## _ ## name(const __FlashStringHelper* testName) {\
+    this->init(testName);\
+  }\
+  void once() override;\
+};\
+AUNIT_FOR_EACH_TYPE(TYPED_TEST_INSTANCE, testClass, name,\
+    AUNIT_UNPAREN types)\
+template <typename TypeParam>\
+void testClass ## _ ## name<TypeParam> :: once()
+
+/**
+ * Create a test derived from the class template 'testClass', which must be a
+ * subclass of TestAgain, for each type in the parenthesized list 'types'. See
+ * typedTestF().
+ */
+#define typedTestingF(testClass, types, name) \
+template <typename TypeParam>\
+class testClass ## _ ## name : public testClass<TypeParam> {\
+public:\
+  TYPED_TEST_USING(testClass<TypeParam>)\
+  explicit testClass ## _ ## name(const __FlashStringHelper* testName) {\
+    this->init(testName);\
+  }\
+  void again() override;\
+};\
+AUNIT_FOR_EACH_TYPE(TYPED_TEST_INSTANCE, testClass, name,\
+    AUNIT_UNPAREN types)\
+template <typename TypeParam>\
+void testClass ## _ ## name<TypeParam> :: again()
+
+#define TYPED_TEST_INSTANCE(testClass, name, T, i) \
+static const char testClass ## _ ## name ## _name ## i[] PROGMEM =\
+    #testClass "<" #T ">_" #name;\
+testClass ## _ ## name<T> testClass ## _ ## name ## _instance ## i(\
+    AUNIT_FPSTR(testClass ## _ ## name ## _name ## i));
+
+// The base class of a typed test depends on the template parameter, so the
+// names used by the assertion macros must be brought into scope explicitly.
+#define TYPED_TEST_USING(base) \
+  using base::assertion;\
+  using base::assertionBool;\
+  using base::assertionNear;\
+  using base::assertionVerbose;\
+  using base::assertionBoolVerbose;\
+  using base::assertionNearVerbose;\
+  using base::assertionNoSlowerThan;\
+  using base::assertionAllocations;\
+  using base::assertionPrinted;\
+  using base::assertionBytes;\
+  using base::assertionArrayNear;\
+  using base::assertionTestStatus;\
+  using base::setStatusNow;\
+  using base::isDone;\
+  using base::pass;\
+  using base::fail;\
+  using base::skip;\
+  using base::expire;\
+  TYPED_TEST_USING_STRESS(base)
+
+#if EPOXY_DUINO
+  #define TYPED_TEST_USING_STRESS(base) using base::stress;
+#else
+  #define TYPED_TEST_USING_STRESS(base)
+#endif
+
+#define AUNIT_UNPAREN(...) __VA_ARGS__
+
+// Apply m(c, n, T, i) to each type T in the list, where i is the index of T.
+#define AUNIT_FOR_EACH_TYPE(m, c, n, ...) \
+  GET_FOR_EACH_TYPE(__VA_ARGS__, FOR_EACH_TYPE8, FOR_EACH_TYPE7,\
+      FOR_EACH_TYPE6, FOR_EACH_TYPE5, FOR_EACH_TYPE4, FOR_EACH_TYPE3,\
+      FOR_EACH_TYPE2, FOR_EACH_TYPE1)(m, c, n, __VA_ARGS__)
+
+#define GET_FOR_EACH_TYPE(_1, _2, _3, _4, _5, _6, _7, _8, NAME, ...) NAME
+
+#define FOR_EACH_TYPE1(m, c, n, T0) \
+  m(c, n, T0, 0)
+#define FOR_EACH_TYPE2(m, c, n, T0, T1) \
+  FOR_EACH_TYPE1(m, c, n, T0) m(c, n, T1, 1)
+#define FOR_EACH_TYPE3(m, c, n, T0, T1, T2) \
+  FOR_EACH_TYPE2(m, c, n, T0, T1) m(c, n, T2, 2)
+#define FOR_EACH_TYPE4(m, c, n, T0, T1, T2, T3) \
+  FOR_EACH_TYPE3(m, c, n, T0, T1, T2) m(c, n, T3, 3)
+#define FOR_EACH_TYPE5(m, c, n, T0, T1, T2, T3, T4) \
+  FOR_EACH_TYPE4(m, c, n, T0, T1, T2, T3) m(c, n, T4, 4)
+#define FOR_EACH_TYPE6(m, c, n, T0, T1, T2, T3, T4, T5) \
+  FOR_EACH_TYPE5(m, c, n, T0, T1, T2, T3, T4) m(c, n, T5, 5)
+#define FOR_EACH_TYPE7(m, c, n, T0, T1, T2, T3, T4, T5, T6) \
+  FOR_EACH_TYPE6(m, c, n, T0, T1, T2, T3, T4, T5) m(c, n, T6, 6)
+#define FOR_EACH_TYPE8(m, c, n, T0, T1, T2, T3, T4, T5, T6, T7) \
+  FOR_EACH_TYPE7(m, c, n, T0, T1, T2, T3, T4, T5, T6) m(c, n, T7, 7)
+
 /**
  * Create an extern reference to a testF() test case object defined elsewhere.
  * This is only necessary if you use assertTestXxx() or checkTestXxx() when the
@@ -217,6 +577,7 @@ void testClass ## _ ## name :: again()
 class testClass ## _ ## name : public testClass {\
 public:\
   testClass ## _ ## name();\
+  const aunit::TestSuite* getSuite() const override;\
   void once() override;\
 };\
 extern testClass ## _ ## name testClass##_##name##_instance
@@ -231,6 +592,7 @@ extern testClass ## _ ## name testClass##_##name##_instance
 class testClass ## _ ## name : public testClass {\
 public:\
   testClass ## _ ## name();\
+  const aunit::TestSuite* getSuite() const override;\
   void again() override;\
 };\
 extern testClass ## _ ## name testClass##_##name##_instance
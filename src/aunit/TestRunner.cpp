@@ -24,6 +24,7 @@ SOFTWARE.
 
 #if EPOXY_DUINO
 #include <stdio.h>
+#include <stdlib.h> // strtoul()
 #endif
 #include <Arduino.h>  // 'Serial' or SERIAL_PORT_MONITOR
 #include <string.h>
@@ -33,7 +34,14 @@ SOFTWARE.
 #include "Printer.h"
 #include "Verbosity.h"
 #include "Test.h"
+#include "Timer.h"
 #include "TestRunner.h"
+#include "Benchmark.h"
+#include "Clock.h"
+#include "PropertyTest.h"
+#include "FuzzTest.h"
+#include "TestHistory.h"
+#include "ThreadRunner.h"
 #include "string_util.h"
 
 namespace aunit {
@@ -47,6 +55,20 @@ TestRunner* TestRunner::getRunner() {
   return &singletonRunner;
 }
 
+TestRunner::FilterRowsHook TestRunner::sFilterRowsHook = nullptr;
+TestRunner::CountRowsHook TestRunner::sCountRowsHook = nullptr;
+TestRunner::CountTestHook TestRunner::sCountTestHook = nullptr;
+TestRunner::RetireTestHook TestRunner::sRetireTestHook = nullptr;
+TestRunner::RestartRunHook TestRunner::sRestartRunHook = nullptr;
+TestRunner::DrainIsrHook TestRunner::sDrainIsrHook = nullptr;
+TestRunner::StartTimerHook TestRunner::sStartTimerHook = nullptr;
+TestRunner::StopTimerHook TestRunner::sStopTimerHook = nullptr;
+TestRunner::MillisHook TestRunner::sMillisHook = nullptr;
+TestRunner::VirtualTimeHook TestRunner::sVirtualTimeHook = nullptr;
+#if EPOXY_DUINO
+TestRunner::RunJobsHook TestRunner::sRunJobsHook = nullptr;
+#endif
+
 void TestRunner::setPrinter(Print* printer) {
   Printer::setPrinter(printer);
 }
@@ -73,6 +95,7 @@ void TestRunner::setLifeCycleMatchingPattern(const char* pattern,
       (*p)->setLifeCycle(lifeCycle);
     }
   }
+  if (sFilterRowsHook) sFilterRowsHook(pattern, length, false, lifeCycle);
 }
 
 void TestRunner::setLifeCycleMatchingPattern(const char* testClass,
@@ -111,12 +134,14 @@ void TestRunner::setLifeCycleMatchingSubstring(
       (*p)->setLifeCycle(lifeCycle);
     }
   }
+  if (sFilterRowsHook) sFilterRowsHook(substring, 0, true, lifeCycle);
 }
 
 void TestRunner::excludeAll() {
   for (Test** p = Test::getRoot(); *p != nullptr; p = (*p)->getNext()) {
     (*p)->setLifeCycle(Test::kLifeCycleExcluded);
   }
+  if (sFilterRowsHook) sFilterRowsHook("", 0, false, Test::kLifeCycleExcluded);
 }
 
 // Count the number of tests in TestRunner instead of Test::insert() to avoid
@@ -148,9 +173,38 @@ void printSeconds(Print* printer, unsigned long timeMillis) {
 
 }
 
+void TestRunner::enableTestTimer() {
+  if (! Timer::isCalibrated()) Timer::calibrate();
+  sStartTimerHook = &startTestTimer;
+  sStopTimerHook = &stopTestTimer;
+}
+
+void TestRunner::startTestTimer(TestRunner& runner) {
+  runner.mTimedTest = *runner.mCurrent;
+  runner.mTestStartTicks = Timer::ticks();
+  runner.mTestStartMillis = millis();
+}
+
+// The Timer ticks roll over after a few seconds on some platforms, so use them
+// only for short tests, and fall back to millis() for the long ones.
+uint32_t TestRunner::stopTestTimer(TestRunner& runner) {
+  uint32_t elapsedTicks = Timer::ticks() - runner.mTestStartTicks;
+  unsigned long elapsedMillis = millis() - runner.mTestStartMillis;
+  if (runner.mTimedTest != *runner.mCurrent) return Test::kDurationUnknown;
+
+  if (elapsedMillis < Timer::kMaxTickMillis) {
+    uint32_t overhead = Timer::overhead();
+    elapsedTicks = (elapsedTicks > overhead) ? elapsedTicks - overhead : 0;
+    return Timer::toMicros(elapsedTicks);
+  } else {
+    return elapsedMillis * 1000;
+  }
+}
+
 void TestRunner::printStartRunner() const {
   if (!isVerbosity(Verbosity::kTestRunSummary)) return;
 
+  Printer::setMessageVerbosity(Verbosity::kTestRunSummary);
   Print* printer = Printer::getPrinter();
   printer->print(F("TestRunner started on "));
   printer->print(mCount);
@@ -161,11 +215,13 @@ void TestRunner::resolveRun() const {
   if (!isVerbosity(Verbosity::kTestRunSummary)) return;
   Print* printer = Printer::getPrinter();
 
-  unsigned long elapsedTime = mEndTime - mStartTime;
+  unsigned long elapsedTime = mEndTime - mStartTime + mElapsedTime;
+  Printer::setMessageVerbosity(Verbosity::kTestRunSummary);
   printer->print(F("TestRunner duration: "));
   printSeconds(printer, elapsedTime);
   printer->println(" seconds.");
 
+  Printer::setMessageVerbosity(Verbosity::kTestRunSummary);
   printer->print(F("TestRunner summary: "));
   printer->print(mPassedCount);
   printer->print(F(" passed, "));
@@ -183,6 +239,161 @@ void TestRunner::setRunnerTimeout(TimeoutType timeout) {
   mTimeout = timeout;
 }
 
+#if EPOXY_DUINO
+
+void TestRunner::setJobs(uint8_t jobs) {
+  ThreadRunner::setJobs(jobs);
+  sRunJobsHook = (ThreadRunner::getJobs() > 1) ? &ThreadRunner::run : nullptr;
+}
+
+void TestRunner::serial(const char* pattern) {
+  ThreadRunner::addSerial(pattern);
+}
+
+#endif
+
+//----------------------------------------------------------------------------
+// Repeated runs
+//----------------------------------------------------------------------------
+
+namespace {
+
+// The number of failures of a test in a repeated run.
+struct FailureCount {
+  const Test* test;
+  uint32_t count;
+};
+
+uint16_t sRepeatCount = 1;
+uint32_t sNumIterations = 0;
+
+// The failed and expired counts at the start of the current iteration.
+uint32_t sFailuresAtStart = 0;
+
+// The tests which finished the current iteration.
+Test* sRetired = nullptr;
+
+FailureCount sFailureCounts[AUNIT_REPEAT_MAX_FAILING];
+uint8_t sNumFailing = 0;
+uint32_t sNumUncounted = 0;
+
+void countFailure(const Test* test) {
+  for (uint8_t i = 0; i < sNumFailing; i++) {
+    if (sFailureCounts[i].test == test) {
+      sFailureCounts[i].count++;
+      return;
+    }
+  }
+  if (sNumFailing < AUNIT_REPEAT_MAX_FAILING) {
+    sFailureCounts[sNumFailing].test = test;
+    sFailureCounts[sNumFailing].count = 1;
+    sNumFailing++;
+  } else {
+    sNumUncounted++;
+  }
+}
+
+// Print count/total as a percentage with 1 decimal place, without floating
+// point math. Large counts are scaled down so that 1000 * count fits in 32
+// bits.
+void printPercent(Print* printer, uint32_t count, uint32_t total) {
+  while (total > 4000000UL) {
+    count >>= 1;
+    total >>= 1;
+  }
+  uint32_t permille = (1000UL * count + total / 2) / total;
+  printer->print((unsigned long) permille / 10);
+  printer->print('.');
+  printer->print((unsigned) (permille % 10));
+  printer->print('%');
+}
+
+}
+
+void TestRunner::setVirtualTime(bool isVirtual) {
+  Clock::setVirtual(isVirtual);
+  sMillisHook = isVirtual ? &Clock::runnerMillis : nullptr;
+  sVirtualTimeHook = isVirtual ? &Clock::runnerStep : nullptr;
+}
+
+void TestRunner::setRepeatCount(uint16_t count) {
+  sRepeatCount = count;
+  sRetireTestHook = &retireTest;
+  sRestartRunHook = &restartRun;
+}
+
+void TestRunner::retireTest(TestRunner& /*runner*/, Test* test,
+    uint8_t lifeCycle) {
+  if (test->isFailed() || test->isExpired()) countFailure(test);
+  test->setLifeCycle(lifeCycle);
+  *test->getNext() = sRetired;
+  sRetired = test;
+}
+
+bool TestRunner::restartRun(TestRunner& runner) {
+  sNumIterations++;
+  uint32_t failures = runner.mFailedCount + runner.mExpiredCount;
+  bool isComplete = (sRepeatCount == kRepeatUntilFail)
+      ? failures != sFailuresAtStart
+      : sNumIterations >= sRepeatCount;
+  if (isComplete) {
+    runner.printRepeatSummary();
+    return false;
+  }
+  sFailuresAtStart = failures;
+
+  // Put the tests back into their original order and initial state. The
+  // excluded tests are kept, so that each iteration counts the same tests.
+  while (sRetired != nullptr) {
+    Test* test = sRetired;
+    sRetired = *test->getNext();
+    test->setStatus(Test::kStatusUnknown);
+    test->insert();
+  }
+#if EPOXY_DUINO
+  TestHistory::apply();
+  runner.mIsJobsDone = false;
+#endif
+
+  runner.mCount += countTests();
+  if (sCountRowsHook) sCountRowsHook(runner);
+  unsigned long now = runnerMillis();
+  runner.mElapsedTime += now - runner.mStartTime;
+  runner.mStartTime = now;
+  runner.mTimedTest = nullptr;
+  runner.mCurrent = Test::getRoot();
+  return true;
+}
+
+void TestRunner::printRepeatSummary() const {
+  if (!isVerbosity(Verbosity::kTestRunSummary)) return;
+  Print* printer = Printer::getPrinter();
+
+  Printer::setMessageVerbosity(Verbosity::kTestRunSummary);
+  printer->print(F("TestRunner repeated "));
+  printer->print(sNumIterations);
+  printer->println(F(" time(s)."));
+  for (uint8_t i = 0; i < sNumFailing; i++) {
+    const FailureCount& failure = sFailureCounts[i];
+    Printer::setMessageVerbosity(Verbosity::kTestRunSummary);
+    printer->print(F("Test "));
+    failure.test->getName().print(printer);
+    printer->print(F(" failed or timed out "));
+    printer->print(failure.count);
+    printer->print(F(" of "));
+    printer->print(sNumIterations);
+    printer->print(F(" time(s) ("));
+    printPercent(printer, failure.count, sNumIterations);
+    printer->println(F(")."));
+  }
+  if (sNumUncounted > 0) {
+    Printer::setMessageVerbosity(Verbosity::kTestRunSummary);
+    printer->print(F("TestRunner did not count "));
+    printer->print(sNumUncounted);
+    printer->println(F(" other failure(s), increase AUNIT_REPEAT_MAX_FAILING."));
+  }
+}
+
 //----------------------------------------------------------------------------
 // Command line argument processing on EpoxyDuino
 //----------------------------------------------------------------------------
@@ -203,12 +414,27 @@ static void usageAndExit(int status) {
     "Usage: %s [--help|-h]\n"
       "   [--include pattern,...] [--exclude pattern,...]\n"
       "   [--includesub substring,...] [--excludesub substring,...]\n"
+      "   [--baseline file] [--save-baseline file] [--seed seed]\n"
+      "   [--corpus dir] [--history file] [--rerun-failed]\n"
+      "   [--order name|history] [--repeat N] [--repeat-until-fail]\n"
+      "   [--jobs N] [--serial pattern,...] [--virtual-time]\n"
       "   [--] [substring ...]\n",
     epoxy_argv[0]
   );
   exit(status);
 }
 
+static void parseOrder(const char* order) {
+  if (argEquals(order, "history")) {
+    TestHistory::setOrderByHistory(true);
+  } else if (argEquals(order, "name")) {
+    TestHistory::setOrderByHistory(false);
+  } else {
+    fprintf(stderr, "Unknown order '%s'\n", order);
+    usageAndExit(1);
+  }
+}
+
 void TestRunner::processCommaList(
     const char* const commaList, FilterType filterType) {
 
@@ -242,6 +468,9 @@ void TestRunner::processCommaList(
       case FilterType::kExcludeSub:
         excludesub(argument);
         break;
+      case FilterType::kSerial:
+        serial(argument);
+        break;
     }
 
     list += (comma) ? length + 1 : length;
@@ -272,6 +501,63 @@ int TestRunner::parseFlags(int argc, const char* const* argv) {
       shift(argc, argv);
       if (argc == 0) usageAndExit(1);
       processCommaList(argv[0], FilterType::kExcludeSub);
+    } else if (argEquals(argv[0], "--baseline")) {
+      shift(argc, argv);
+      if (argc == 0) usageAndExit(1);
+      if (!Benchmark::loadBaselines(argv[0])) {
+        fprintf(stderr, "Unable to read baseline file '%s'\n", argv[0]);
+        exit(1);
+      }
+    } else if (argEquals(argv[0], "--save-baseline")) {
+      shift(argc, argv);
+      if (argc == 0) usageAndExit(1);
+      if (!Benchmark::saveBaselines(argv[0])) {
+        fprintf(stderr, "Unable to write baseline file '%s'\n", argv[0]);
+        exit(1);
+      }
+    } else if (argEquals(argv[0], "--seed")) {
+      shift(argc, argv);
+      if (argc == 0) usageAndExit(1);
+      PropertyTest::setSeed(strtoul(argv[0], nullptr, 0));
+    } else if (argEquals(argv[0], "--corpus")) {
+      shift(argc, argv);
+      if (argc == 0) usageAndExit(1);
+      FuzzTest::setCorpus(argv[0]);
+    } else if (argEquals(argv[0], "--history")) {
+      shift(argc, argv);
+      if (argc == 0) usageAndExit(1);
+      if (!TestHistory::open(argv[0])) {
+        fprintf(stderr, "Unable to open history file '%s'\n", argv[0]);
+        exit(1);
+      }
+    } else if (argEquals(argv[0], "--repeat")) {
+      shift(argc, argv);
+      if (argc == 0) usageAndExit(1);
+      unsigned long count = strtoul(argv[0], nullptr, 0);
+      if (count == 0 || count > 0xFFFF) usageAndExit(1);
+      setRepeat(count);
+    } else if (argEquals(argv[0], "--repeat-until-fail")) {
+      setRepeat(kRepeatUntilFail);
+    } else if (argEquals(argv[0], "--jobs")) {
+      shift(argc, argv);
+      if (argc == 0) usageAndExit(1);
+      unsigned long jobs = strtoul(argv[0], nullptr, 0);
+      if (jobs > ThreadRunner::kMaxJobs) usageAndExit(1);
+      setJobs(jobs);
+    } else if (argEquals(argv[0], "--serial")) {
+      shift(argc, argv);
+      if (argc == 0) usageAndExit(1);
+      processCommaList(argv[0], FilterType::kSerial);
+    } else if (argEquals(argv[0], "--virtual-time")) {
+      setVirtualTime(true);
+    } else if (argEquals(argv[0], "--rerun-failed")) {
+      TestHistory::setRerunFailed(true);
+    } else if (argEquals(argv[0], "--order")) {
+      shift(argc, argv);
+      if (argc == 0) usageAndExit(1);
+      parseOrder(argv[0]);
+    } else if (strncmp(argv[0], "--order=", 8) == 0) {
+      parseOrder(argv[0] + 8);
     } else if (argEquals(argv[0], "--")) {
       shift(argc, argv);
       break;
@@ -297,6 +583,12 @@ void TestRunner::processCommandLine() {
   for (int i = args; i < epoxy_argc; i++) {
     includesub(epoxy_argv[i]);
   }
+
+  // Apply the history after all the other filters.
+  if (!TestHistory::apply()) {
+    fprintf(stderr, "--rerun-failed and --order history require --history\n");
+    exit(1);
+  }
 }
 
 #endif
@@ -28,9 +28,27 @@ SOFTWARE.
 #if defined(EPOXY_DUINO)
 #include <stdlib.h> // exit()
 #endif
+#if EPOXY_DUINO
+#include <atomic>
+#endif
 #include <stdint.h>
 #include <Arduino.h> // SERIAL_PORT_MONITOR, F(), Print
+#include "Verbosity.h"
 #include "Test.h"
+#include "Printer.h"
+#include "TestListener.h"
+#if EPOXY_DUINO && defined(AUNIT_FUZZ)
+#include "FuzzTest.h"
+#endif
+
+/**
+ * Maximum number of failing tests whose failures are counted by a repeated
+ * run, see TestRunner::setRepeat(). Each one consumes 4-6 bytes of static
+ * memory. It can be overridden by defining it in the compiler flags.
+ */
+#ifndef AUNIT_REPEAT_MAX_FAILING
+  #define AUNIT_REPEAT_MAX_FAILING 16
+#endif
 
 // ESP32 does not defined SERIAL_PORT_MONITOR
 #ifndef SERIAL_PORT_MONITOR
@@ -47,15 +65,25 @@ namespace aunit {
  */
 class TestRunner {
   public:
+    /** Value of setRepeat() which repeats the tests until one fails. */
+    static const uint16_t kRepeatUntilFail = 0;
+
     /**
      * Integer type of the timeout parameter. Seconds. Default is
      * kTimeoutDefault = 10
      */
     typedef uint16_t TimeoutType;
 
-    /** Run all tests using the current runner. */
+    /**
+     * Run all tests using the current runner. When compiled with AUNIT_FUZZ
+     * on EpoxyDuino, run libFuzzer on the testFuzz() target instead.
+     */
     static void run() {
+    #if EPOXY_DUINO && defined(AUNIT_FUZZ)
+      FuzzTest::runFuzzer();
+    #else
       getRunner()->runTest();
+    #endif
     }
 
     /** Print out the known tests. For debugging only. */
@@ -114,8 +142,12 @@ class TestRunner {
           substring, Test::kLifeCycleNew);
     }
 
-    /** Set the verbosity flag. */
+    /**
+     * Set the verbosity flag. Verbosity::kTestDuration also enables the Timer
+     * which measures the duration of each test.
+     */
     static void setVerbosity(uint8_t verbosity) {
+      if (verbosity & Verbosity::kTestDuration) enableTestTimer();
       getRunner()->setVerbosityFlag(verbosity);
     }
 
@@ -137,7 +169,130 @@ class TestRunner {
       getRunner()->setRunnerTimeout(seconds);
     }
 
+    /**
+     * Run the selected tests 'count' times in the same process, to detect
+     * the flaky tests without flashing the board again. The tests are put
+     * back into their initial state before each iteration, so that their
+     * setup() and teardown() are called again. A count of kRepeatUntilFail
+     * repeats the tests until an iteration fails. At the end, the number of
+     * failures of each failing test is printed before the summary.
+     */
+    static void setRepeat(uint16_t count) {
+      getRunner()->setRepeatCount(count);
+    }
+
+    /**
+     * Register a listener which is notified about the life cycle of each
+     * test. Listeners are notified in the order in which they were added.
+     */
+    static void addListener(TestListener* listener) {
+      getRunner()->addTestListener(listener);
+    }
+
+    /**
+     * Enable the virtual time of the Clock, which skips ahead to the earliest
+     * deadline given to Clock::idleUntil() whenever every runnable test is
+     * waiting. The timeout of setTimeout() and the duration of the run are
+     * then measured using the Clock.
+     */
+    static void setVirtualTime(bool isVirtual);
+
+  #if EPOXY_DUINO
+    /**
+     * Run the tests on 'jobs' worker threads on EpoxyDuino, see ThreadRunner.
+     * A value of 0 starts one thread per CPU, and 1 runs the tests on the
+     * main thread as usual.
+     */
+    static void setJobs(uint8_t jobs);
+
+    /**
+     * Run the tests which match the pattern on the main thread, after the
+     * tests run by the worker threads of setJobs(). Currently supports only a
+     * trailing '*', like include().
+     */
+    static void serial(const char* pattern);
+  #endif
+
   private:
+    friend class IsrMonitor;
+    friend class ParamTest;
+    friend class TestHistory;
+    friend class ThreadRunner;
+
+    /**
+     * Hook which applies a filter to the individual rows of the parameterized
+     * tests. See ParamTest::filterRows().
+     */
+    typedef void (*FilterRowsHook)(const char* pattern, size_t length,
+        bool isSubstring, uint8_t lifeCycle);
+
+    /**
+     * Hook which adds the rows of the parameterized tests to the test counts.
+     * See ParamTest::countRows().
+     */
+    typedef void (*CountRowsHook)(TestRunner& runner);
+
+    /**
+     * Hook which counts the status of a finished test which counts itself,
+     * and returns false for the other tests. See ParamTest::countTest().
+     */
+    typedef bool (*CountTestHook)(TestRunner& runner, Test& test);
+
+    /**
+     * Hook which keeps the finished tests of a repeated run, so that they can
+     * be run again. See TestRunner::retireTest().
+     */
+    typedef void (*RetireTestHook)(TestRunner& runner, Test* test,
+        uint8_t lifeCycle);
+
+    /**
+     * Hook which starts the next iteration of a repeated run. Returns false
+     * if the run is complete. See TestRunner::restartRun().
+     */
+    typedef bool (*RestartRunHook)(TestRunner& runner);
+
+    /**
+     * Hook which starts measuring the duration of the current test. See
+     * TestRunner::startTestTimer().
+     */
+    typedef void (*StartTimerHook)(TestRunner& runner);
+
+    /**
+     * Hook which returns the duration of the current test. See
+     * TestRunner::stopTestTimer().
+     */
+    typedef uint32_t (*StopTimerHook)(TestRunner& runner);
+
+    /** Hook which returns the time of the Clock. See Clock::millis(). */
+    typedef unsigned long (*MillisHook)();
+
+    /**
+     * Hook which skips the virtual time ahead when all the tests are waiting.
+     * See Clock::runnerStep().
+     */
+    typedef void (*VirtualTimeHook)(bool isPassEnd);
+
+    /**
+     * Hook which reports the assertions made by the interrupt handlers during
+     * the loop() of a test. See IsrMonitor::drain().
+     */
+    typedef void (*DrainIsrHook)(Test& test);
+
+  #if EPOXY_DUINO
+    /**
+     * Hook which runs the tests on worker threads. See ThreadRunner::run().
+     */
+    typedef void (*RunJobsHook)(TestRunner& runner);
+
+    /**
+     * Counter of test statuses, updated by the worker threads. 32 bits,
+     * because the counts accumulate over the iterations of setRepeat().
+     */
+    typedef std::atomic<uint32_t> Counter;
+  #else
+    typedef uint32_t Counter;
+  #endif
+
     /** Default total timeout for the test runner. */
     static const TimeoutType kTimeoutDefault = 10;
 
@@ -150,6 +305,64 @@ class TestRunner {
     /** Count the number of tests. */
     static uint16_t countTests();
 
+    // The hooks are installed by the constructor of ParamTest, so that the code
+    // which handles the rows of parameterized tests is linked into the program
+    // only if it defines a testP() test.
+    static FilterRowsHook sFilterRowsHook;
+    static CountRowsHook sCountRowsHook;
+    static CountTestHook sCountTestHook;
+
+    // The hooks are installed by setRepeat(), so that the code which repeats
+    // the tests is linked into the program only if it is used.
+    static RetireTestHook sRetireTestHook;
+    static RestartRunHook sRestartRunHook;
+
+    // Installed by the constructor of IsrMonitor.
+    static DrainIsrHook sDrainIsrHook;
+
+    // Installed by enableTestTimer(), so that the Timer is linked into the
+    // program only if the duration of the tests is used.
+    static StartTimerHook sStartTimerHook;
+    static StopTimerHook sStopTimerHook;
+
+    // Installed by setVirtualTime(), so that the Clock is linked into the
+    // program only if it is used.
+    static MillisHook sMillisHook;
+    static VirtualTimeHook sVirtualTimeHook;
+
+    /** Return the millis() of the Clock if it is used, or the millis(). */
+    static unsigned long runnerMillis() {
+      return sMillisHook ? sMillisHook() : millis();
+    }
+
+  #if EPOXY_DUINO
+    // Installed by setJobs(), so that the code which starts the threads is
+    // linked into the program only if it is used.
+    static RunJobsHook sRunJobsHook;
+  #endif
+
+    /**
+     * Keep the finished test in the list of retired tests, in the given
+     * lifeCycle for the next iteration, and count its failures.
+     */
+    static void retireTest(TestRunner& runner, Test* test, uint8_t lifeCycle);
+
+    /** Put the retired tests back into the list of tests. */
+    static bool restartRun(TestRunner& runner);
+
+    /** Calibrate the Timer, and measure the duration of each test. */
+    static void enableTestTimer();
+
+    /** Start measuring the duration of the current test. */
+    static void startTestTimer(TestRunner& runner);
+
+    /**
+     * Return the duration of the current test in microseconds, or
+     * Test::kDurationUnknown if the test was interleaved with other testing()
+     * tests, which makes its duration meaningless.
+     */
+    static uint32_t stopTestTimer(TestRunner& runner);
+
     // Disable copy-constructor and assignment operator
     TestRunner(const TestRunner&) = delete;
     TestRunner& operator=(const TestRunner&) = delete;
@@ -174,11 +387,24 @@ class TestRunner {
         mIsRunning = true;
       }
 
+    #if EPOXY_DUINO
+      // Run the tests which are not serial() on the worker threads, once in
+      // each iteration of the run. The serial tests are left on the list.
+      if (sRunJobsHook && !mIsJobsDone) {
+        mIsJobsDone = true;
+        sRunJobsHook(*this);
+      }
+    #endif
+
       // If no more test cases, then print out summary of run.
       if (*Test::getRoot() == nullptr) {
+        if (!mIsResolved && sRestartRunHook && sRestartRunHook(*this)) return;
         if (!mIsResolved) {
-          mEndTime = millis();
+          mEndTime = runnerMillis();
           resolveRun();
+          for (TestListener* l = mListeners; l != nullptr; l = l->mNext) {
+            l->runFinished();
+          }
           mIsResolved = true;
         #if EPOXY_DUINO
           exit((mFailedCount || mExpiredCount) ? 1 : 0);
@@ -190,8 +416,10 @@ class TestRunner {
       // If reached the end and there are still test cases left, start from the
       // beginning again.
       if (*mCurrent == nullptr) {
+        if (sVirtualTimeHook) sVirtualTimeHook(true);
         mCurrent = Test::getRoot();
       }
+      if (sVirtualTimeHook) sVirtualTimeHook(false);
 
       // Implement a finite state machine that calls the (*mCurrent)->setup() or
       // (*mCurrent)->loop(), then changes the test case's mStatus.
@@ -199,6 +427,10 @@ class TestRunner {
         case Test::kLifeCycleNew:
           // Transfer the verbosity of the TestRunner to the Test.
           (*mCurrent)->enableVerbosity(mVerbosity);
+          for (TestListener* l = mListeners; l != nullptr; l = l->mNext) {
+            l->testStarting(**mCurrent);
+          }
+          if (sStartTimerHook) sStartTimerHook(*this);
           (*mCurrent)->setup();
 
           // Support assertXxx() statements inside the setup() method by
@@ -213,8 +445,9 @@ class TestRunner {
           // calling setup() or teardown().
           (*mCurrent)->enableVerbosity(mVerbosity);
           (*mCurrent)->setStatus(Test::kStatusSkipped);
+          mTestDuration = Test::kDurationUnknown;
           mSkippedCount++;
-          (*mCurrent)->setLifeCycle(Test::kLifeCycleFinished);
+          retireCurrent(Test::kLifeCycleExcluded);
           break;
         case Test::kLifeCycleSetup:
           {
@@ -225,11 +458,12 @@ class TestRunner {
             // basis. This would cause the testing() code to move down into a
             // new again() virtual method dispatched from Test::loop(),
             // analogous to once(). But let's keep the code here for now.
-            unsigned long now = millis();
+            unsigned long now = runnerMillis();
             if (mTimeout > 0 && now >= mStartTime + 1000L * mTimeout) {
               (*mCurrent)->expire();
             } else {
               (*mCurrent)->loop();
+              if (sDrainIsrHook) sDrainIsrHook(**mCurrent);
 
               // If test status is unresolved (i.e. still in kLifeCycleNew
               // state) after loop(), then this is a continuous testing() test
@@ -238,37 +472,29 @@ class TestRunner {
               // current test.
               if ((*mCurrent)->getLifeCycle() == Test::kLifeCycleSetup) {
                 // skip to the next one, but keep current test in the list
+                mTimedTest = nullptr;
                 mCurrent = (*mCurrent)->getNext();
               }
             }
           }
           break;
         case Test::kLifeCycleAsserted:
-          switch ((*mCurrent)->getStatus()) {
-            case Test::kStatusSkipped:
-              mSkippedCount++;
-              break;
-            case Test::kStatusPassed:
-              mPassedCount++;
-              break;
-            case Test::kStatusFailed:
-              mFailedCount++;
-              break;
-            case Test::kStatusExpired:
-              mExpiredCount++;
-              break;
-            default:
-              // should never get here
-              mStatusErrorCount++;
-              break;
-          }
           (*mCurrent)->teardown();
+          mTestDuration = sStopTimerHook
+              ? sStopTimerHook(*this)
+              : Test::kDurationUnknown;
+
+          // Notify the listeners before counting the status, so that they
+          // can fail the test.
+          for (TestListener* l = mListeners; l != nullptr; l = l->mNext) {
+            l->testFinished(**mCurrent);
+          }
+
+          countTest(**mCurrent);
           (*mCurrent)->setLifeCycle(Test::kLifeCycleFinished);
           break;
         case Test::kLifeCycleFinished:
-          (*mCurrent)->resolve();
-          // skip to the next one by taking current test out of the list
-          *mCurrent = *(*mCurrent)->getNext();
+          retireCurrent(Test::kLifeCycleNew);
           break;
       }
     }
@@ -365,11 +591,72 @@ class TestRunner {
 
     #if EPOXY_DUINO
       processCommandLine();
+      // The durations are used by TestHistory and ThreadRunner, and the size
+      // of the program does not matter on EpoxyDuino.
+      enableTestTimer();
     #endif
       mIsSetup = true;
       mCount = countTests();
+      if (sCountRowsHook) sCountRowsHook(*this);
       mCurrent = Test::getRoot();
-      mStartTime = millis();
+      mStartTime = runnerMillis();
+    }
+
+    /**
+     * Resolve the current test and take it out of the list of tests, which
+     * moves to the next one. If the run is repeated, the test is kept for the
+     * next iteration, in the given lifeCycle.
+     */
+    void retireCurrent(uint8_t lifeCycle) {
+      Test* test = *mCurrent;
+      test->resolve(mTestDuration);
+      *mCurrent = *test->getNext();
+      if (sRetireTestHook) sRetireTestHook(*this, test, lifeCycle);
+    }
+
+    /** Set the number of iterations of the run. */
+    void setRepeatCount(uint16_t count);
+
+    /** Print the number of failures of each test of a repeated run. */
+    void printRepeatSummary() const;
+
+    /** Append the listener to the list of listeners. */
+    void addTestListener(TestListener* listener) {
+      TestListener** p = &mListeners;
+      while (*p != nullptr) p = &(*p)->mNext;
+      *p = listener;
+    }
+
+    /** Count the status of a finished test, unless it counts itself. */
+    void countTest(Test& test) {
+      if (sCountTestHook && sCountTestHook(*this, test)) return;
+      countStatus(test.getStatus(), 1);
+    }
+
+    /**
+     * Add 'increment' to the counter of the given test status. The increment
+     * is negative when a ParamTest moves the count of one of its rows to
+     * another status.
+     */
+    void countStatus(uint8_t status, int increment) {
+      switch (status) {
+        case Test::kStatusSkipped:
+          mSkippedCount += increment;
+          break;
+        case Test::kStatusPassed:
+          mPassedCount += increment;
+          break;
+        case Test::kStatusFailed:
+          mFailedCount += increment;
+          break;
+        case Test::kStatusExpired:
+          mExpiredCount += increment;
+          break;
+        default:
+          // should never get here
+          mStatusErrorCount += increment;
+          break;
+      }
     }
 
     /** Enables the given verbosity. */
@@ -405,7 +692,8 @@ class TestRunner {
       kInclude,
       kExclude,
       kIncludeSub,
-      kExcludeSub
+      kExcludeSub,
+      kSerial
     };
 
     /** Process command line arguments on EpoxyDuino. */
@@ -427,21 +715,38 @@ class TestRunner {
     // simplifies the code traversing the singly-linked list significantly.
     Test** mCurrent = nullptr;
 
+    // Singly-linked list of listeners, in the order they were added.
+    TestListener* mListeners = nullptr;
+
     bool mIsResolved = false;
     bool mIsSetup = false;
     bool mIsRunning = false;
     uint8_t mVerbosity = Verbosity::kDefault;
     // True if any include(), exclude(), includesub(), excludesub() was invoked.
     bool hasBeenFiltered = false;
-    uint16_t mCount = 0;
-    uint16_t mPassedCount = 0;
-    uint16_t mFailedCount = 0;
-    uint16_t mSkippedCount = 0;
-    uint16_t mExpiredCount = 0;
-    uint16_t mStatusErrorCount = 0;
+    uint32_t mCount = 0;
+    Counter mPassedCount{0};
+    Counter mFailedCount{0};
+    Counter mSkippedCount{0};
+    Counter mExpiredCount{0};
+    Counter mStatusErrorCount{0};
     TimeoutType mTimeout = kTimeoutDefault;
     unsigned long mStartTime;
     unsigned long mEndTime;
+    // Duration of the previous iterations of a repeated run. The timeout
+    // applies to each iteration.
+    unsigned long mElapsedTime = 0;
+
+    // The test whose duration is being measured, or nullptr if the runner
+    // moved on to another test before the current one finished.
+    const Test* mTimedTest = nullptr;
+    uint32_t mTestStartTicks = 0;
+    unsigned long mTestStartMillis = 0;
+    uint32_t mTestDuration = Test::kDurationUnknown;
+  #if EPOXY_DUINO
+    // True when the worker threads have run the current iteration.
+    bool mIsJobsDone = false;
+  #endif
 };
 
 }
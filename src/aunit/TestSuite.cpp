@@ -0,0 +1,69 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Test.h"
+#include "TestRunner.h"
+#include "TestSuite.h"
+
+namespace aunit {
+
+TestSuite::TestSuite(Hook setupSuite, Hook teardownSuite):
+  mSetupSuite(setupSuite),
+  mTeardownSuite(teardownSuite) {
+  // Safe during static initialization, because the TestRunner is a function
+  // static singleton.
+  TestRunner::addListener(this);
+}
+
+bool TestSuite::isMember(const Test& test) const {
+  return test.getSuite() == this;
+}
+
+uint16_t TestSuite::countSelectedTests() const {
+  uint16_t count = 0;
+  for (Test** p = Test::getRoot(); *p != nullptr; p = (*p)->getNext()) {
+    if (isMember(**p) && (*p)->getLifeCycle() != Test::kLifeCycleExcluded) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void TestSuite::testStarting(Test& test) {
+  if (mRemaining > 0 || ! isMember(test)) return;
+
+  mRemaining = countSelectedTests();
+  mSetupSuite();
+}
+
+void TestSuite::testFinished(Test& test) {
+  if (mRemaining == 0 || ! isMember(test)) return;
+
+  mRemaining--;
+  if (mRemaining == 0) {
+    mTeardownSuite();
+  }
+}
+
+}
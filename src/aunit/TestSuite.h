@@ -0,0 +1,93 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_TEST_SUITE_H
+#define AUNIT_TEST_SUITE_H
+
+#include <stdint.h>
+#include "TestListener.h"
+
+namespace aunit {
+
+/**
+ * Calls the static setupSuite() and teardownSuite() methods of a fixture class
+ * once around all the selected tests of that fixture, instead of around each
+ * test like setup() and teardown(). Created by the suiteF() macro. The tests
+ * of the suite are the tests whose getSuite() returns it, which are the
+ * testF(), testingF(), lazyTestF() and lazyTestingF() tests of the fixture
+ * class. Other tests whose names begin with "{testClass}_", such as
+ * test(testClass, name), are not members.
+ *
+ * The setupSuite() is called just before the setup() of the first test of the
+ * suite. At that point, the number of tests of the suite which are not
+ * excluded is counted, and the teardownSuite() is called just after the
+ * teardown() of the last of them. If all tests of the suite are excluded,
+ * neither method is called.
+ *
+ * A TestSuite is a TestListener which registers itself with the TestRunner
+ * during static initialization.
+ */
+class TestSuite: public TestListener {
+  public:
+    /** Signature of the setupSuite() and teardownSuite() methods. */
+    typedef void (*Hook)();
+
+    /** Constructor. */
+    TestSuite(Hook setupSuite, Hook teardownSuite);
+
+    /** Return true if the setupSuite() was called but not teardownSuite(). */
+    bool isActive() const { return mRemaining > 0; }
+
+    void testStarting(Test& test) override;
+    void testFinished(Test& test) override;
+
+  private:
+    // Disable copy-constructor and assignment operator
+    TestSuite(const TestSuite&) = delete;
+    TestSuite& operator=(const TestSuite&) = delete;
+
+    /** Return true if the test belongs to this suite. */
+    bool isMember(const Test& test) const;
+
+    /** Count the tests of this suite which are not excluded. */
+    uint16_t countSelectedTests() const;
+
+    Hook const mSetupSuite;
+    Hook const mTeardownSuite;
+    uint16_t mRemaining = 0;
+};
+
+/**
+ * Return the suite of the fixture class T, which is nullptr unless suiteF(T)
+ * defines a non-template overload for exactly that class. The overload is
+ * found by argument-dependent lookup when the fixture is in another
+ * namespace, and is not selected for subclasses of T, because the template
+ * matches them exactly.
+ */
+template <typename T>
+const TestSuite* aunitFixtureSuite(const T*) { return nullptr; }
+
+}
+
+#endif
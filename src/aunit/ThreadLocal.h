@@ -0,0 +1,41 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_THREAD_LOCAL_H
+#define AUNIT_THREAD_LOCAL_H
+
+/**
+ * Storage class of the static variables which hold the state of the running
+ * test. On EpoxyDuino, the tests may run on several threads (see
+ * TestRunner::setJobs()), so each thread gets its own copy. Microcontrollers
+ * run the tests on a single thread, and thread_local is often not supported,
+ * so it expands to nothing.
+ */
+#if EPOXY_DUINO
+  #define AUNIT_THREAD_LOCAL thread_local
+#else
+  #define AUNIT_THREAD_LOCAL
+#endif
+
+#endif
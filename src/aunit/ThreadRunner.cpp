@@ -0,0 +1,260 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#if EPOXY_DUINO
+
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <Arduino.h> // Print, millis()
+#include "Printer.h"
+#include "Verbosity.h"
+#include "Test.h"
+#include "Timer.h"
+#include "TestRunner.h"
+#include "LinePrint.h"
+#include "ThreadRunner.h"
+
+namespace aunit {
+
+namespace {
+
+// Serializes the listeners and the list of tests.
+std::mutex sMutex;
+
+/**
+ * The printer of a worker thread, which buffers the output of the current
+ * test. Each line is prefixed with the Verbosity flag of its message (see
+ * Printer::setMessageVerbosity()), so that a TeePrint can still select the
+ * lines when they are written out.
+ */
+class BufferedPrint: public Print {
+  public:
+    size_t write(uint8_t c) override {
+      if (mIsLineStart) {
+        mBuffer += (char) Printer::getMessageVerbosity();
+        mIsLineStart = false;
+      }
+      mBuffer += (char) c;
+      if (c == '\n') {
+        mIsLineStart = true;
+        Printer::setMessageVerbosity(Verbosity::kNone);
+      }
+      return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+      if (buffer == nullptr) return 0;
+      for (size_t i = 0; i < size; i++) {
+        write(buffer[i]);
+      }
+      return size;
+    }
+
+    /** Write the buffered lines to the printer, then clear the buffer. */
+    void writeTo(Print* printer) {
+      size_t i = 0;
+      while (i < mBuffer.size()) {
+        Printer::setMessageVerbosity((uint8_t) mBuffer[i++]);
+        size_t end = mBuffer.find('\n', i);
+        end = (end == std::string::npos) ? mBuffer.size() : end + 1;
+        printer->write((const uint8_t*) mBuffer.data() + i, end - i);
+        i = end;
+      }
+      Printer::setMessageVerbosity(Verbosity::kNone);
+      mBuffer.clear();
+      mIsLineStart = true;
+    }
+
+  private:
+    std::string mBuffer;
+    bool mIsLineStart = true;
+};
+
+// Same as TestRunner::stopTestTimer(), for a test which runs on its own
+// thread, so its duration is always known.
+uint32_t elapsedMicros(uint32_t startTicks, unsigned long startMillis) {
+  uint32_t elapsedTicks = Timer::ticks() - startTicks;
+  unsigned long elapsedMillis = millis() - startMillis;
+  if (elapsedMillis < Timer::kMaxTickMillis) {
+    uint32_t overhead = Timer::overhead();
+    elapsedTicks = (elapsedTicks > overhead) ? elapsedTicks - overhead : 0;
+    return Timer::toMicros(elapsedTicks);
+  } else {
+    return elapsedMillis * 1000;
+  }
+}
+
+}
+
+uint8_t ThreadRunner::sJobs = 1;
+uint8_t ThreadRunner::sNumSerialPatterns = 0;
+bool ThreadRunner::sIsAllSerial = false;
+char ThreadRunner::sSerialPatterns[kMaxSerialPatterns][kMaxPatternLength];
+
+void ThreadRunner::setJobs(uint8_t jobs) {
+  if (jobs == 0) {
+    unsigned cpus = std::thread::hardware_concurrency();
+    jobs = (cpus == 0) ? 1 : (cpus > kMaxJobs) ? kMaxJobs : cpus;
+  }
+  sJobs = (jobs > kMaxJobs) ? kMaxJobs : jobs;
+}
+
+void ThreadRunner::addSerial(const char* pattern) {
+  if (sNumSerialPatterns >= kMaxSerialPatterns
+      || strlen(pattern) >= kMaxPatternLength) {
+    // Running a test on the main thread is always safe.
+    sIsAllSerial = true;
+    return;
+  }
+  strcpy(sSerialPatterns[sNumSerialPatterns++], pattern);
+}
+
+bool ThreadRunner::isSerial(const Test& test) {
+  if (sIsAllSerial) return true;
+
+  for (uint8_t i = 0; i < sNumSerialPatterns; i++) {
+    // Same matching rule as TestRunner::include().
+    const char* pattern = sSerialPatterns[i];
+    size_t length = strlen(pattern);
+    if (length > 0 && pattern[length - 1] == '*') {
+      length--;
+    } else {
+      length++;
+    }
+    if (test.getName().compareToN(pattern, length) == 0) return true;
+  }
+  return false;
+}
+
+void ThreadRunner::run(TestRunner& runner) {
+  // An IsrMonitor attributes its records to the test which is running, which
+  // is ambiguous when several tests run at the same time, so all the tests
+  // stay on the main thread.
+  if (TestRunner::sDrainIsrHook) return;
+
+  // The virtual time skips ahead only between the steps of the TestRunner
+  // loop on the main thread, and its state is not shared between threads.
+  if (TestRunner::sVirtualTimeHook) return;
+
+  std::vector<Test*> tests;
+  for (Test** p = Test::getRoot(); *p != nullptr; p = (*p)->getNext()) {
+    if ((*p)->getLifeCycle() == Test::kLifeCycleNew && !isSerial(**p)) {
+      tests.push_back(*p);
+    }
+  }
+  if (tests.empty()) return;
+
+  // The printer of the main thread, shared by the workers.
+  Print* printer = Printer::getPrinter();
+  std::atomic<size_t> next(0);
+  auto worker = [&runner, &tests, &next, printer]() {
+    BufferedPrint buffer;
+    Printer::setThreadPrinter(&buffer);
+    size_t i;
+    while ((i = next++) < tests.size()) {
+      runTest(runner, tests[i]);
+      std::lock_guard<std::mutex> lock(internal::LinePrint::getMutex());
+      buffer.writeTo(printer);
+    }
+    Printer::setThreadPrinter(nullptr);
+  };
+
+  size_t numThreads = (sJobs < tests.size()) ? sJobs : tests.size();
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < numThreads; i++) {
+    threads.emplace_back(worker);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  runner.mCurrent = Test::getRoot();
+}
+
+void ThreadRunner::runTest(TestRunner& runner, Test* test) {
+  {
+    std::lock_guard<std::mutex> lock(sMutex);
+    test->enableVerbosity(runner.mVerbosity);
+    for (TestListener* l = runner.mListeners; l != nullptr; l = l->mNext) {
+      l->testStarting(*test);
+    }
+  }
+
+  uint32_t startTicks = Timer::ticks();
+  unsigned long startMillis = millis();
+  test->setup();
+  if (test->getLifeCycle() == Test::kLifeCycleNew) {
+    test->setLifeCycle(Test::kLifeCycleSetup);
+  }
+
+  // Same as the kLifeCycleSetup state of TestRunner::runTest(), except that
+  // a testing() test keeps the thread until it is resolved.
+  while (test->getLifeCycle() == Test::kLifeCycleSetup) {
+    unsigned long now = millis();
+    if (runner.mTimeout > 0
+        && now >= runner.mStartTime + 1000L * runner.mTimeout) {
+      test->expire();
+    } else {
+      test->loop();
+      if (test->getLifeCycle() == Test::kLifeCycleSetup) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  test->teardown();
+  finishTest(runner, test, elapsedMicros(startTicks, startMillis));
+}
+
+void ThreadRunner::finishTest(TestRunner& runner, Test* test,
+    uint32_t durationMicros) {
+  std::lock_guard<std::mutex> lock(sMutex);
+  // Same as the kLifeCycleAsserted state of TestRunner::runTest(), so that
+  // the listeners (e.g. TestHistory) see the duration of this test.
+  runner.mTestDuration = durationMicros;
+  for (TestListener* l = runner.mListeners; l != nullptr; l = l->mNext) {
+    l->testFinished(*test);
+  }
+  runner.countTest(*test);
+  test->resolve(durationMicros);
+
+  // Same as TestRunner::retireCurrent(), for a test anywhere in the list.
+  for (Test** p = Test::getRoot(); *p != nullptr; p = (*p)->getNext()) {
+    if (*p == test) {
+      *p = *test->getNext();
+      break;
+    }
+  }
+  if (TestRunner::sRetireTestHook) {
+    TestRunner::sRetireTestHook(runner, test, Test::kLifeCycleNew);
+  }
+}
+
+}
+
+#endif
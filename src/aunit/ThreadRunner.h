@@ -0,0 +1,112 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_THREAD_RUNNER_H
+#define AUNIT_THREAD_RUNNER_H
+
+#include <stdint.h>
+
+namespace aunit {
+
+#if EPOXY_DUINO
+
+class Test;
+class TestRunner;
+
+/**
+ * Runs the tests on a pool of worker threads on EpoxyDuino, instead of one
+ * after the other on the main thread. It is enabled by TestRunner::setJobs()
+ * or the `--jobs N` command line flag.
+ *
+ * Each worker takes the next test from a shared atomic index over the tests
+ * (in the order of the TestRunner, so `--order history` still runs the failed
+ * tests first), and runs it to completion, including the testing() tests. The
+ * output printed through the Printer by a test is buffered by its thread, and
+ * written to the real printer in one piece after the test finishes, along with
+ * the status of the test, so that the lines of different tests are never
+ * interleaved. The TestListeners are notified while holding a lock, and the
+ * counters of the TestRunner are atomic.
+ *
+ * The tests which touch global state can be kept on the main thread with
+ * TestRunner::serial() or the `--serial pattern,...` flag. They run after the
+ * worker threads have finished, in the usual way. The following should
+ * normally be serial: tests which depend on each other, benchmarks (which
+ * measure a loaded machine), and tests which use a StackMonitor, HeapMonitor
+ * or LogCapture (which observe the whole process, or the main thread only).
+ * If an IsrMonitor is created, or if TestRunner::setVirtualTime() is enabled,
+ * all the tests run on the main thread.
+ */
+class ThreadRunner {
+  public:
+    /** Maximum number of worker threads. */
+    static const uint8_t kMaxJobs = 64;
+
+    /** Maximum number of serial() patterns. */
+    static const uint8_t kMaxSerialPatterns = 8;
+
+    /**
+     * Set the number of worker threads. A value of 0 uses the number of CPUs.
+     */
+    static void setJobs(uint8_t jobs);
+
+    /** Return the number of worker threads. */
+    static uint8_t getJobs() { return sJobs; }
+
+    /**
+     * Add a pattern of the tests which run on the main thread. If there are
+     * too many patterns, all tests run on the main thread.
+     */
+    static void addSerial(const char* pattern);
+
+    /** Return true if the test must run on the main thread. */
+    static bool isSerial(const Test& test);
+
+    /**
+     * Run the tests which are not serial on the worker threads, and remove
+     * them from the list of tests. Installed as a hook of the TestRunner.
+     */
+    static void run(TestRunner& runner);
+
+  private:
+    /** Maximum length of a pattern, including the NUL. */
+    static const uint8_t kMaxPatternLength = 63 + 1;
+
+    /** Run the given test to completion on the current thread. */
+    static void runTest(TestRunner& runner, Test* test);
+
+    /** Notify the listeners and resolve the test, while holding the lock. */
+    static void finishTest(TestRunner& runner, Test* test,
+        uint32_t durationMicros);
+
+    static uint8_t sJobs;
+    static uint8_t sNumSerialPatterns;
+    static bool sIsAllSerial;
+    static char sSerialPatterns[kMaxSerialPatterns][kMaxPatternLength];
+};
+
+#endif
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Timer.h"
+
+namespace aunit {
+
+uint32_t Timer::sOverhead = 0;
+bool Timer::sIsCalibrated = false;
+
+#if AUNIT_TIMER_DWT
+
+// Registers of the Data Watchpoint and Trace unit, from the ARMv7-M
+// Architecture Reference Manual. Avoids a dependency on the CMSIS headers,
+// which are not consistently available across the various Arduino cores.
+static volatile uint32_t* const kDemcr = (volatile uint32_t*) 0xE000EDFC;
+static volatile uint32_t* const kDwtControl = (volatile uint32_t*) 0xE0001000;
+static volatile uint32_t* const kDwtLockAccess =
+    (volatile uint32_t*) 0xE0001FB0;
+volatile uint32_t* const Timer::kDwtCycleCount =
+    (volatile uint32_t*) 0xE0001004;
+
+static void startCycleCounter() {
+  *kDemcr |= 0x01000000; // TRCENA
+  *kDwtLockAccess = 0xC5ACCE55; // unlock, required on the Cortex-M7
+  *kDwtControl |= 0x1; // CYCCNTENA
+}
+
+#endif
+
+void Timer::calibrate() {
+#if AUNIT_TIMER_DWT
+  startCycleCounter();
+#endif
+
+  // Use the minimum, because the larger values are caused by interrupts or
+  // context switches, not by the timer itself.
+  const uint8_t kNumCalibrations = 16;
+  uint32_t overhead = UINT32_MAX;
+  for (uint8_t i = 0; i < kNumCalibrations; i++) {
+    uint32_t start = ticks();
+    uint32_t elapsed = ticks() - start;
+    if (elapsed < overhead) overhead = elapsed;
+  }
+  sOverhead = overhead;
+  sIsCalibrated = true;
+}
+
+}
@@ -0,0 +1,138 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_TIMER_H
+#define AUNIT_TIMER_H
+
+#include <stdint.h>
+#if EPOXY_DUINO
+  #include <time.h> // clock_gettime()
+#endif
+#include <Arduino.h> // micros()
+
+// The DWT cycle counter is available on ARM Cortex-M3, M4, M7 and M33, but not
+// on the Cortex-M0 and M0+ (e.g. SAMD21).
+#if ! EPOXY_DUINO && (defined(__ARM_ARCH_7M__) \
+    || defined(__ARM_ARCH_7EM__) \
+    || defined(__ARM_ARCH_8M_MAIN__))
+  #define AUNIT_TIMER_DWT 1
+#else
+  #define AUNIT_TIMER_DWT 0
+#endif
+
+namespace aunit {
+
+/**
+ * A high resolution timer used by the Benchmark class and the per-test timing
+ * of the TestRunner. The resolution depends on the platform:
+ *
+ *  - EpoxyDuino: clock_gettime(CLOCK_MONOTONIC_RAW), 1 tick = 1 nanosecond
+ *  - ARM Cortex-M3/M4/M7: DWT cycle counter, 1 tick = 1 CPU cycle
+ *  - all others: micros(), 1 tick = 1 microsecond
+ *
+ * The ticks are 32-bit unsigned integers which eventually roll over (after
+ * 4.29 seconds on EpoxyDuino, after 35 seconds on a 120 MHz Cortex-M4), so the
+ * difference between 2 calls to ticks() should be used only for short
+ * intervals. The callers fall back to millis() for the intervals longer than
+ * kMaxTickMillis. The overhead of calling ticks() is measured by calibrate() so
+ * that it can be subtracted from very short measurements.
+ */
+class Timer {
+  public:
+    /**
+     * Longest interval, in milliseconds, which is measured using the ticks.
+     * It is well below the roll over period of the ticks on every platform.
+     */
+    static const uint16_t kMaxTickMillis = 1000;
+
+    /** Return the current value of the tick counter. */
+    static uint32_t ticks() {
+    #if EPOXY_DUINO
+      struct timespec ts;
+      #if defined(CLOCK_MONOTONIC_RAW)
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+      #else
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+      #endif
+      return (uint32_t) ts.tv_sec * 1000000000UL + (uint32_t) ts.tv_nsec;
+    #elif AUNIT_TIMER_DWT
+      return *kDwtCycleCount;
+    #else
+      return micros();
+    #endif
+    }
+
+    /**
+     * Convert the given number of ticks into nanoseconds. The result
+     * saturates at UINT32_MAX (4.29 seconds) instead of overflowing.
+     */
+    static uint32_t toNanos(uint32_t ticks) {
+    #if EPOXY_DUINO
+      return ticks;
+    #elif AUNIT_TIMER_DWT
+      uint64_t nanos = (uint64_t) ticks * 1000000000UL / F_CPU;
+      return (nanos > UINT32_MAX) ? UINT32_MAX : (uint32_t) nanos;
+    #else
+      return (ticks > UINT32_MAX / 1000) ? UINT32_MAX : ticks * 1000UL;
+    #endif
+    }
+
+    /** Convert the given number of ticks into microseconds. */
+    static uint32_t toMicros(uint32_t ticks) {
+    #if EPOXY_DUINO
+      return ticks / 1000;
+    #elif AUNIT_TIMER_DWT
+      return ticks / (F_CPU / 1000000UL);
+    #else
+      return ticks;
+    #endif
+    }
+
+    /**
+     * Start the tick counter if necessary, and measure the overhead of 2
+     * consecutive calls to ticks(). Called automatically by the Benchmark,
+     * and by the TestRunner when it measures the duration of the tests, so it
+     * is normally not necessary to call this directly. Calling it again
+     * performs a new calibration.
+     */
+    static void calibrate();
+
+    /** Return true if calibrate() has been called. */
+    static bool isCalibrated() { return sIsCalibrated; }
+
+    /** Return the overhead of a call to ticks(), in ticks. */
+    static uint32_t overhead() { return sOverhead; }
+
+  private:
+  #if AUNIT_TIMER_DWT
+    static volatile uint32_t* const kDwtCycleCount;
+  #endif
+
+    static uint32_t sOverhead;
+    static bool sIsCalibrated;
+};
+
+}
+
+#endif
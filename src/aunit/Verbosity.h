@@ -57,6 +57,12 @@ class Verbosity {
     /** Print TestRunner summary message. */
     static const uint8_t kTestRunSummary = 0x40;
 
+    /**
+     * Append the duration of the test to the test status message. It is not
+     * included in kAll, and must be enabled explicitly.
+     */
+    static const uint8_t kTestDuration = 0x80;
+
     // compound flags
     /** Print all assertXxx() messages. */
     static const uint8_t kAssertionAll = (kAssertionPassed | kAssertionFailed);
@@ -70,7 +76,7 @@ class Verbosity {
         (kAssertionFailed | kTestAll | kTestRunSummary);
 
     /** Print all messages. */
-    static const uint8_t kAll = 0xFF;
+    static const uint8_t kAll = (kAssertionAll | kTestAll | kTestRunSummary);
 
     /** Print no messages. */
     static const uint8_t kNone = 0x00;
@@ -0,0 +1,103 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_CAPTURE_PRINT_H
+#define AUNIT_CAPTURE_PRINT_H
+
+#include <stddef.h> // size_t
+#include <Print.h>
+#include "../Printer.h"
+
+namespace aunit {
+namespace fake {
+
+/**
+ * An implementation of Print which replaces the printer of AUnit while it is
+ * capturing, and keeps the messages printed in the meantime, so that the
+ * messages of the assertions of a test can be verified. The test under
+ * verification is normally an instance of a TestOnce subclass which is not
+ * registered with the TestRunner, whose once() method is called directly.
+ *
+ * Usage:
+ * @verbatim
+ * test(MessageTest, failed) {
+ *   DummyTest dummy;
+ *   CapturePrint output;
+ *   dummy.once();
+ *   output.release();
+ *   assertTrue(strstr(output.getBuffer(), "Assertion failed") != nullptr);
+ * }
+ * @endverbatim
+ *
+ * The printer must be released before making the assertions of the test
+ * itself, otherwise their messages are captured too. The destructor releases
+ * it if needed. The output beyond the size of the buffer is discarded.
+ */
+class CapturePrint: public Print {
+  public:
+    /** Size of the internal buffer, including the terminating NUL. */
+    static const uint16_t kBufSize = 256;
+
+    /** Replace the printer of AUnit with this object. */
+    CapturePrint():
+        mPrinter(Printer::getPrinter()) {
+      Printer::setPrinter(this);
+    }
+
+    ~CapturePrint() { release(); }
+
+    size_t write(uint8_t c) override {
+      if (mIndex < kBufSize - 1) {
+        mBuf[mIndex++] = c;
+        mBuf[mIndex] = '\0';
+      }
+      return 1;
+    }
+
+    /** Restore the printer which was replaced by the constructor. */
+    void release() {
+      if (mIsCapturing) {
+        Printer::setPrinter(mPrinter);
+        mIsCapturing = false;
+      }
+    }
+
+    /** Return the NUL terminated output captured so far. */
+    const char* getBuffer() const { return mBuf; }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    CapturePrint(const CapturePrint&) = delete;
+    CapturePrint& operator=(const CapturePrint&) = delete;
+
+    Print* const mPrinter;
+    bool mIsCapturing = true;
+    uint16_t mIndex = 0;
+    char mBuf[kBufSize] = "";
+};
+
+}
+}
+
+#endif
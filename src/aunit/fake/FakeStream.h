@@ -0,0 +1,219 @@
+/*
+MIT License
+
+Copyright (c) 2018 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef AUNIT_FAKE_STREAM_H
+#define AUNIT_FAKE_STREAM_H
+
+#include <stddef.h> // size_t
+#include <stdint.h>
+#include <string.h> // strlen()
+#include <Arduino.h> // Stream, micros(), pgm_read_byte(), strlen_P()
+#include "../Clock.h"
+
+namespace aunit {
+namespace fake {
+
+/**
+ * An implementation of Stream whose input is a script in RAM or in PROGMEM,
+ * for example a recording of the traffic of a GPS, a Modbus device, or a
+ * modem, so that a parser can be tested without a real UART.
+ *
+ * Usage:
+ * @verbatim
+ * test(NmeaTest, parse) {
+ *   FakeStream stream(F("$GPGGA,...*47\r\n$GPRMC,...*6A\r\n"));
+ *   while (stream.available()) {
+ *     parser.process(stream.read());
+ *   }
+ *   assertEqual(2, parser.getNumSentences());
+ * }
+ * @endverbatim
+ *
+ * By default, the whole script is available at once. The setBaudRate() or
+ * setByteInterval() methods make each byte arrive some time after the
+ * previous one, as measured by the aunit::Clock, starting from the first call
+ * to available(), read() or peek(). When no byte has arrived yet, available()
+ * tells the Clock that the test waits for the next one, so that a testing()
+ * test using the virtual time (see TestRunner::setVirtualTime()) receives the
+ * bytes at the speed of the CPU.
+ *
+ * The script can be replayed several times using setRepeat(), to feed
+ * megabytes of traffic from a short recording. The bytes written to the
+ * stream are sent to the Print given by setOutput(), if any. The throughput
+ * of the code which reads the stream is returned by getBytesPerSecond(),
+ * measured in real time between the first and the last read().
+ */
+class FakeStream: public Stream {
+  public:
+    /** Constructor for a script in RAM, which may contain NUL bytes. */
+    FakeStream(const char* script, size_t size):
+        mScript(script),
+        mSize(size),
+        mIsFlash(false) {}
+
+    /** Constructor for a NUL terminated script in RAM. */
+    explicit FakeStream(const char* script):
+        FakeStream(script, strlen(script)) {}
+
+    /** Constructor for a script in PROGMEM, which may contain NUL bytes. */
+    FakeStream(const __FlashStringHelper* script, size_t size):
+        mScript((const char*) script),
+        mSize(size),
+        mIsFlash(true) {}
+
+    /** Constructor for a NUL terminated script in PROGMEM. */
+    explicit FakeStream(const __FlashStringHelper* script):
+        FakeStream(script, strlen_P((const char*) script)) {}
+
+    /** Replay the script 'count' times. The default is 1. */
+    void setRepeat(uint32_t count) { mRepeat = count; }
+
+    /**
+     * Make the bytes arrive at the speed of a UART using 'baud' with 10 bits
+     * per byte (8N1). A value of 0 makes the whole script available at once.
+     */
+    void setBaudRate(uint32_t baud) {
+      mByteMicros = (baud == 0) ? 0 : (10000000UL + baud / 2) / baud;
+    }
+
+    /** Make each byte arrive 'micros' after the previous one. */
+    void setByteInterval(uint32_t micros) { mByteMicros = micros; }
+
+    /** Send the bytes written to the stream to 'output'. */
+    void setOutput(Print* output) { mOutput = output; }
+
+    /** Start again from the beginning of the script. */
+    void rewind() {
+      mPosition = 0;
+      mIsStarted = false;
+      mFirstReadMicros = 0;
+      mLastReadMicros = 0;
+    }
+
+    int available() override {
+      uint32_t numArrived = getNumArrived();
+      uint32_t n = numArrived - mPosition;
+      if (n == 0 && mPosition < getTotalSize()) {
+        // Handles the rollover of micros().
+        uint32_t next = (numArrived + 1) * mByteMicros;
+        uint32_t remaining = next - (Clock::micros() - mStartMicros);
+        Clock::idleUntil(Clock::millis() + (remaining + 999) / 1000);
+      }
+      return (n > 0x7FFF) ? 0x7FFF : (int) n;
+    }
+
+    int read() override {
+      int c = peek();
+      if (c < 0) return c;
+
+      unsigned long now = micros();
+      if (mPosition == 0) mFirstReadMicros = now;
+      mLastReadMicros = now;
+      mPosition++;
+      return c;
+    }
+
+    int peek() override {
+      if (mPosition >= getNumArrived()) return -1;
+      size_t i = mPosition % mSize;
+      return (uint8_t) (mIsFlash ? pgm_read_byte(mScript + i) : mScript[i]);
+    }
+
+    size_t write(uint8_t c) override {
+      mNumWritten++;
+      return mOutput ? mOutput->write(c) : 1;
+    }
+
+    /** Return the number of bytes of the script read so far. */
+    uint32_t getNumRead() const { return mPosition; }
+
+    /** Return the number of bytes written to the stream. */
+    uint32_t getNumWritten() const { return mNumWritten; }
+
+    /** Return true if every byte of the script has been read. */
+    bool isDone() const { return mPosition >= getTotalSize(); }
+
+    /**
+     * Return the number of bytes read per second, between the first and the
+     * last read(). Returns 0 if fewer than 2 bytes were read. Saturates at
+     * UINT32_MAX.
+     */
+    uint32_t getBytesPerSecond() const {
+      if (mPosition < 2) return 0;
+      unsigned long elapsed = mLastReadMicros - mFirstReadMicros;
+      if (elapsed == 0) elapsed = 1;
+      uint64_t rate = (uint64_t) (mPosition - 1) * 1000000UL / elapsed;
+      return (rate > UINT32_MAX) ? UINT32_MAX : (uint32_t) rate;
+    }
+
+    /**
+     * Print the throughput, e.g. "FakeStream: 1048576 bytes read at
+     * 2004950 bytes/s."
+     */
+    void printThroughput(Print* printer) const {
+      printer->print(F("FakeStream: "));
+      printer->print((unsigned long) mPosition);
+      printer->print(F(" bytes read at "));
+      printer->print((unsigned long) getBytesPerSecond());
+      printer->println(F(" bytes/s."));
+    }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    FakeStream(const FakeStream&) = delete;
+    FakeStream& operator=(const FakeStream&) = delete;
+
+    uint32_t getTotalSize() const { return mSize * mRepeat; }
+
+    /** Return the number of bytes which have arrived so far. */
+    uint32_t getNumArrived() {
+      uint32_t total = getTotalSize();
+      if (mByteMicros == 0) return total;
+
+      if (!mIsStarted) {
+        mStartMicros = Clock::micros();
+        mIsStarted = true;
+      }
+      uint32_t n = (Clock::micros() - mStartMicros) / mByteMicros;
+      return (n < total) ? n : total;
+    }
+
+    const char* const mScript;
+    size_t const mSize;
+    bool const mIsFlash;
+    bool mIsStarted = false;
+    uint32_t mRepeat = 1;
+    uint32_t mByteMicros = 0;
+    uint32_t mPosition = 0;
+    uint32_t mNumWritten = 0;
+    unsigned long mStartMicros = 0;
+    unsigned long mFirstReadMicros = 0;
+    unsigned long mLastReadMicros = 0;
+    Print* mOutput = nullptr;
+};
+
+}
+}
+
+#endif
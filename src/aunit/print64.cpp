@@ -1,4 +1,7 @@
+#include <stdint.h>
+#include <Arduino.h> // PROGMEM
 #include <Print.h>
+#include "Flash.h"
 #include "print64.h"
 
 // Copied and modified from Arduino AVR Core Print.cpp file.
@@ -6,11 +9,109 @@
 namespace aunit {
 namespace internal {
 
+namespace {
+
+// The 2 digits of each number from 0 to 99, so that a decimal number needs
+// only one division by 100 for every 2 digits.
+const char kDigitPairs[] PROGMEM =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+const char kHexDigits[] PROGMEM = "0123456789ABCDEF";
+
+const uint32_t kBillion = 1000000000UL;
+
+// Write the 2 digits of 'n' < 100 just before 'str'.
+char* formatPair(char* str, uint8_t n) {
+  *--str = pgm_read_byte(&kDigitPairs[2 * n + 1]);
+  *--str = pgm_read_byte(&kDigitPairs[2 * n]);
+  return str;
+}
+
+// Write the decimal digits of 'n' just before 'str', padded with '0' to at
+// least 'width' digits, and return the first digit. Uses 32-bit divisions
+// while 'n' does not fit in 16 bits, then 16-bit divisions, which are much
+// faster than the 64-bit divisions on 8-bit processors.
+char* formatDecimal32(char* str, uint32_t n, uint8_t width) {
+  char* end = str;
+  while (n >= 0x10000) {
+    uint32_t q = n / 100;
+    str = formatPair(str, n - q * 100);
+    n = q;
+  }
+  uint16_t m = n;
+  while (m >= 100) {
+    uint16_t q = m / 100;
+    str = formatPair(str, m - q * 100);
+    m = q;
+  }
+  if (m >= 10) {
+    str = formatPair(str, m);
+  } else {
+    *--str = '0' + m;
+  }
+  while (end - str < width) *--str = '0';
+  return str;
+}
+
+// Split 'n' into chunks of 9 decimal digits, using at most 2 divisions of the
+// 64-bit number, then convert each chunk with 32-bit arithmetic.
+size_t printDecimal64(Print& printer, unsigned long long n) {
+  char buf[20 + 1];
+  char* str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+
+  unsigned long long high = n / kBillion;
+  str = formatDecimal32(str, (uint32_t) (n - high * kBillion), 9);
+  if (high >= kBillion) {
+    uint32_t top = high / kBillion;
+    str = formatDecimal32(str, (uint32_t) (high - top * kBillion), 9);
+    str = formatDecimal32(str, top, 0);
+  } else {
+    str = formatDecimal32(str, (uint32_t) high, 0);
+  }
+  return printer.write(str);
+}
+
+// Convert each 32-bit half using shifts, without any division.
+size_t printHex64(Print& printer, unsigned long long n) {
+  char buf[16 + 1];
+  char* str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+
+  uint32_t low = n;
+  uint32_t high = n >> 32;
+  for (uint8_t i = 0; i < 8; i++) {
+    *--str = pgm_read_byte(&kHexDigits[low & 0xF]);
+    low >>= 4;
+  }
+  do {
+    *--str = pgm_read_byte(&kHexDigits[high & 0xF]);
+    high >>= 4;
+  } while (high);
+  return printer.write(str);
+}
+
+}
+
 size_t printNumber64(Print& printer, unsigned long long n, int base) {
   if ((n & 0xFFFFFFFF00000000) == 0) {
     return printer.print((unsigned long) n, base);
   }
 
+  // Fast paths for the common bases, which avoid a slow 64-bit division per
+  // digit on 8-bit processors.
+  if (base == 10) return printDecimal64(printer, n);
+  if (base == 16) return printHex64(printer, n);
+
   char buf[8 * sizeof(unsigned long long) + 1];
   char *str = &buf[sizeof(buf) - 1];
 
@@ -43,7 +144,8 @@ size_t print64(Print& printer, long long n, int base) {
   if (base == 10) {
     if (n < 0) {
       size_t t = printer.write('-');
-      return printNumber64(printer, -n, base) + t;
+      // Negate as unsigned, which is well defined for LLONG_MIN.
+      return printNumber64(printer, -(unsigned long long) n, base) + t;
     } else {
       return printNumber64(printer, n, base);
     }
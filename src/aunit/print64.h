@@ -36,8 +36,9 @@ SOFTWARE.
  *
  * The division and mod operations for 'long long' types are CPU intensive and
  * consume significant amounts of flash memory (100s of bytes?) on an 8-bit
- * processors. I assume that these methods will not be used very often on 8-bit
- * processors.
+ * processors. Base 10 and base 16 therefore use at most 2 divisions of the
+ * 64-bit number, then convert 32-bit chunks, using a table of digit pairs for
+ * base 10. Other bases use one 64-bit division per digit.
  */
 
 class Print;
@@ -23,6 +23,7 @@ SOFTWARE.
 */
 
 #include <string.h> // strlen()
+#include <Arduino.h> // Print, HEX
 #include "string_util.h"
 
 namespace aunit {
@@ -46,5 +47,31 @@ bool string_join(char* dst, uint8_t n, char delim, const char* a,
   return true;
 }
 
+uint8_t printEscaped(Print* printer, char c) {
+  if (c == '\n') {
+    printer->print("\\n");
+    return 2;
+  } else if (c == '\r') {
+    printer->print("\\r");
+    return 2;
+  } else if (c == '\t') {
+    printer->print("\\t");
+    return 2;
+  } else if (c == '"' || c == '\\') {
+    printer->print('\\');
+    printer->print(c);
+    return 2;
+  } else if ((uint8_t) c < ' ' || (uint8_t) c >= 0x7F) {
+    uint8_t b = c;
+    printer->print("\\x");
+    if (b < 0x10) printer->print('0');
+    printer->print(b, HEX);
+    return 4;
+  } else {
+    printer->print(c);
+    return 1;
+  }
+}
+
 }
 }
@@ -27,6 +27,8 @@ SOFTWARE.
 
 #include <stdint.h> //uint8_t
 
+class Print;
+
 namespace aunit {
 namespace internal {
 
@@ -38,6 +40,13 @@ namespace internal {
 bool string_join(char* dst, uint8_t n, char delim, const char* a,
     const char* b);
 
+/**
+ * Print the character so that the control characters are visible, e.g. "\n"
+ * or "\x01". The double quote and the backslash are also escaped. Returns the
+ * number of characters printed.
+ */
+uint8_t printEscaped(Print* printer, char c);
+
 }
 }
 
@@ -0,0 +1,243 @@
+#line 2 "ArrayNearTest.ino"
+
+#include <math.h>
+#include <string.h>
+#include <AUnit.h>
+#include <aunit/fake/CapturePrint.h>
+
+using namespace aunit;
+using aunit::fake::CapturePrint;
+using aunit::internal::ArrayNearMode;
+using aunit::internal::ArrayNearResult;
+using aunit::internal::compareArrayNear;
+
+// A test which is not registered with the TestRunner, used to capture the
+// message of an assertion. Its verbosity is not set by the TestRunner.
+class ArrayNearDummyTest: public TestOnce {
+  public:
+    ArrayNearDummyTest(const float* lhs, const float* rhs, size_t n,
+        float tolerance, uint8_t mode):
+        mLhs(lhs),
+        mRhs(rhs),
+        mN(n),
+        mTolerance(tolerance),
+        mMode(mode) {
+      enableVerbosity(Verbosity::kAssertionAll);
+    }
+
+    void once() override {
+      assertArrayNearInternal(mLhs, mRhs, mN, mTolerance, mMode);
+    }
+
+  private:
+    const float* const mLhs;
+    const float* const mRhs;
+    size_t const mN;
+    float const mTolerance;
+    uint8_t const mMode;
+};
+
+// Return the next representable float after the positive 'x'.
+float nextUp(float x) {
+  uint32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  bits++;
+  memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+test(ArrayNearTest, absolute) {
+  float a[] = {1.0, 2.0, 3.0, -4.0};
+  float b[] = {1.0, 2.001, 2.998, -4.0};
+  ArrayNearResult result;
+
+  compareArrayNear(a, b, 4, 0.01, ArrayNearMode::kAbsolute, result);
+  assertEqual((size_t) 0, result.numFailed);
+  assertNear(0.002, result.maxError, 0.0001);
+
+  compareArrayNear(a, b, 4, 0.0015, ArrayNearMode::kAbsolute, result);
+  assertEqual((size_t) 1, result.numFailed);
+  assertEqual((size_t) 2, result.maxIndex);
+
+  compareArrayNear(a, b, 0, 0.0, ArrayNearMode::kAbsolute, result);
+  assertEqual((size_t) 0, result.numFailed);
+
+  assertArrayNear(a, b, 4, 0.01);
+  assertArrayNear(a, a, 4, 0.0);
+}
+
+test(ArrayNearTest, relative) {
+  float a[] = {1000.0, 0.001, 0.0, -1.0};
+  float b[] = {1001.0, 0.0010009, -0.0, -1.0005};
+  ArrayNearResult result;
+
+  compareArrayNear(a, b, 4, 0.002, ArrayNearMode::kRelative, result);
+  assertEqual((size_t) 0, result.numFailed);
+
+  compareArrayNear(a, b, 4, 0.0008, ArrayNearMode::kRelative, result);
+  assertEqual((size_t) 2, result.numFailed);
+  assertEqual((size_t) 0, result.maxIndex);
+
+  // Any difference with 0 is a relative error of 1.
+  float zero[] = {0.0};
+  float tiny[] = {1e-30};
+  compareArrayNear(zero, tiny, 1, 0.5, ArrayNearMode::kRelative, result);
+  assertEqual((size_t) 1, result.numFailed);
+  assertNear(1.0, result.maxError, 0.0001);
+
+  assertArrayNearRelative(a, b, 4, 0.002);
+}
+
+test(ArrayNearTest, ulps) {
+  float a[] = {1.0, 1e-20, 1e20, 0.0};
+  float b[] = {nextUp(nextUp(1.0)), nextUp(1e-20), 1e20, -0.0};
+  ArrayNearResult result;
+
+  compareArrayNear(a, b, 4, 2, ArrayNearMode::kUlps, result);
+  assertEqual((size_t) 0, result.numFailed);
+  assertNear(2.0, result.maxError, 0.0);
+
+  compareArrayNear(a, b, 4, 1, ArrayNearMode::kUlps, result);
+  assertEqual((size_t) 1, result.numFailed);
+  assertEqual((size_t) 0, result.maxIndex);
+
+  // The smallest positive and negative floats are 2 ULPs apart.
+  float minPositive = nextUp(0.0);
+  float plus[] = {minPositive};
+  float minus[] = {-minPositive};
+  compareArrayNear(plus, minus, 1, 1, ArrayNearMode::kUlps, result);
+  assertEqual((size_t) 1, result.numFailed);
+  assertNear(2.0, result.maxError, 0.0);
+
+  assertArrayNearUlps(a, b, 4, 2);
+}
+
+test(ArrayNearTest, specialValues) {
+  float a[] = {INFINITY, -INFINITY, NAN, 1.0};
+  float b[] = {INFINITY, -INFINITY, 1.0, NAN};
+  ArrayNearResult result;
+
+  // Equal infinities pass, NaN always fails, in every mode.
+  for (uint8_t mode = 0; mode <= ArrayNearMode::kUlps; mode++) {
+    compareArrayNear(a, b, 2, 0.0, mode, result);
+    assertEqual((size_t) 0, result.numFailed);
+
+    compareArrayNear(a, b, 4, 1e30, mode, result);
+    assertEqual((size_t) 2, result.numFailed);
+    assertEqual((size_t) 2, result.maxIndex);
+  }
+}
+
+test(ArrayNearTest, specialTolerances) {
+  float a[] = {1.0, 2.0};
+  float b[] = {1.0, 3.0};
+  ArrayNearResult result;
+
+  // A tolerance of -0.0 or NaN is the same as 0, in every mode.
+  for (uint8_t mode = 0; mode <= ArrayNearMode::kUlps; mode++) {
+    compareArrayNear(a, b, 2, -0.0f, mode, result);
+    assertEqual((size_t) 1, result.numFailed);
+
+    compareArrayNear(a, b, 2, NAN, mode, result);
+    assertEqual((size_t) 1, result.numFailed);
+  }
+
+  // A number of ULPs beyond the range of uint32_t accepts the opposite ends
+  // of the finite floats, but still not NaN.
+  float c[] = {-1e38, NAN};
+  float d[] = {1e38, 1.0};
+  compareArrayNear(c, d, 2, 1e20, ArrayNearMode::kUlps, result);
+  assertEqual((size_t) 1, result.numFailed);
+  assertEqual((size_t) 1, result.maxIndex);
+}
+
+test(ArrayNearTest, largeArray) {
+  const size_t n = 1024;
+  static float a[n];
+  static float b[n];
+  for (size_t i = 0; i < n; i++) {
+    a[i] = sin(i * 0.01);
+    b[i] = a[i] + 1e-6;
+  }
+  b[700] += 1e-3;
+  b[900] += 2e-3;
+  ArrayNearResult result;
+
+  compareArrayNear(a, b, n, 1e-4, ArrayNearMode::kAbsolute, result);
+  assertEqual((size_t) 2, result.numFailed);
+  assertEqual((size_t) 900, result.maxIndex);
+  assertNear(2e-3, result.maxError, 1e-5);
+
+  assertArrayNear(a, b, 700, 1e-4);
+}
+
+// The assertArrayNearXxx() macros in the fixture of a typed test, whose base
+// class depends on the template parameter.
+template <typename T>
+class ArrayNearFixture: public TestOnce {
+  protected:
+    float values[2] = {1.0, 2.0};
+};
+
+typedTestF(ArrayNearFixture, (float, double), near) {
+  float close[2] = {1.0001, 2.0};
+  TypeParam tolerance = 0.001;
+  assertArrayNear(this->values, close, 2, tolerance);
+  assertArrayNearRelative(this->values, close, 2, tolerance);
+  assertArrayNearUlps(this->values, this->values, 2, 0);
+}
+
+test(ArrayNearTest, failedMessage) {
+  float a[] = {1.0, 1.25, 3.0};
+  float b[] = {1.0, 1.262, 3.5};
+
+  CapturePrint output;
+  ArrayNearDummyTest absoluteTest(a, b, 3, 0.001,
+      ArrayNearMode::kAbsolute);
+  absoluteTest.once();
+  output.release();
+
+  assertTrue(absoluteTest.isFailed());
+  assertTrue(strstr(output.getBuffer(),
+      "ArrayNearTest.ino:") == output.getBuffer());
+  assertTrue(strstr(output.getBuffer(),
+      ": Assertion failed: (3) elements within (1.00e-3), "
+      "(2) out of tolerance, max error (5.00e-1) at [2]: "
+      "(3.000000e0) vs (3.500000e0).\r\n") != nullptr);
+}
+
+test(ArrayNearTest, passedMessage) {
+  float a[] = {1.0, 2.0};
+  float b[] = {nextUp(1.0), 2.0};
+
+  CapturePrint output;
+  ArrayNearDummyTest ulpsTest(a, b, 2, 4, ArrayNearMode::kUlps);
+  ulpsTest.once();
+  ArrayNearDummyTest relativeTest(a, b, 2, 0.01, ArrayNearMode::kRelative);
+  relativeTest.once();
+  output.release();
+
+  assertTrue(strstr(output.getBuffer(),
+      ": Assertion passed: (2) elements within (4) ulps, "
+      "max error (1) ulps.\r\n") != nullptr);
+  assertTrue(strstr(output.getBuffer(),
+      ": Assertion passed: (2) elements within (1.00e-2) relative, "
+      "max error (1.19e-7) relative.\r\n") != nullptr);
+}
+
+//---------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+}
+
+void loop() {
+  TestRunner::run();
+}
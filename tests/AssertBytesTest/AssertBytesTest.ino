@@ -0,0 +1,195 @@
+#line 2 "AssertBytesTest.ino"
+
+#include <string.h>
+#include <AUnit.h>
+#include <aunit/fake/CapturePrint.h>
+
+using namespace aunit;
+using aunit::fake::CapturePrint;
+using aunit::internal::findBytesMismatch;
+
+static const uint8_t kFrame[] PROGMEM = {0x01, 0x03, 0x00, 0x10, 0x00, 0x02};
+static const int16_t kSamples[] PROGMEM = {-1, 0, 1, 1000};
+
+// A test which is not registered with the TestRunner, used to capture the
+// message of a failed assertion. Its verbosity is not set by the TestRunner.
+class BytesTest: public TestOnce {
+  public:
+    BytesTest(const void* lhs, const void* rhs, size_t n):
+        mLhs((const uint8_t*) lhs),
+        mRhs((const uint8_t*) rhs),
+        mN(n) {
+      enableVerbosity(Verbosity::kAssertionFailed);
+    }
+
+    void once() override {
+      assertBytesEqual(mLhs, mRhs, mN);
+      mIsAfterAssertion = true;
+    }
+
+    bool mIsAfterAssertion = false;
+
+  private:
+    const uint8_t* const mLhs;
+    const uint8_t* const mRhs;
+    size_t const mN;
+};
+
+// Same as BytesTest for arrays of uint16_t.
+class ArrayTest: public TestOnce {
+  public:
+    ArrayTest(const uint16_t* lhs, const uint16_t* rhs, size_t n):
+        mLhs(lhs),
+        mRhs(rhs),
+        mN(n) {
+      enableVerbosity(Verbosity::kAssertionFailed);
+    }
+
+    void once() override {
+      assertArrayEqual(mLhs, mRhs, mN);
+    }
+
+  private:
+    const uint16_t* const mLhs;
+    const uint16_t* const mRhs;
+    size_t const mN;
+};
+
+test(AssertBytesTest, bytesEqual) {
+  uint8_t frame[] = {0x01, 0x03, 0x00, 0x10, 0x00, 0x02};
+  char text[] = "abc";
+
+  assertBytesEqual(frame, frame, sizeof(frame));
+  assertBytesEqual(frame, AUNIT_FPSTR(kFrame), sizeof(frame));
+  assertBytesEqual(AUNIT_FPSTR(kFrame), frame, sizeof(frame));
+  assertBytesEqual(AUNIT_FPSTR(kFrame), AUNIT_FPSTR(kFrame), sizeof(frame));
+  assertBytesEqual(frame, F("\x01\x03\x00\x10\x00\x02"), sizeof(frame));
+  assertBytesEqual(text, "abd", 2);
+  assertBytesEqual(text, "xyz", 0);
+}
+
+test(AssertBytesTest, arrayEqual) {
+  int16_t samples[] = {-1, 0, 1, 1000};
+  uint32_t words[] = {0xDEADBEEF, 0};
+  uint32_t sameWords[] = {0xDEADBEEF, 0};
+
+  assertArrayEqual(samples, samples, 4);
+  assertArrayEqual(samples, AUNIT_FPSTR(kSamples), 4);
+  assertArrayEqual(AUNIT_FPSTR(kSamples), samples, 4);
+  assertArrayEqual(words, sameWords, 2);
+}
+
+// The assertBytesEqual() and assertArrayEqual() macros in the fixture of a
+// typed test, whose base class depends on the template parameter.
+template <typename T>
+class BytesFixture: public TestOnce {
+  protected:
+    T values[3] = {1, 2, 3};
+};
+
+typedTestF(BytesFixture, (uint8_t, int32_t), equal) {
+  TypeParam same[3] = {1, 2, 3};
+  assertBytesEqual(this->values, same, sizeof(same));
+  assertArrayEqual(this->values, same, 3);
+}
+
+test(AssertBytesTest, findBytesMismatch) {
+  uint8_t a[100];
+  uint8_t b[100];
+  for (uint8_t i = 0; i < 100; i++) {
+    a[i] = i;
+    b[i] = i;
+  }
+  assertEqual((size_t) 100, findBytesMismatch(a, b, 100));
+  assertEqual((size_t) 0, findBytesMismatch(a, b, 0));
+
+  // Around the boundaries of the blocks compared by memcmp().
+  const uint8_t offsets[] = {0, 1, 31, 32, 33, 63, 64, 99};
+  for (uint8_t offset : offsets) {
+    b[offset] = 0xFF;
+    assertEqual((size_t) offset, findBytesMismatch(a, b, 100));
+    assertEqual((size_t) offset, findBytesMismatch(b, a, 100));
+    b[offset] = offset;
+  }
+
+  uint8_t frame[] = {0x01, 0x03, 0x00, 0x11, 0x00, 0x02};
+  assertEqual((size_t) 3, findBytesMismatch(frame, AUNIT_FPSTR(kFrame), 6));
+  assertEqual((size_t) 3, findBytesMismatch(AUNIT_FPSTR(kFrame), frame, 6));
+  assertEqual((size_t) 6, findBytesMismatch(
+      AUNIT_FPSTR(kFrame), AUNIT_FPSTR(kFrame), 6));
+}
+
+test(AssertBytesTest, bytesMismatchMessage) {
+  uint8_t a[16];
+  uint8_t b[16];
+  for (uint8_t i = 0; i < 16; i++) {
+    a[i] = i;
+    b[i] = i;
+  }
+  b[5] = 0xFF;
+
+  CapturePrint output;
+  BytesTest bytesTest(a, b, 16);
+  bytesTest.once();
+  output.release();
+
+  assertTrue(bytesTest.isFailed());
+  assertFalse(bytesTest.mIsAfterAssertion);
+  assertTrue(strstr(output.getBuffer(),
+      "AssertBytesTest.ino:") == output.getBuffer());
+  assertTrue(strstr(output.getBuffer(),
+      ": Assertion failed: (16) bytes, mismatch at [5]: "
+      "{... 02 03 04 (05) 06 07 08 ...} vs {... 02 03 04 (FF) 06 07 08 ...}."
+      "\r\n") != nullptr);
+}
+
+test(AssertBytesTest, bytesMismatchMessage_edges) {
+  uint8_t a[] = {0x10, 0x20, 0x30, 0x40, 0x50};
+  uint8_t b[] = {0x10, 0x20, 0x30, 0x40, 0x51};
+
+  CapturePrint output;
+  BytesTest lastTest(a, b, 5);
+  lastTest.once();
+  BytesTest firstTest(b + 4, a + 4, 1);
+  firstTest.once();
+  output.release();
+
+  assertTrue(strstr(output.getBuffer(),
+      ": Assertion failed: (5) bytes, mismatch at [4]: "
+      "{... 20 30 40 (50)} vs {... 20 30 40 (51)}.\r\n") != nullptr);
+  assertTrue(strstr(output.getBuffer(),
+      ": Assertion failed: (1) bytes, mismatch at [0]: "
+      "{(51)} vs {(50)}.\r\n") != nullptr);
+}
+
+test(AssertBytesTest, arrayMismatchMessage) {
+  uint16_t a[] = {0x0102, 0x0304, 0x0506};
+  uint16_t b[] = {0x0102, 0x0305, 0x0506};
+
+  CapturePrint output;
+  ArrayTest arrayTest(a, b, 3);
+  arrayTest.once();
+  output.release();
+
+  assertTrue(arrayTest.isFailed());
+  assertTrue(strstr(output.getBuffer(),
+      ": Assertion failed: (3) elements, mismatch at [1]: "
+      "{0102 (0304) 0506} vs {0102 (0305) 0506}.\r\n") != nullptr);
+}
+
+//---------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,89 @@
+#line 2 "BenchmarkTest.ino"
+
+#include <AUnit.h>
+
+using namespace aunit;
+using namespace aunit::internal;
+
+static const BenchmarkBaseline kGenerousBaseline PROGMEM = {1000000, 1000};
+static const BenchmarkBaseline kNoBaseline PROGMEM = {0, 0};
+
+test(BenchmarkTest, computeMedian) {
+  uint32_t odd[] = {5, 1, 3};
+  assertEqual(3UL, (unsigned long) computeMedian(odd, 3));
+
+  uint32_t even[] = {8, 2, 4, 6};
+  assertEqual(5UL, (unsigned long) computeMedian(even, 4));
+
+  uint32_t outlier[] = {10, 11, 9, 10, 1000};
+  assertEqual(10UL, (unsigned long) computeMedian(outlier, 5));
+
+  assertEqual(0UL, (unsigned long) computeMedian(odd, 0));
+}
+
+test(BenchmarkTest, computeMad) {
+  uint32_t values[] = {10, 11, 9, 10, 1000};
+  uint32_t median = computeMedian(values, 5);
+  assertEqual(1UL, (unsigned long) computeMad(values, 5, median));
+}
+
+test(BenchmarkTest, isNoSlowerThan) {
+  // Within tolerance.
+  assertTrue(isNoSlowerThan(1100, 0, 1000, 0, 10));
+  // Outside of tolerance.
+  assertFalse(isNoSlowerThan(1101, 0, 1000, 0, 10));
+  // Noise allowance is 3 * max(mad).
+  assertTrue(isNoSlowerThan(1130, 10, 1000, 5, 10));
+  assertFalse(isNoSlowerThan(1131, 10, 1000, 5, 10));
+  // No baseline always passes.
+  assertTrue(isNoSlowerThan(1000000, 0, 0, 0, 0));
+  // Large baselines do not overflow.
+  assertTrue(isNoSlowerThan(4000000000UL, 0, 3900000000UL, 0, 10));
+  // The limit saturates instead of wrapping around.
+  assertTrue(isNoSlowerThan(4294967295UL, 2000000000UL, 3000000000UL, 0, 10));
+  assertTrue(isNoSlowerThan(4294967295UL, 0, 4000000000UL, 0, 100));
+}
+
+test(BenchmarkTest, next) {
+  Benchmark bench("loop", 5);
+  uint8_t count = 0;
+  while (bench.next()) {
+    count++;
+  }
+  // One warm up iteration, plus 5 samples.
+  assertEqual(6, count);
+  assertEqual(5, bench.getNumSamples());
+
+  // Calling next() again keeps the statistics.
+  uint32_t median = bench.getMedian();
+  uint32_t mad = bench.getMad();
+  assertFalse(bench.next());
+  assertFalse(bench.next());
+  assertEqual((unsigned long) median, (unsigned long) bench.getMedian());
+  assertEqual((unsigned long) mad, (unsigned long) bench.getMad());
+}
+
+test(BenchmarkTest, assertNoSlowerThan) {
+  Benchmark bench(F("BenchmarkTest_assertNoSlowerThan"));
+  volatile uint16_t sum = 0;
+  while (bench.next()) {
+    for (uint8_t i = 0; i < 100; i++) sum += i;
+  }
+  assertNoSlowerThan(bench, kGenerousBaseline, 10);
+  assertNoSlowerThan(bench, kNoBaseline, 0);
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+}
+
+void loop() {
+  TestRunner::run();
+}
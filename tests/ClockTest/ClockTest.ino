@@ -0,0 +1,122 @@
+#line 2 "ClockTest.ino"
+
+#include <AUnit.h>
+#if defined(EPOXY_DUINO)
+#include <thread>
+#endif
+
+using namespace aunit;
+
+// Slack allowed between a deadline and the time when the test wakes up, for
+// the real time which passes during the other steps of the TestRunner.
+const unsigned long kSlackMillis = 100;
+
+// A retry policy which waits 10 minutes between 3 attempts.
+const unsigned long kBackoffMillis = 10UL * 60 * 1000;
+
+class BackoffTest: public TestAgain {
+  protected:
+    void setup() override {
+      TestAgain::setup();
+      mStart = Clock::millis();
+      mRealStart = millis();
+      mDeadline = mStart + kBackoffMillis;
+    }
+
+    unsigned long mStart;
+    unsigned long mRealStart;
+    unsigned long mDeadline;
+    int mNumRetries = 0;
+};
+
+testingF(BackoffTest, retries) {
+  if (! Clock::waitUntil(mDeadline)) return;
+  assertLess(Clock::millis() - mDeadline, kSlackMillis);
+
+  mNumRetries++;
+  if (mNumRetries < 3) {
+    mDeadline += kBackoffMillis;
+    return;
+  }
+
+  assertMoreOrEqual(Clock::millis() - mStart, 3 * kBackoffMillis);
+  assertLess(millis() - mRealStart, 5000UL);
+  pass();
+}
+
+// Set when the test which calls Clock::delay() is done. The delay skips the
+// time of all the tests, as it would block them on the hardware.
+bool isDelayDone = false;
+
+// A debounce window which runs at the same time as the retries, with a much
+// shorter period, so the Clock must not skip past its deadlines.
+const unsigned long kDebounceMillis = 70;
+unsigned long debounceDeadline;
+int numDebounces = 0;
+
+testing(ClockTest, debounce) {
+  if (numDebounces == 0) {
+    if (! isDelayDone) return;
+    debounceDeadline = Clock::millis() + kDebounceMillis;
+    numDebounces = 1;
+    return;
+  }
+
+  if (! Clock::waitUntil(debounceDeadline)) return;
+  assertLess(Clock::millis() - debounceDeadline, kSlackMillis);
+
+  numDebounces++;
+  if (numDebounces > 100) pass();
+  debounceDeadline += kDebounceMillis;
+}
+
+test(ClockTest, delaySkipsAhead) {
+  unsigned long start = Clock::millis();
+  unsigned long startMicros = Clock::micros();
+  unsigned long realStart = millis();
+  Clock::delay(60000);
+  isDelayDone = true;
+
+  assertMoreOrEqual(Clock::millis() - start, 60000UL);
+  assertMoreOrEqual(Clock::micros() - startMicros, 60000000UL);
+  assertLess(millis() - realStart, 1000UL);
+}
+
+test(ClockTest, isVirtual) {
+  assertTrue(Clock::isVirtual());
+}
+
+#if defined(EPOXY_DUINO)
+
+std::thread::id sMainThread;
+
+// The virtual time keeps all the tests on the main thread, see setup().
+test(ClockTest, runsOnMainThread) {
+  assertTrue(std::this_thread::get_id() == sMainThread);
+}
+
+#endif
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+
+  // Same as the '--jobs 4' flag.
+  sMainThread = std::this_thread::get_id();
+  TestRunner::setJobs(4);
+#endif
+
+  // Same as the '--virtual-time' flag. The timeout is measured using the
+  // Clock, so it must cover the 30 minutes of the retries.
+  TestRunner::setVirtualTime(true);
+  TestRunner::setTimeout(3600);
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,152 @@
+#line 2 "ComparingPrintTest.ino"
+
+#include <AUnit.h>
+#include <aunit/fake/FakePrint.h>
+
+using namespace aunit;
+using aunit::fake::FakePrint;
+
+static const char kJson[] PROGMEM = "{\"a\":1,\"b\":[1,2,3]}";
+
+// A typical code under test, which prints to any Print.
+static void printJson(Print& printer, int last) {
+  printer.print("{\"a\":1,\"b\":[1,2,");
+  printer.print(last);
+  printer.print("]}");
+}
+
+test(ComparingPrintTest, assertPrinted) {
+  assertPrinted(out, "{\"a\":1,\"b\":[1,2,3]}") {
+    printJson(out, 3);
+  }
+}
+
+test(ComparingPrintTest, assertPrinted_flashString) {
+  assertPrinted(out, F("{\"a\":1,\"b\":[1,2,3]}")) {
+    printJson(out, 3);
+  }
+
+  assertPrinted(out, AUNIT_FPSTR(kJson)) {
+    printJson(out, 3);
+  }
+}
+
+test(ComparingPrintTest, assertPrinted_empty) {
+  assertPrinted(out, "") {
+  }
+}
+
+test(ComparingPrintTest, assertPrinted_longOutput) {
+  // Longer than any buffer of FakePrint.
+  assertPrinted(out, F(
+      "0123456789012345678901234567890123456789"
+      "0123456789012345678901234567890123456789"
+      "0123456789012345678901234567890123456789")) {
+    for (int i = 0; i < 120; i++) {
+      out.print(i % 10);
+    }
+  }
+}
+
+// The assertPrinted() macro in the fixture of a typed test, whose base class
+// depends on the template parameter.
+template <typename T>
+class PrintedFixture: public TestOnce {};
+
+typedTestF(PrintedFixture, (int, long), assertPrinted) {
+  assertPrinted(out, "{\"a\":1,\"b\":[1,2,3]}") {
+    printJson(out, (TypeParam) 3);
+  }
+}
+
+test(ComparingPrintTest, match) {
+  ComparingPrint output("abc");
+  output.print("ab");
+  assertTrue(output.isMatch());
+  output.print('c');
+  output.finish();
+  assertTrue(output.isFinished());
+  assertTrue(output.isMatch());
+  assertEqual(output.getNumWritten(), (size_t) 3);
+  assertEqual(output.getMismatchOffset(), ComparingPrint::kNoMismatch);
+}
+
+test(ComparingPrintTest, mismatch) {
+  ComparingPrint output(AUNIT_FPSTR(kJson));
+  printJson(output, 4);
+  output.finish();
+  assertFalse(output.isMatch());
+  assertEqual(output.getMismatchOffset(), (size_t) 16);
+  assertEqual(output.getNumWritten(), (size_t) 19);
+
+  FakePrint fakePrint;
+  output.printMismatch(&fakePrint);
+  assertEqual(
+      "expected \"...b\\\":[1,2,3]}\" but got \"...b\\\":[1,2,4]}\"",
+      fakePrint.getBuffer());
+}
+
+test(ComparingPrintTest, mismatch_context) {
+  ComparingPrint output("0123456789abcdefghij");
+  output.print("0123456789abXdefghijklmnop");
+  output.finish();
+  assertEqual(output.getMismatchOffset(), (size_t) 12);
+
+  FakePrint fakePrint;
+  output.printMismatch(&fakePrint);
+  assertEqual(
+      "expected \"...456789abcdefghij\" but got \"...456789abXdefghij...\"",
+      fakePrint.getBuffer());
+}
+
+test(ComparingPrintTest, mismatch_escaped) {
+  ComparingPrint output("a\r\nb");
+  output.print("a\n\x01");
+  output.finish();
+  assertEqual(output.getMismatchOffset(), (size_t) 1);
+
+  FakePrint fakePrint;
+  output.printMismatch(&fakePrint);
+  assertEqual("expected \"a\\r\\nb\" but got \"a\\n\\x01\"",
+      fakePrint.getBuffer());
+}
+
+test(ComparingPrintTest, shorterOutput) {
+  ComparingPrint output("abcdef");
+  output.print("abc");
+  assertTrue(output.isMatch());
+  output.finish();
+  assertFalse(output.isMatch());
+  assertEqual(output.getMismatchOffset(), (size_t) 3);
+
+  FakePrint fakePrint;
+  output.printMismatch(&fakePrint);
+  assertEqual("expected \"abcdef\" but got \"abc\"", fakePrint.getBuffer());
+}
+
+test(ComparingPrintTest, longerOutput) {
+  ComparingPrint output(F("abc"));
+  output.print("abcdef");
+  output.finish();
+  assertFalse(output.isMatch());
+  assertEqual(output.getMismatchOffset(), (size_t) 3);
+
+  FakePrint fakePrint;
+  output.printMismatch(&fakePrint);
+  assertEqual("expected \"abc\" but got \"abcdef\"", fakePrint.getBuffer());
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,126 @@
+#line 2 "FakeStreamTest.ino"
+
+#include <AUnit.h>
+#include <aunit/fake/FakePrint.h>
+#include <aunit/fake/FakeStream.h>
+
+using namespace aunit;
+using aunit::fake::FakePrint;
+using aunit::fake::FakeStream;
+
+// Count the lines of the stream, as a stand-in for a protocol parser.
+uint32_t countLines(FakeStream& stream) {
+  uint32_t numLines = 0;
+  while (stream.available()) {
+    if (stream.read() == '\n') numLines++;
+  }
+  return numLines;
+}
+
+test(FakeStreamTest, readsRamScript) {
+  FakeStream stream("AT\r\nOK\r\n");
+
+  assertEqual(8, stream.available());
+  assertEqual((int) 'A', stream.peek());
+  assertEqual((int) 'A', stream.read());
+  assertEqual((int) 'T', stream.read());
+  assertEqual(6, stream.available());
+  assertEqual((uint32_t) 2, countLines(stream));
+  assertTrue(stream.isDone());
+  assertEqual(-1, stream.read());
+  assertEqual(-1, stream.peek());
+  assertEqual(0, stream.available());
+
+  stream.rewind();
+  assertEqual((int) 'A', stream.read());
+}
+
+test(FakeStreamTest, readsFlashScriptWithNul) {
+  // A Modbus frame contains NUL bytes.
+  FakeStream stream(F("\x01\x03\x00\x10"), 4);
+
+  assertEqual(4, stream.available());
+  assertEqual(0x01, stream.read());
+  assertEqual(0x03, stream.read());
+  assertEqual(0x00, stream.read());
+  assertEqual(0x10, stream.read());
+  assertEqual(-1, stream.read());
+}
+
+test(FakeStreamTest, repeatsScript) {
+  FakeStream stream(F("$GPGGA,123519,4807.038,N,01131.000,E*47\r\n"));
+  stream.setRepeat(1000);
+
+  assertEqual((uint32_t) 1000, countLines(stream));
+  assertEqual((uint32_t) 41000, stream.getNumRead());
+  assertTrue(stream.isDone());
+}
+
+test(FakeStreamTest, forwardsWrites) {
+  FakePrint output;
+  FakeStream stream("OK\r\n");
+  stream.setOutput(&output);
+
+  stream.print("AT\r\n");
+  assertEqual("AT\r\n", output.getBuffer());
+  assertEqual((uint32_t) 4, stream.getNumWritten());
+}
+
+test(FakeStreamTest, reportsThroughput) {
+  FakeStream stream("0123456789");
+  stream.setRepeat(10000);
+  countLines(stream);
+
+  assertEqual((uint32_t) 100000, stream.getNumRead());
+  assertMore(stream.getBytesPerSecond(), (uint32_t) 0);
+}
+
+// Receives a script at 9600 baud, i.e. 1 byte every 1042 micros, which takes
+// about 1 second on the hardware, and a few milliseconds with the virtual
+// time.
+class BaudRateTest: public TestAgain {
+  protected:
+    void setup() override {
+      TestAgain::setup();
+      mStream.setBaudRate(9600);
+      mStream.setRepeat(24);
+      mStart = Clock::millis();
+      mRealStart = millis();
+    }
+
+    FakeStream mStream{F("$GPRMC,123519,A,4807.038,N*6A\r\n")};
+    uint32_t mNumLines = 0;
+    unsigned long mStart;
+    unsigned long mRealStart;
+};
+
+testingF(BaudRateTest, receives) {
+  mNumLines += countLines(mStream);
+  if (!mStream.isDone()) return;
+
+  assertEqual((uint32_t) 24, mNumLines);
+  // 24 sentences of 31 bytes. The Clock never skips past the arrival of the
+  // next byte, so the skipped time is at most the time of the transfer.
+  const unsigned long kTransferMillis = 24UL * 31 * 1042 / 1000;
+  unsigned long elapsed = Clock::millis() - mStart;
+  unsigned long skipped = elapsed - (millis() - mRealStart);
+  assertMoreOrEqual(elapsed, kTransferMillis);
+  assertLessOrEqual(skipped, kTransferMillis + 1);
+  pass();
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+  TestRunner::setVirtualTime(true);
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,148 @@
+#line 2 "FuzzTestTest.ino"
+
+#include <AUnit.h>
+#if defined(EPOXY_DUINO)
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+using namespace aunit;
+
+// A fuzz target which is not registered with the TestRunner, used to verify
+// the replay of a corpus. Fails on any input which starts with 'x'.
+class NoXFuzz: public FuzzTest {
+  public:
+    void fuzzInput(const uint8_t* data, size_t size) override {
+      totalSize += size;
+      assertFalse(size > 0 && data[0] == 'x');
+    }
+
+    size_t totalSize = 0;
+};
+
+// Records the first byte of each input, to verify the order of the replay.
+class OrderFuzz: public FuzzTest {
+  public:
+    void fuzzInput(const uint8_t* data, size_t size) override {
+      if (size > 0 && numInputs < sizeof(firstBytes) - 1) {
+        firstBytes[numInputs++] = data[0];
+      }
+    }
+
+    char firstBytes[8] = "";
+    uint8_t numInputs = 0;
+};
+
+#if defined(EPOXY_DUINO)
+
+// Create a temporary corpus directory containing the given inputs.
+void writeCorpus(char* dir, const char* const inputs[], uint8_t n) {
+  strcpy(dir, "/tmp/aunit_corpus_XXXXXX");
+  mkdtemp(dir);
+  for (uint8_t i = 0; i < n; i++) {
+    char path[64];
+    snprintf(path, sizeof(path), "%s/input%d", dir, i);
+    FILE* file = fopen(path, "wb");
+    fputs(inputs[i], file);
+    fclose(file);
+  }
+}
+
+void removeCorpus(const char* dir, uint8_t n) {
+  for (uint8_t i = 0; i < n; i++) {
+    char path[64];
+    snprintf(path, sizeof(path), "%s/input%d", dir, i);
+    unlink(path);
+  }
+  rmdir(dir);
+}
+
+#endif
+
+testFuzz(FuzzTestTest, emptyInput) {
+  (void) data;
+  assertEqual(size, (size_t) 0);
+}
+
+#if defined(EPOXY_DUINO)
+
+test(FuzzTestTest, replayCorpus) {
+  static const char* const kInputs[] = {"", "a", "bc", "def"};
+  char dir[32];
+  writeCorpus(dir, kInputs, 4);
+
+  NoXFuzz fuzz;
+  FuzzTest::setCorpus(dir);
+  fuzz.once();
+  FuzzTest::setCorpus(nullptr);
+  removeCorpus(dir, 4);
+
+  assertFalse(fuzz.isFailed());
+  assertEqual(fuzz.getNumInputs(), 4);
+  assertEqual(fuzz.totalSize, (size_t) 6);
+}
+
+test(FuzzTestTest, replayCorpusFails) {
+  static const char* const kInputs[] = {"xyz"};
+  char dir[32];
+  writeCorpus(dir, kInputs, 1);
+
+  NoXFuzz fuzz;
+  FuzzTest::setCorpus(dir);
+  fuzz.once();
+  FuzzTest::setCorpus(nullptr);
+  removeCorpus(dir, 1);
+
+  assertTrue(fuzz.isFailed());
+  assertEqual(fuzz.getNumInputs(), 1);
+}
+
+test(FuzzTestTest, replayCorpusSorted) {
+  static const char* const kInputs[] = {"d", "c", "b", "a"};
+  char dir[32];
+  writeCorpus(dir, kInputs, 4);
+
+  OrderFuzz fuzz;
+  FuzzTest::setCorpus(dir);
+  fuzz.once();
+  FuzzTest::setCorpus(nullptr);
+  removeCorpus(dir, 4);
+
+  // The inputs are replayed in the order of their names, input0 to input3.
+  assertEqual(fuzz.firstBytes, "dcba");
+}
+
+test(FuzzTestTest, missingCorpusFails) {
+  NoXFuzz fuzz;
+  FuzzTest::setCorpus("/nonexistent/aunit_corpus");
+  fuzz.once();
+  FuzzTest::setCorpus(nullptr);
+  assertTrue(fuzz.isFailed());
+}
+
+#endif
+
+test(FuzzTestTest, noCorpusRunsEmptyInput) {
+  NoXFuzz fuzz;
+  fuzz.once();
+  assertFalse(fuzz.isFailed());
+  assertEqual(fuzz.getNumInputs(), 1);
+  assertEqual(fuzz.totalSize, (size_t) 0);
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,113 @@
+#line 2 "HeapMonitorTest.ino"
+
+#if defined(EPOXY_DUINO)
+#include <malloc.h> // valloc(), pvalloc()
+#include <stdlib.h> // reallocarray()
+#endif
+#include <AUnit.h>
+
+using namespace aunit;
+
+HeapMonitor heapMonitor;
+
+// A test which is not registered with the TestRunner, used to verify that the
+// leak check fails the test.
+class DummyTest: public TestOnce {
+  public:
+    void once() override {}
+};
+
+// Prevent the compiler from optimizing away the allocation.
+volatile int* allocated;
+
+test(HeapMonitorTest, noAllocations) {
+  assertNoAllocations {
+    volatile int x = 1;
+    (void) x;
+  }
+}
+
+test(HeapMonitorTest, allocationsAtMost) {
+  assertAllocationsAtMost(1) {
+    allocated = new int(1);
+    delete allocated;
+  }
+}
+
+test(HeapMonitorTest, allocationsAreCounted) {
+  if (! HeapMonitor::isCountSupported()) skipTestNow();
+
+  uint32_t before = HeapMonitor::getAllocationCount();
+  allocated = new int(1);
+  uint32_t after = HeapMonitor::getAllocationCount();
+  delete allocated;
+  assertEqual((unsigned long) (after - before), 1UL);
+}
+
+#if defined(EPOXY_DUINO) && defined(__GLIBC__)
+// Every allocation function of glibc must be tracked, otherwise free()
+// subtracts bytes which were never added.
+test(HeapMonitorTest, allocatorFamilyIsBalanced) {
+  if (! HeapMonitor::isCountSupported()) skipTestNow();
+
+  size_t bytes = HeapMonitor::getBytesInUse();
+  uint32_t before = HeapMonitor::getAllocationCount();
+  void* pages = valloc(100);
+  void* rounded = pvalloc(100);
+  void* array = reallocarray(nullptr, 10, sizeof(int));
+  uint32_t after = HeapMonitor::getAllocationCount();
+  assertMore(HeapMonitor::getBytesInUse(), bytes);
+  free(pages);
+  free(rounded);
+  free(array);
+
+  assertEqual((unsigned long) (after - before), 3UL);
+  assertEqual(HeapMonitor::getBytesInUse(), bytes);
+
+  // An overflow of (count * size) fails without allocating.
+  volatile size_t count = SIZE_MAX;
+  assertEqual(reallocarray(nullptr, count, 2), (void*) nullptr);
+}
+#endif
+
+test(HeapMonitorTest, leakFailsTest) {
+  if (! HeapMonitor::isUsageSupported()) skipTestNow();
+
+  HeapMonitor monitor;
+  DummyTest dummy;
+  monitor.testStarting(dummy);
+  allocated = new int(1);
+  monitor.testFinished(dummy);
+  delete allocated;
+
+  assertMore(monitor.getLeakedBytes(), 0L);
+  assertTrue(dummy.isFailed());
+}
+
+test(HeapMonitorTest, noLeakPassesTest) {
+  HeapMonitor monitor;
+  DummyTest dummy;
+  monitor.testStarting(dummy);
+  allocated = new int(1);
+  delete allocated;
+  monitor.testFinished(dummy);
+
+  assertEqual(monitor.getLeakedBytes(), 0L);
+  assertTrue(dummy.isNotDone());
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+  TestRunner::addListener(&heapMonitor);
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,196 @@
+#line 2 "IsrMonitorTest.ino"
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <AUnit.h>
+#include <aunit/fake/CapturePrint.h>
+#if defined(EPOXY_DUINO)
+#include <thread>
+#endif
+
+using namespace aunit;
+using aunit::fake::CapturePrint;
+
+IsrRecord isrRecords[4];
+IsrMonitor isrMonitor(isrRecords, 4);
+
+// A test which is not registered with the TestRunner, used to verify that the
+// records fail the test.
+class DummyTest: public TestOnce {
+  public:
+    void once() override {}
+};
+
+// Interrupt handlers, called directly by the tests.
+void isrPassing() {
+  isrAssertEqual(1, 1);
+  isrAssertNotEqual(1, 2);
+  isrAssertLess(1, 2);
+  isrAssertMore(2, 1);
+  isrAssertLessOrEqual(2, 2);
+  isrAssertMoreOrEqual(2, 2);
+  isrAssertTrue(3);
+  isrAssertFalse(0);
+}
+
+void isrFailing() {
+  isrAssertEqual(1, 2);
+}
+
+test(IsrMonitorTest, passingAssertionsRecordNothing) {
+  DummyTest dummy;
+  isrMonitor.testStarting(dummy);
+  isrPassing();
+  isrMonitor.testFinished(dummy);
+
+  assertTrue(dummy.isNotDone());
+}
+
+test(IsrMonitorTest, failedAssertionFailsTest) {
+  CapturePrint output;
+
+  DummyTest dummy;
+  isrMonitor.testStarting(dummy);
+  isrFailing();
+  isrMonitor.testFinished(dummy);
+
+  output.release();
+  assertTrue(dummy.isFailed());
+  assertTrue(strstr(output.getBuffer(),
+      "IsrMonitorTest.ino:") == output.getBuffer());
+  assertTrue(strstr(output.getBuffer(),
+      ": ISR assertion failed: (1) == (2).") != nullptr);
+}
+
+// The unsigned values above LONG_MAX would be negative if converted to long.
+test(IsrMonitorTest, unsignedAboveLongMax) {
+  const unsigned long big = (unsigned long) LONG_MAX + 2;
+  char expected[64];
+  snprintf(expected, sizeof(expected),
+      ": ISR assertion failed: (%lu) == (0).", big);
+  CapturePrint output;
+
+  DummyTest passing;
+  isrMonitor.testStarting(passing);
+  isrAssertMore(big, 1);
+  isrAssertLess(1, big);
+  isrAssertMoreOrEqual(big, (unsigned long) LONG_MAX);
+  isrMonitor.testFinished(passing);
+
+  DummyTest failing;
+  isrMonitor.testStarting(failing);
+  isrAssertEqual(big, 0);
+  isrMonitor.testFinished(failing);
+
+  output.release();
+  assertTrue(passing.isNotDone());
+  assertTrue(failing.isFailed());
+  assertTrue(strstr(output.getBuffer(), expected) != nullptr);
+}
+
+test(IsrMonitorTest, overflowIsCounted) {
+  CapturePrint output;
+
+  DummyTest dummy;
+  isrMonitor.testStarting(dummy);
+  uint16_t before = isrMonitor.getNumDropped();
+  // The ring of 4 holds 3 records.
+  for (int i = 0; i < 10; i++) {
+    isrFailing();
+  }
+  uint16_t dropped = isrMonitor.getNumDropped() - before;
+  isrMonitor.testFinished(dummy);
+
+  output.release();
+  assertEqual(7, dropped);
+  assertTrue(dummy.isFailed());
+  assertTrue(strstr(output.getBuffer(), "ISR assertions dropped: 7.")
+      != nullptr);
+}
+
+test(IsrMonitorTest, recordsBetweenTestsFailNothing) {
+  CapturePrint output;
+
+  DummyTest dummy;
+  isrFailing();
+  isrMonitor.testStarting(dummy);
+  isrMonitor.testFinished(dummy);
+
+  output.release();
+  assertTrue(dummy.isNotDone());
+  assertTrue(strstr(output.getBuffer(), "ISR assertion failed") != nullptr);
+}
+
+#if defined(EPOXY_DUINO)
+
+// Counts the '=' of the "(a) == (b)" of each printed record.
+class CountingPrint: public Print {
+  public:
+    size_t write(uint8_t c) override {
+      if (c == '=') mCount++;
+      return 1;
+    }
+
+    int getCount() const { return mCount; }
+
+  private:
+    int mCount = 0;
+};
+
+std::thread::id sMainThread;
+
+// The IsrMonitor keeps all the tests on the main thread, see setup().
+test(IsrMonitorTest, runsOnMainThread) {
+  assertTrue(std::this_thread::get_id() == sMainThread);
+}
+
+// An interrupt handler simulated by a thread, while the records are drained
+// by the main thread.
+test(IsrMonitorTest, concurrentProducer) {
+  const int kCount = 1000;
+  CountingPrint output;
+  Print* printer = Printer::getPrinter();
+  Printer::setPrinter(&output);
+
+  DummyTest dummy;
+  isrMonitor.testStarting(dummy);
+  uint16_t before = isrMonitor.getNumDropped();
+  std::thread producer([]() {
+    for (int i = 0; i < kCount; i++) {
+      isrAssertEqual(i, -1);
+    }
+  });
+  for (int i = 0; i < kCount; i++) {
+    isrMonitor.testFinished(dummy);
+  }
+  producer.join();
+  isrMonitor.testFinished(dummy);
+  uint16_t dropped = isrMonitor.getNumDropped() - before;
+
+  Printer::setPrinter(printer);
+  assertEqual(kCount, output.getCount() / 2 + dropped);
+  assertTrue(dummy.isFailed());
+}
+
+#endif
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+
+  // Same as the '--jobs 4' flag.
+  sMainThread = std::this_thread::get_id();
+  TestRunner::setJobs(4);
+#endif
+  TestRunner::addListener(&isrMonitor);
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,78 @@
+#line 2 "LazyFixtureTest.ino"
+
+#include <AUnit.h>
+
+using namespace aunit;
+
+// Number of fixtures which are currently constructed.
+static int numLiveFixtures = 0;
+
+class BufferFixture: public TestOnce {
+  protected:
+    BufferFixture() { numLiveFixtures++; }
+    ~BufferFixture() { numLiveFixtures--; }
+
+    void setup() override {
+      TestOnce::setup();
+      for (uint8_t i = 0; i < sizeof(buffer); i++) buffer[i] = i;
+    }
+
+    uint8_t buffer[64];
+};
+
+lazyTestF(BufferFixture, isConstructed) {
+  assertEqual(1, numLiveFixtures);
+  assertEqual(10, buffer[10]);
+  buffer[10] = 99;
+}
+
+// The fixture is constructed again, so the change made by the previous test is
+// not visible.
+lazyTestF(BufferFixture, isNotShared) {
+  assertEqual(1, numLiveFixtures);
+  assertEqual(10, buffer[10]);
+}
+
+class CountingFixture: public TestAgain {
+  protected:
+    void setup() override {
+      TestAgain::setup();
+      count = 0;
+    }
+
+    uint8_t count;
+};
+
+// These 2 tests share the arena, so the second waits until the first is
+// finished instead of being interleaved with it.
+lazyTestingF(CountingFixture, first) {
+  count++;
+  if (count >= 3) pass();
+}
+
+lazyTestingF(CountingFixture, second) {
+  assertTrue(CountingFixture_first_instance.isPassed());
+  count++;
+  if (count >= 3) pass();
+}
+
+// Runs after the lazyTestF() tests, because the tests are sorted by name.
+test(LazyFixtureTest, fixturesAreDestroyed) {
+  assertEqual(0, numLiveFixtures);
+  assertTrue(BufferFixture_isConstructed_instance.getFixture() == nullptr);
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+}
+
+void loop() {
+  TestRunner::run();
+}
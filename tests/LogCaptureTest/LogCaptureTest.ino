@@ -0,0 +1,165 @@
+#line 2 "LogCaptureTest.ino"
+
+#include <AUnit.h>
+#include <aunit/fake/FakePrint.h>
+
+using namespace aunit;
+using aunit::fake::FakePrint;
+
+// Captures the output of the tests in this file, so that only the failing
+// tests (none) are noisy.
+char logBuffer[128];
+LogCapture logCapture(logBuffer, sizeof(logBuffer));
+
+// A test which is not registered with the TestRunner, used to drive the
+// LogCapture under test.
+class DummyTest: public TestOnce {
+  public:
+    void once() override {}
+};
+
+test(LogCaptureTest, passingTestIsQuiet) {
+  for (int i = 0; i < 100; i++) {
+    logCapture.println(F("Lots of logging in a passing test"));
+  }
+  assertTrue(logCapture.isCapturing());
+  assertEqual(logCapture.getLength(), (uint16_t) sizeof(logBuffer));
+  assertMore((unsigned long) logCapture.getDropped(), 0UL);
+}
+
+test(LogCaptureTest, passingTestIsDiscarded) {
+  FakePrint fakePrint;
+  Print* saved = Printer::getPrinter();
+  Printer::setPrinter(&fakePrint);
+
+  char buffer[16];
+  LogCapture capture(buffer, sizeof(buffer));
+  DummyTest dummy;
+  capture.testStarting(dummy);
+  bool capturing = capture.isCapturing();
+  bool replaced = (Printer::getPrinter() == &capture);
+  Printer::getPrinter()->print("noise");
+  capture.print("log");
+  capture.testFinished(dummy);
+  bool restored = (Printer::getPrinter() == &fakePrint);
+
+  Printer::setPrinter(saved);
+  assertTrue(capturing);
+  assertTrue(replaced);
+  assertTrue(restored);
+  assertFalse(capture.isCapturing());
+  assertEqual(capture.getLength(), (uint16_t) 0);
+  assertEqual("", fakePrint.getBuffer());
+}
+
+test(LogCaptureTest, failingTestIsReplayed) {
+  FakePrint fakePrint;
+  Print* saved = Printer::getPrinter();
+  Printer::setPrinter(&fakePrint);
+
+  char buffer[16];
+  LogCapture capture(buffer, sizeof(buffer));
+  DummyTest dummy;
+  capture.testStarting(dummy);
+  Printer::getPrinter()->print("noise,");
+  capture.print("log");
+  dummy.setStatus(Test::kStatusFailed);
+  capture.testFinished(dummy);
+
+  Printer::setPrinter(saved);
+  assertEqual("noise,log", fakePrint.getBuffer());
+  assertEqual(capture.getLength(), (uint16_t) 0);
+}
+
+test(LogCaptureTest, expiredTestIsReplayed) {
+  FakePrint fakePrint;
+  Print* saved = Printer::getPrinter();
+  Printer::setPrinter(&fakePrint);
+
+  char buffer[16];
+  LogCapture capture(buffer, sizeof(buffer));
+  DummyTest dummy;
+  capture.testStarting(dummy);
+  capture.print("slow");
+  dummy.expire();
+  capture.testFinished(dummy);
+
+  Printer::setPrinter(saved);
+  assertEqual("slow", fakePrint.getBuffer());
+}
+
+test(LogCaptureTest, oldestBytesAreDropped) {
+  FakePrint fakePrint;
+  Print* saved = Printer::getPrinter();
+  Printer::setPrinter(&fakePrint);
+
+  char buffer[8];
+  LogCapture capture(buffer, sizeof(buffer));
+  DummyTest dummy;
+  capture.testStarting(dummy);
+  capture.print("0123456789ab");
+  uint32_t dropped = capture.getDropped();
+  dummy.setStatus(Test::kStatusFailed);
+  capture.testFinished(dummy);
+
+  Printer::setPrinter(saved);
+  assertEqual((unsigned long) dropped, 4UL);
+  assertEqual("LogCapture: 4 byte(s) dropped\r\n456789ab",
+      fakePrint.getBuffer());
+}
+
+test(LogCaptureTest, interleavedTests) {
+  FakePrint fakePrint;
+  Print* saved = Printer::getPrinter();
+  Printer::setPrinter(&fakePrint);
+
+  char buffer[16];
+  LogCapture capture(buffer, sizeof(buffer));
+  DummyTest first;
+  DummyTest second;
+  capture.testStarting(first);
+  capture.print("a");
+  capture.testStarting(second);
+  capture.print("b");
+  capture.testFinished(first);
+  bool capturing = capture.isCapturing();
+  capture.print("c");
+  second.setStatus(Test::kStatusFailed);
+  capture.testFinished(second);
+  bool restored = (Printer::getPrinter() == &fakePrint);
+
+  Printer::setPrinter(saved);
+  assertTrue(capturing);
+  assertTrue(restored);
+  assertEqual("abc", fakePrint.getBuffer());
+}
+
+test(LogCaptureTest, forwardedOutsideOfTest) {
+  FakePrint fakePrint;
+  Print* saved = Printer::getPrinter();
+  Printer::setPrinter(&fakePrint);
+
+  char buffer[16];
+  LogCapture capture(buffer, sizeof(buffer));
+  capture.print("direct");
+
+  Printer::setPrinter(saved);
+  assertEqual("direct", fakePrint.getBuffer());
+  assertEqual(capture.getLength(), (uint16_t) 0);
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+  TestRunner::addListener(&logCapture);
+}
+
+void loop() {
+  TestRunner::run();
+}
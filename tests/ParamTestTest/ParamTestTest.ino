@@ -0,0 +1,78 @@
+#line 2 "ParamTestTest.ino"
+
+#include <AUnit.h>
+
+using namespace aunit;
+
+struct AddCase {
+  int a;
+  int b;
+  int sum;
+};
+
+// Row 2 is wrong on purpose, and is excluded in setup().
+static const AddCase kAddCases[] PROGMEM = {
+  {1, 2, 3},
+  {2, 2, 4},
+  {2, 2, 5},
+  {-1, 1, 0},
+};
+
+static const int kNumbers[] PROGMEM = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+
+static uint8_t addCount = 0;
+static uint8_t evenCount = 0;
+
+testP(ParamTestTest, add, AddCase, kAddCases) {
+  addCount++;
+  assertEqual(param.a + param.b, param.sum);
+}
+
+// Skipping a row must not short-circuit the assertions of the next rows.
+testP(ParamTestTest, even, int, kNumbers) {
+  if (param % 2) skip();
+  assertEqual(param % 2, 0);
+  evenCount++;
+}
+
+testP(ParamTestTest, excluded, int, kNumbers) {
+  assertTrue(false);
+}
+
+// The rows are interleaved with the other tests, so wait until the
+// parameterized tests are done.
+testing(ParamTestTest, zz_monitor) {
+  if (ParamTestTest_add_instance.isNotDone()) return;
+  if (ParamTestTest_even_instance.isNotDone()) return;
+
+  assertEqual(ParamTestTest_add_instance.getNumRows(), 4);
+  assertTrue(ParamTestTest_add_instance.isRowExcluded(2));
+  assertFalse(ParamTestTest_add_instance.isRowExcluded(3));
+  assertEqual(addCount, 3);
+  assertTestPass(ParamTestTest, add);
+
+  assertEqual(evenCount, 6);
+  assertTestPass(ParamTestTest, even);
+
+  assertTrue(ParamTestTest_excluded_instance.isRowExcluded(10));
+  assertTestSkip(ParamTestTest, excluded);
+  pass();
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+
+  TestRunner::exclude("ParamTestTest_add/2");
+  TestRunner::exclude("ParamTestTest_excluded");
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -62,6 +62,18 @@ test(Print64, print64_LL) {
   fakePrint.flush();
 }
 
+test(Print64, print64_LL_min) {
+  FakePrint fakePrint;
+
+  print64(fakePrint, (long long) INT64_MIN);
+  assertEqual("-9223372036854775808", fakePrint.getBuffer());
+  fakePrint.flush();
+
+  print64(fakePrint, (long long) INT64_MAX);
+  assertEqual("9223372036854775807", fakePrint.getBuffer());
+  fakePrint.flush();
+}
+
 test(Print64, println64_LL) {
   FakePrint fakePrint;
 
@@ -82,6 +94,127 @@ test(Print64, print64_ULL) {
   fakePrint.flush();
 }
 
+test(Print64, print64_ULL_decimal) {
+  FakePrint fakePrint;
+
+  print64(fakePrint, 4294967296ULL);
+  assertEqual("4294967296", fakePrint.getBuffer());
+  fakePrint.flush();
+
+  // The lower chunks of 9 digits are padded with zeros.
+  print64(fakePrint, 10000000000ULL);
+  assertEqual("10000000000", fakePrint.getBuffer());
+  fakePrint.flush();
+
+  print64(fakePrint, 1000000000000000001ULL);
+  assertEqual("1000000000000000001", fakePrint.getBuffer());
+  fakePrint.flush();
+
+  print64(fakePrint, 999999999999999999ULL);
+  assertEqual("999999999999999999", fakePrint.getBuffer());
+  fakePrint.flush();
+
+  print64(fakePrint, 12345678901234567890ULL);
+  assertEqual("12345678901234567890", fakePrint.getBuffer());
+  fakePrint.flush();
+
+  print64(fakePrint, 18446744073709551615ULL);
+  assertEqual("18446744073709551615", fakePrint.getBuffer());
+  fakePrint.flush();
+}
+
+test(Print64, print64_ULL_hex) {
+  FakePrint fakePrint;
+
+  print64(fakePrint, 0x100000000ULL, 16);
+  assertEqual("100000000", fakePrint.getBuffer());
+  fakePrint.flush();
+
+  print64(fakePrint, 0xFEDCBA9800000001ULL, 16);
+  assertEqual("FEDCBA9800000001", fakePrint.getBuffer());
+  fakePrint.flush();
+}
+
+test(Print64, print64_ULL_otherBase) {
+  FakePrint fakePrint;
+
+  print64(fakePrint, 0x1000000000ULL, 8);
+  assertEqual("1000000000000", fakePrint.getBuffer());
+  fakePrint.flush();
+
+  print64(fakePrint, 0x100000000ULL, 2);
+  assertEqual("100000000000000000000000000000000", fakePrint.getBuffer());
+  fakePrint.flush();
+}
+
+// Compare every decimal digit count with the generic conversion, which
+// divides by 10 once per digit.
+test(Print64, print64_ULL_matchesGeneric) {
+  FakePrint fakePrint;
+  char expected[21];
+
+  unsigned long long n = 0xFFFFFFFFULL;
+  for (uint8_t i = 0; i < 40; i++) {
+    n = n * 3 + i;
+    char* str = &expected[sizeof(expected) - 1];
+    *str = '\0';
+    unsigned long long m = n;
+    do {
+      *--str = '0' + m % 10;
+      m /= 10;
+    } while (m);
+
+    print64(fakePrint, n);
+    assertEqual(str, fakePrint.getBuffer());
+    fakePrint.flush();
+  }
+}
+
+// A Print which discards its output, so that only the conversion is measured.
+class NullPrint: public Print {
+  public:
+    size_t write(uint8_t /*c*/) override { return 1; }
+};
+
+// The previous conversion, with a 64-bit division for every digit.
+size_t printGeneric64(Print& printer, unsigned long long n) {
+  char buf[21];
+  char* str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+  do {
+    *--str = '0' + n % 10;
+    n /= 10;
+  } while (n);
+  return printer.write(str);
+}
+
+// No baseline is compiled in. Use --save-baseline on EpoxyDuino, or the
+// verbose assertion message on the board, to see the durations.
+static const BenchmarkBaseline kPrint64Baseline PROGMEM = {0, 0};
+
+test(Print64, benchmark) {
+  NullPrint nullPrint;
+  volatile unsigned long long n = 18446744073709551615ULL;
+
+  Benchmark fast(F("Print64_print64"));
+  while (fast.next()) {
+    print64(nullPrint, n);
+  }
+  Benchmark generic(F("Print64_printGeneric64"));
+  while (generic.next()) {
+    printGeneric64(nullPrint, n);
+  }
+
+  assertNoSlowerThan(fast, kPrint64Baseline, 10);
+  assertNoSlowerThan(generic, kPrint64Baseline, 10);
+
+  // The 64-bit divisions by a constant are cheap multiplications on 64-bit
+  // processors, so the difference is significant only on 8-bit processors.
+#if defined(ARDUINO_ARCH_AVR)
+  assertLessOrEqual(fast.getMedian(), generic.getMedian());
+#endif
+}
+
 test(Print64, println64_ULL) {
   FakePrint fakePrint;
 
@@ -0,0 +1,133 @@
+#line 2 "PropertyTestTest.ino"
+
+#include <AUnit.h>
+
+using namespace aunit;
+
+// Properties which are not registered with the TestRunner, used to verify
+// that a failing property is shrunk.
+class SmallIntProperty: public PropertyTest {
+  public:
+    void check() override {
+      value = genInt(-100000, 100000);
+      assertLess(value, 1000);
+    }
+
+    int32_t value;
+};
+
+class NoBProperty: public PropertyTest {
+  public:
+    void check() override {
+      genString(s, sizeof(s));
+      assertTrue(strchr(s, 'b') == nullptr);
+    }
+
+    char s[10];
+};
+
+// Fails only for buffers which need more choices than can be recorded.
+class LargeBufferProperty: public PropertyTest {
+  public:
+    void check() override {
+      length = genBytes(buf, sizeof(buf));
+      assertLess(length, (size_t) 100);
+    }
+
+    uint8_t buf[200];
+    size_t length;
+};
+
+testProperty(PropertyTestTest, addCommutes) {
+  int32_t a = genInt(-1000, 1000);
+  int32_t b = genInt(-1000, 1000);
+  assertEqual(a + b, b + a);
+}
+
+testProperty(PropertyTestTest, genIntInRange) {
+  int32_t a = genInt(5, 9);
+  assertMoreOrEqual(a, (int32_t) 5);
+  assertLessOrEqual(a, (int32_t) 9);
+  int32_t b = genInt(INT32_MIN, INT32_MAX);
+  (void) b;
+}
+
+testProperty(PropertyTestTest, genFloatInRange) {
+  float x = genFloat(-2.0, 3.0);
+  assertMoreOrEqual(x, -2.0f);
+  assertLessOrEqual(x, 3.0f);
+  float y = genFloat(1.0, 2.0);
+  assertMoreOrEqual(y, 1.0f);
+  assertLessOrEqual(y, 2.0f);
+}
+
+testProperty(PropertyTestTest, genStringIsPrintable) {
+  char s[8];
+  size_t n = genString(s, sizeof(s));
+  assertEqual(strlen(s), n);
+  for (size_t i = 0; i < n; i++) {
+    assertTrue(s[i] >= ' ' && s[i] <= '~');
+  }
+}
+
+testProperty(PropertyTestTest, genBytesLength) {
+  uint8_t buf[16];
+  size_t n = genBytes(buf, sizeof(buf));
+  assertLessOrEqual(n, sizeof(buf));
+}
+
+test(PropertyTestTest, shrinkInt) {
+  SmallIntProperty property;
+  property.once();
+  assertTrue(property.isFailed());
+  assertEqual(property.value, (int32_t) 1000);
+  assertMore(property.getNumShrinks(), 0);
+}
+
+test(PropertyTestTest, shrinkString) {
+  NoBProperty property;
+  property.once();
+  assertTrue(property.isFailed());
+  assertEqual((const char*) property.s, "b");
+}
+
+test(PropertyTestTest, tooManyChoices) {
+  LargeBufferProperty property;
+  property.once();
+  assertTrue(property.isFailed());
+  assertEqual(property.getNumShrinks(), 0);
+  assertMoreOrEqual(property.length, (size_t) 100);
+}
+
+test(PropertyTestTest, sameSeedSameCases) {
+  SmallIntProperty first;
+  first.once();
+  SmallIntProperty second;
+  second.once();
+  assertEqual(first.getNumCases(), second.getNumCases());
+}
+
+test(RandomTest, sequence) {
+  Random a(42);
+  Random b(42);
+  for (int i = 0; i < 10; i++) {
+    assertEqual(a.next(), b.next());
+  }
+  Random zero(0);
+  assertNotEqual(zero.next(), (uint32_t) 0);
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,101 @@
+#line 2 "RepeatTest.ino"
+
+#include <AUnit.h>
+
+using namespace aunit;
+
+// The whole run is repeated kNumIterations times by setup().
+const uint16_t kNumIterations = 5;
+
+uint16_t sNumOnceRuns = 0;
+uint16_t sNumAgainRuns = 0;
+uint16_t sNumSetups = 0;
+uint16_t sNumTeardowns = 0;
+
+class RepeatFixture: public TestOnce {
+  protected:
+    void setup() override {
+      TestOnce::setup();
+      sNumSetups++;
+      value = 0;
+    }
+
+    void teardown() override {
+      sNumTeardowns++;
+      TestOnce::teardown();
+    }
+
+    int value = 0;
+};
+
+test(RepeatTest, a_once) {
+  sNumOnceRuns++;
+}
+
+testing(RepeatTest, b_again) {
+  static uint8_t loops = 0;
+  if (++loops == 3) {
+    loops = 0;
+    sNumAgainRuns++;
+    pass();
+  }
+}
+
+testF(RepeatFixture, c_fixture) {
+  // The fixture is set up again before each iteration.
+  assertEqual(value, 0);
+  value = 42;
+}
+
+test(RepeatTest, excluded) {
+  fail();
+}
+
+// Waits for the other tests of the same iteration, whose number is given by
+// sNumOnceRuns.
+testing(RepeatTest, z_check) {
+  if (sNumAgainRuns < sNumOnceRuns) return;
+
+  assertEqual(sNumAgainRuns, sNumOnceRuns);
+  assertEqual(sNumSetups, sNumOnceRuns);
+  assertEqual(sNumTeardowns, sNumOnceRuns);
+  assertLessOrEqual(sNumOnceRuns, kNumIterations);
+  pass();
+}
+
+// Checks that exactly kNumIterations iterations were run, since z_check cannot
+// tell whether its iteration is the last one.
+class IterationCheck: public TestListener {
+  public:
+    void runFinished() override {
+      if (sNumOnceRuns == kNumIterations) return;
+      SERIAL_PORT_MONITOR.print(F("RepeatTest: "));
+      SERIAL_PORT_MONITOR.print(sNumOnceRuns);
+      SERIAL_PORT_MONITOR.print(F(" iteration(s), expected "));
+      SERIAL_PORT_MONITOR.println(kNumIterations);
+    #if defined(EPOXY_DUINO)
+      exit(1);
+    #endif
+    }
+};
+
+IterationCheck iterationCheck;
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+
+  TestRunner::exclude("RepeatTest_excluded");
+  TestRunner::setRepeat(kNumIterations);
+  TestRunner::addListener(&iterationCheck);
+}
+
+void loop() {
+  TestRunner::run();
+}
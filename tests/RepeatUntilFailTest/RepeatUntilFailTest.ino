@@ -0,0 +1,83 @@
+#line 2 "RepeatUntilFailTest.ino"
+
+#include <string.h>
+#include <AUnit.h>
+#include <aunit/fake/CapturePrint.h>
+
+using namespace aunit;
+using aunit::fake::CapturePrint;
+
+// The run is repeated until an iteration fails, see setup(). The flaky test
+// fails only in the kFailingIteration-th iteration.
+const uint16_t kFailingIteration = 3;
+
+uint16_t sNumIterations = 0;
+uint16_t sNumFailures = 0;
+
+// Receives the summary messages of the TestRunner, see setup().
+CapturePrint* sSummary = nullptr;
+
+test(RepeatUntilFailTest, a_stable) {
+  sNumIterations++;
+}
+
+test(RepeatUntilFailTest, b_flaky) {
+  assertNotEqual(sNumIterations, kFailingIteration);
+}
+
+// Counts the failures, and checks at the end that the run stopped after the
+// iteration which failed, and that the failure count of the flaky test was
+// printed. The flaky test fails on purpose, so the exit status is given by
+// these checks instead of the summary.
+class UntilFailCheck: public TestListener {
+  public:
+    void testFinished(Test& test) override {
+      if (test.isFailed()) sNumFailures++;
+    }
+
+    void runFinished() override {
+      bool isOk = sNumIterations == kFailingIteration
+          && sNumFailures == 1
+          && strstr(sSummary->getBuffer(), "Test RepeatUntilFailTest_b_flaky"
+              " failed or timed out 1 of 3 time(s) (33.3%).") != nullptr;
+      SERIAL_PORT_MONITOR.print(F("RepeatUntilFailTest: "));
+      SERIAL_PORT_MONITOR.print(sNumIterations);
+      SERIAL_PORT_MONITOR.print(F(" iteration(s), "));
+      SERIAL_PORT_MONITOR.print(sNumFailures);
+      SERIAL_PORT_MONITOR.println(isOk
+          ? F(" failure(s), as expected.")
+          : F(" failure(s), expected 3 iteration(s) and 1 failure(s)."));
+    #if defined(EPOXY_DUINO)
+      exit(isOk ? 0 : 1);
+    #endif
+    }
+};
+
+UntilFailCheck untilFailCheck;
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+
+  // Send all messages to the Serial port, and a copy of the summary messages
+  // to the CapturePrint.
+  static CapturePrint summary;
+  static TeePrint tee;
+  sSummary = &summary;
+  tee.addSink(&SERIAL_PORT_MONITOR);
+  tee.addSink(&summary, Verbosity::kTestRunSummary);
+  TestRunner::setPrinter(&tee);
+
+  TestRunner::setRepeat(TestRunner::kRepeatUntilFail);
+  TestRunner::addListener(&untilFailCheck);
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,49 @@
+#line 2 "SimpleTestTest.ino"
+
+#include <AUnit.h>
+
+using namespace aunit;
+
+simpleTest(Basic) {
+  assertEqual(1, 1);
+}
+
+simpleTest(SimpleTestTest, withSuite) {
+  assertTrue(true);
+}
+
+simpleTest(SimpleTestTest, skipped) {
+  skip();
+  assertTrue(false);
+}
+
+// The assertions after pass() must return early from the body, instead of
+// changing the status of the test.
+simpleTest(SimpleTestTest, earlyReturn) {
+  assertTrue(true);
+  pass();
+  assertTrue(false);
+}
+
+// Runs after the other tests, because the tests are sorted by name.
+simpleTest(SimpleTestTest, zz_monitor) {
+  assertTestPass(Basic);
+  assertTestPass(SimpleTestTest, withSuite);
+  assertTestSkip(SimpleTestTest, skipped);
+  assertTestPass(SimpleTestTest, earlyReturn);
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+}
+
+void loop() {
+  TestRunner::run();
+}
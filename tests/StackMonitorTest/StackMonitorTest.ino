@@ -0,0 +1,62 @@
+#line 2 "StackMonitorTest.ino"
+
+#include <AUnit.h>
+
+using namespace aunit;
+
+StackMonitor stackMonitor;
+
+// Prevent the compiler from optimizing away the buffer.
+__attribute__((noinline))
+uint8_t useStack(volatile uint8_t* buf, size_t size) {
+  uint8_t sum = 0;
+  for (size_t i = 0; i < size; i++) sum += buf[i];
+  return sum;
+}
+
+// Size of the local buffer of the deep test.
+const size_t kDeepSize = 512;
+
+// Stack usage of the deep test, saved by the shallow test.
+size_t sDeepUsage = 0;
+
+// Tests are executed in alphabetical order, so 'a_deep' runs before the
+// tests which verify its stack usage.
+test(StackMonitorTest, a_deep) {
+  volatile uint8_t buf[kDeepSize];
+  for (size_t i = 0; i < sizeof(buf); i++) buf[i] = i;
+  useStack(buf, sizeof(buf));
+}
+
+// Makes no assertion, so that its own stack usage stays small. The usage of
+// the previous test is saved for c_usage.
+test(StackMonitorTest, b_shallow) {
+  sDeepUsage = stackMonitor.getUsage();
+}
+
+test(StackMonitorTest, c_usage) {
+  // The deep test used at least its buffer.
+  assertMoreOrEqual((unsigned long) sDeepUsage, (unsigned long) kDeepSize);
+  assertEqual((unsigned long) stackMonitor.getMaxUsage(),
+      (unsigned long) sDeepUsage);
+
+  // The shallow test, whose usage is the most recent one, used much less.
+  assertLess((unsigned long) stackMonitor.getUsage(),
+      (unsigned long) kDeepSize / 2);
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+  TestRunner::addListener(&stackMonitor);
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,210 @@
+#line 2 "StressTest.ino"
+
+#include <AUnit.h>
+#if defined(EPOXY_DUINO)
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#endif
+
+using namespace aunit;
+
+#if defined(EPOXY_DUINO)
+
+const uint8_t kThreads = 4;
+const uint32_t kIterations = 1000;
+
+// Collects the output of a test, to check that the lines are not mixed.
+class StringPrint: public Print {
+  public:
+    size_t write(uint8_t c) override {
+      mString += (char) c;
+      return 1;
+    }
+
+    const std::string& getString() const { return mString; }
+
+  private:
+    std::string mString;
+};
+
+// Return true if every line of 's' is equal to 'line', followed by the
+// "\r\n" of println().
+bool areLinesEqual(const std::string& s, const char* line) {
+  std::string expected = std::string(line) + "\r\n";
+  size_t i = 0;
+  while (i < s.size()) {
+    if (s.compare(i, expected.size(), expected) != 0) return false;
+    i += expected.size();
+  }
+  return true;
+}
+
+// A test which is not registered with the TestRunner, whose stress() fails
+// on thread 2 at iteration 5.
+class FailingStress: public TestOnce {
+  public:
+    void once() override {}
+
+    bool run() {
+      return stress(kThreads, 100, [this](uint8_t thread, uint32_t i) {
+        mNumCalls++;
+        if (thread == 2 && i == 5) {
+          assertEqual(i, (uint32_t) 6);
+        }
+        // Give the other threads a chance to see the failure.
+        std::this_thread::yield();
+      });
+    }
+
+    void callPass() { pass(); }
+
+    std::atomic<uint32_t> mNumCalls{0};
+};
+
+test(StressTest, countsEveryIteration) {
+  std::atomic<uint32_t> count(0);
+  std::vector<uint32_t> perThread(kThreads);
+
+  bool ok = stress(kThreads, kIterations, [&](uint8_t thread, uint32_t /*i*/) {
+    assertLess(thread, kThreads);
+    count++;
+    perThread[thread]++;
+  });
+
+  assertTrue(ok);
+  assertEqual(kThreads * kIterations, (uint32_t) count);
+  for (uint8_t i = 0; i < kThreads; i++) {
+    assertEqual(kIterations, perThread[i]);
+  }
+}
+
+test(StressTest, runsOnOtherThreads) {
+  std::thread::id self = std::this_thread::get_id();
+  std::atomic<uint32_t> numOnSelf(0);
+
+  stress(kThreads, 10, [&](uint8_t /*thread*/, uint32_t /*i*/) {
+    if (std::this_thread::get_id() == self) numOnSelf++;
+  });
+
+  assertEqual((uint32_t) 0, (uint32_t) numOnSelf);
+}
+
+test(StressTest, failureIsAttributedToThread) {
+  StringPrint output;
+  Print* printer = Printer::getPrinter();
+  Printer::setPrinter(&output);
+
+  FailingStress dummy;
+  dummy.enableVerbosity(Verbosity::kAssertionFailed);
+  bool ok = dummy.run();
+  dummy.callPass();
+
+  Printer::setPrinter(printer);
+
+  assertFalse(ok);
+  assertTrue(dummy.isFailed());
+  assertLess((uint32_t) dummy.mNumCalls, (uint32_t) (kThreads * 100));
+  assertTrue(output.getString().find(
+      "Stress failed: thread 2 at iteration 5 of 100.")
+      != std::string::npos);
+  assertTrue(output.getString().find("Assertion failed: (5) == (6).")
+      != std::string::npos);
+}
+
+test(StressTest, linesAreNotMixed) {
+  const char kLine[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+  StringPrint output;
+  Print* printer = Printer::getPrinter();
+  Printer::setPrinter(&output);
+
+  stress(kThreads, 200, [&](uint8_t /*thread*/, uint32_t /*i*/) {
+    Print* p = Printer::getPrinter();
+    for (const char* s = kLine; *s; s++) p->write(*s);
+    p->println();
+  });
+
+  // Threads which are not created by stress() are also line buffered.
+  std::vector<std::thread> threads;
+  for (uint8_t i = 0; i < kThreads; i++) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 200; j++) {
+        Print* p = Printer::getPrinter();
+        for (const char* s = kLine; *s; s++) p->write(*s);
+        p->println();
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  Printer::setPrinter(printer);
+
+  assertEqual((size_t) (2 * kThreads * 200 * (sizeof(kLine) + 1)),
+      output.getString().size());
+  assertTrue(areLinesEqual(output.getString(), kLine));
+}
+
+// The stress() method in the fixture of a typed test, whose base class
+// depends on the template parameter.
+template <typename T>
+class StressFixture: public TestOnce {
+  protected:
+    std::atomic<T> count{0};
+};
+
+typedTestF(StressFixture, (uint32_t, uint64_t), stress) {
+  bool ok = stress(kThreads, 10, [&](uint8_t /*thread*/, uint32_t /*i*/) {
+    this->count++;
+  });
+  assertTrue(ok);
+  assertEqual((TypeParam) (kThreads * 10), (TypeParam) this->count);
+}
+
+#endif
+
+// A test which is not registered with the TestRunner, whose status is set
+// directly.
+class StatusDummy: public TestOnce {
+  public:
+    void once() override {}
+
+    void callPass() { pass(); }
+    void callFail() { fail(); }
+};
+
+// The same rule applies on every platform, with or without threads.
+test(StressTest, failureIsKept) {
+  StatusDummy dummy;
+  dummy.callFail();
+  dummy.callPass();
+  assertTrue(dummy.isFailed());
+  dummy.skip();
+  assertTrue(dummy.isFailed());
+  dummy.expire();
+  assertTrue(dummy.isFailed());
+
+  // Only a reset clears the failure.
+  dummy.setStatus(Test::kStatusUnknown);
+  dummy.skip();
+  assertTrue(dummy.isSkipped());
+  dummy.callPass();
+  assertTrue(dummy.isPassed());
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,243 @@
+#line 2 "StringDiffTest.ino"
+
+#include <string.h>
+#include <AUnit.h>
+#include <aunit/fake/CapturePrint.h>
+#include <aunit/fake/FakePrint.h>
+
+using namespace aunit;
+using aunit::fake::CapturePrint;
+using aunit::fake::FakePrint;
+using aunit::internal::compareEqual;
+
+// 60 characters, the second one differs at [36].
+const char kLhs[] = "0123456789abcdefghij0123456789ABCDEFGHIJ0123456789abcdefghij";
+const char kRhs[] = "0123456789abcdefghij0123456789ABCDEFXHIJ0123456789abcdefghij";
+const char kRhsUpper[] =
+    "0123456789ABCDEFGHIJ0123456789ABCDEFXHIJ0123456789ABCDEFGHIJ";
+
+// The diff of kLhs and kRhs, after the first line.
+const char kDiff[] =
+    "  \"...0123456789ABCDEFGHIJ0123456789ab...\"\r\n"
+    "  \"...0123456789ABCDEFXHIJ0123456789ab...\"\r\n"
+    "                      ^\r\n";
+
+// A test which is not registered with the TestRunner, used to capture the
+// message of a failed assertion. Its verbosity is not set by the TestRunner.
+class DummyTest: public TestOnce {
+  public:
+    DummyTest() {
+      enableVerbosity(Verbosity::kAssertionFailed);
+    }
+};
+
+class RamDiffTest: public DummyTest {
+  public:
+    void once() override {
+      assertEqual(kLhs, kRhs);
+    }
+};
+
+class FlashStringDiffTest: public DummyTest {
+  public:
+    void once() override {
+      assertEqual(
+          F("0123456789abcdefghij0123456789ABCDEFGHIJ0123456789abcdefghij"),
+          String(kRhs));
+    }
+};
+
+class FlashFlashDiffTest: public DummyTest {
+  public:
+    void once() override {
+      assertEqual(
+          F("0123456789abcdefghij0123456789ABCDEFGHIJ0123456789abcdefghij"),
+          F("0123456789abcdefghij0123456789ABCDEFXHIJ0123456789abcdefghij"));
+    }
+};
+
+class PrefixDiffTest: public DummyTest {
+  public:
+    void once() override {
+      assertEqual(kLhs, "0123456789abcdefghij0123456789ABCDEFGHIJ");
+    }
+};
+
+class EscapedDiffTest: public DummyTest {
+  public:
+    void once() override {
+      assertEqual("a\tb=1\r\n0123456789012345678901234567890123456789",
+          "a\tb=2\r\n0123456789012345678901234567890123456789");
+    }
+};
+
+class CaseDiffTest: public DummyTest {
+  public:
+    void once() override {
+      assertStringCaseEqual(kLhs, kRhsUpper);
+    }
+};
+
+class ShortStringTest: public DummyTest {
+  public:
+    void once() override {
+      assertEqual("abc", "abd");
+    }
+};
+
+class EqualStringTest: public DummyTest {
+  public:
+    void once() override {
+      assertNotEqual(kLhs, kLhs);
+    }
+};
+
+class VerboseDiffTest: public DummyTest {
+  public:
+    void once() override {
+      assertionVerbose(__FILE__, __LINE__, kLhs, F("kLhs"), "==", compareEqual,
+          kRhs, F("kRhs"));
+    }
+};
+
+test(StringDiffTest, ram) {
+  RamDiffTest dummy;
+  CapturePrint capture;
+  dummy.once();
+  capture.release();
+  const char* output = capture.getBuffer();
+
+  assertTrue(dummy.isFailed());
+  assertTrue(strstr(output, "StringDiffTest.ino:") == output);
+  const char* diff = strstr(output,
+      ": Assertion failed: (60 chars) == (60 chars), "
+      "first difference at [36]:\r\n");
+  assertTrue(diff != nullptr);
+  assertEqual(kDiff, strchr(diff, '\n') + 1);
+}
+
+test(StringDiffTest, flashAndString) {
+  FlashStringDiffTest flashString;
+  CapturePrint capture;
+  flashString.once();
+  capture.release();
+  const char* output = capture.getBuffer();
+  assertTrue(strstr(output,
+      ": Assertion failed: (60 chars) == (60 chars), "
+      "first difference at [36]:\r\n") != nullptr);
+  assertTrue(strstr(output, kDiff) != nullptr);
+
+  FlashFlashDiffTest flashFlash;
+  CapturePrint capture2;
+  flashFlash.once();
+  capture2.release();
+  output = capture2.getBuffer();
+  assertTrue(strstr(output, kDiff) != nullptr);
+}
+
+test(StringDiffTest, prefix) {
+  PrefixDiffTest dummy;
+  CapturePrint output;
+  dummy.once();
+  output.release();
+  assertTrue(strstr(output.getBuffer(),
+      ": Assertion failed: (60 chars) == (40 chars), "
+      "first difference at [40]:\r\n"
+      "  \"...456789ABCDEFGHIJ0123456789abcdef...\"\r\n"
+      "  \"...456789ABCDEFGHIJ\"\r\n"
+      "                      ^\r\n") != nullptr);
+}
+
+test(StringDiffTest, escaped) {
+  EscapedDiffTest dummy;
+  CapturePrint output;
+  dummy.once();
+  output.release();
+  assertTrue(strstr(output.getBuffer(),
+      ": Assertion failed: (47 chars) == (47 chars), "
+      "first difference at [4]:\r\n"
+      "  \"a\\tb=1\\r\\n0123456789012...\"\r\n"
+      "  \"a\\tb=2\\r\\n0123456789012...\"\r\n"
+      "        ^\r\n") != nullptr);
+}
+
+test(StringDiffTest, caseInsensitive) {
+  CaseDiffTest dummy;
+  CapturePrint output;
+  dummy.once();
+  output.release();
+  assertTrue(strstr(output.getBuffer(),
+      ": Assertion failed: (60 chars) == (60 chars), "
+      "first difference at [36]:\r\n"
+      "  \"...0123456789ABCDEFGHIJ0123456789ab...\"\r\n"
+      "  \"...0123456789ABCDEFXHIJ0123456789AB...\"\r\n") != nullptr);
+}
+
+test(StringDiffTest, shortStringsPrintedInFull) {
+  ShortStringTest dummy;
+  CapturePrint output;
+  dummy.once();
+  output.release();
+  assertTrue(strstr(output.getBuffer(),
+      ": Assertion failed: (abc) == (abd).\r\n") != nullptr);
+}
+
+test(StringDiffTest, equalStringsPrintedInFull) {
+  EqualStringTest dummy;
+  CapturePrint capture;
+  dummy.once();
+  capture.release();
+  const char* output = capture.getBuffer();
+  assertTrue(dummy.isFailed());
+  assertTrue(strstr(output, ": Assertion failed: (0123456789abcdefghij") !=
+      nullptr);
+  assertTrue(strstr(output, "chars") == nullptr);
+}
+
+test(StringDiffTest, verbose) {
+  VerboseDiffTest dummy;
+  CapturePrint capture;
+  dummy.once();
+  capture.release();
+  const char* output = capture.getBuffer();
+  assertTrue(strstr(output,
+      ": Assertion failed: (kLhs=60 chars) == (kRhs=60 chars), "
+      "first difference at [36]:\r\n") != nullptr);
+  assertTrue(strstr(output, kDiff) != nullptr);
+}
+
+// Each line of the diff is tagged as a failed assertion message, so it
+// reaches only the sinks of a TeePrint which want those.
+test(StringDiffTest, teePrint) {
+  RamDiffTest dummy;
+  CapturePrint output;
+  FakePrint others;
+  TeePrint tee;
+  tee.addSink(&output, Verbosity::kAssertionFailed);
+  tee.addSink(&others, Verbosity::kTestAll);
+  Printer::setPrinter(&tee);
+  dummy.once();
+  output.release();
+
+  assertTrue(strstr(output.getBuffer(),
+      ": Assertion failed: (60 chars) == (60 chars), ") != nullptr);
+  assertTrue(strstr(output.getBuffer(), kDiff) != nullptr);
+  assertEqual("", others.getBuffer());
+}
+
+//---------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,146 @@
+#line 2 "TeePrintTest.ino"
+
+#include <AUnit.h>
+#include <aunit/fake/FakePrint.h>
+
+using namespace aunit;
+using aunit::fake::FakePrint;
+
+// Counts the calls to write(), to verify that the output is chunked.
+class CountingPrint: public FakePrint {
+  public:
+    size_t write(uint8_t c) override {
+      // FakePrint::write(buffer, size) calls this method for each byte.
+      if (! mIsInChunk) mNumWrites++;
+      return FakePrint::write(c);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+      mNumWrites++;
+      mIsInChunk = true;
+      size_t n = FakePrint::write(buffer, size);
+      mIsInChunk = false;
+      return n;
+    }
+
+    int mNumWrites = 0;
+
+  private:
+    bool mIsInChunk = false;
+};
+
+test(TeePrintTest, addSink) {
+  TeePrint tee;
+  FakePrint sink;
+  assertEqual(tee.getNumSinks(), 0);
+  assertEqual(tee.getVerbosity(), Verbosity::kNone);
+  for (uint8_t i = 0; i < TeePrint::kMaxSinks; i++) {
+    assertTrue(tee.addSink(&sink, (uint8_t) (1 << i)));
+  }
+  assertFalse(tee.addSink(&sink));
+  assertFalse(TeePrint().addSink(nullptr));
+  assertEqual(tee.getNumSinks(), TeePrint::kMaxSinks);
+  assertEqual(tee.getVerbosity(), 0x0F);
+}
+
+test(TeePrintTest, allSinksReceiveUntaggedOutput) {
+  TeePrint tee;
+  FakePrint first;
+  FakePrint second;
+  tee.addSink(&first, Verbosity::kTestFailed);
+  tee.addSink(&second);
+
+  Printer::setMessageVerbosity(Verbosity::kNone);
+  tee.println(F("hello"));
+  assertEqual("hello\r\n", first.getBuffer());
+  assertEqual("hello\r\n", second.getBuffer());
+}
+
+test(TeePrintTest, sinksFilterTaggedLines) {
+  TeePrint tee;
+  FakePrint console;
+  FakePrint file;
+  tee.addSink(&console, Verbosity::kTestFailed);
+  tee.addSink(&file, Verbosity::kAll);
+
+  Printer::setMessageVerbosity(Verbosity::kTestPassed);
+  tee.print(F("Test a"));
+  tee.println(F(" passed."));
+  Printer::setMessageVerbosity(Verbosity::kTestFailed);
+  tee.println(F("Test b failed."));
+  tee.println(F("extra"));
+
+  assertEqual("Test b failed.\r\nextra\r\n", console.getBuffer());
+  assertEqual("Test a passed.\r\nTest b failed.\r\nextra\r\n",
+      file.getBuffer());
+  assertEqual(Printer::getMessageVerbosity(), Verbosity::kNone);
+}
+
+test(TeePrintTest, assertionMessagesAreTagged) {
+  TeePrint tee;
+  FakePrint console;
+  FakePrint file;
+  tee.addSink(&console, Verbosity::kAssertionFailed);
+  tee.addSink(&file, Verbosity::kAll);
+
+  Print* saved = Printer::getPrinter();
+  Printer::setPrinter(&tee);
+  uint8_t verbosity = getVerbosity();
+  enableVerbosity(Verbosity::kAssertionPassed);
+  assertEqual(1, 1);
+  disableVerbosity(Verbosity::kAll);
+  enableVerbosity(verbosity);
+  Printer::setPrinter(saved);
+
+  assertEqual("", console.getBuffer());
+  assertTrue(strstr(file.getBuffer(), "Assertion passed") != nullptr);
+}
+
+test(TeePrintTest, lineIsWrittenInChunks) {
+  TeePrint tee;
+  CountingPrint sink;
+  tee.addSink(&sink);
+
+  tee.print(F("Test "));
+  tee.print(12345);
+  tee.print(F(" passed"));
+  assertEqual(sink.mNumWrites, 0);
+  tee.println('.');
+  assertEqual(sink.mNumWrites, 1);
+  assertEqual("Test 12345 passed.\r\n", sink.getBuffer());
+
+  // A line longer than the buffer is written in several chunks.
+  sink.flush();
+  sink.mNumWrites = 0;
+  for (uint8_t i = 0; i < TeePrint::kBufSize; i++) {
+    tee.print('x');
+  }
+  assertEqual(sink.mNumWrites, 1);
+}
+
+test(TeePrintTest, flush) {
+  TeePrint tee;
+  CountingPrint sink;
+  tee.addSink(&sink);
+
+  tee.print(F("partial"));
+  assertEqual(sink.mNumWrites, 0);
+  assertEqual("", sink.getBuffer());
+  tee.flush();
+  assertEqual(sink.mNumWrites, 1);
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+}
+
+void loop() {
+  TestRunner::run();
+}
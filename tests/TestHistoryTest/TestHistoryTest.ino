@@ -0,0 +1,148 @@
+#line 2 "TestHistoryTest.ino"
+
+#include <AUnit.h>
+#if defined(EPOXY_DUINO)
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+
+using namespace aunit;
+
+// The tests append their letter to sOrder when they run, so that the last
+// test can verify the order imposed by the history.
+char sOrder[16];
+
+void appendOrder(char c) {
+  size_t n = strlen(sOrder);
+  sOrder[n] = c;
+  sOrder[n + 1] = '\0';
+}
+
+test(TestHistoryTest, a_slow) { appendOrder('a'); }
+test(TestHistoryTest, b_fast) { appendOrder('b'); }
+test(TestHistoryTest, d_new) { appendOrder('d'); }
+
+// Failed in the history file, but passes in the first iteration, so it must
+// not be run by the --rerun-failed of the last iteration.
+test(TestHistoryTest, c_failed) {
+  static uint8_t numRuns = 0;
+  appendOrder('c');
+  assertLessOrEqual(++numRuns, 2);
+}
+
+#if defined(EPOXY_DUINO)
+
+// Same layout as the records of TestHistory.
+struct Record {
+  uint32_t hash;
+  uint32_t duration;
+  uint8_t status;
+  uint8_t reserved[3];
+};
+
+char sFileName[48];
+
+uint32_t hashOf(const char* name) {
+  return internal::FCString(name).hash();
+}
+
+void writeRecord(FILE* file, const char* name, uint8_t status,
+    uint32_t duration) {
+  Record record;
+  memset(&record, 0, sizeof(record));
+  record.hash = hashOf(name);
+  record.status = status;
+  record.duration = duration;
+  fwrite(&record, sizeof(record), 1, file);
+}
+
+// Write the history of a previous run, in which c_failed failed. The 'check'
+// test is recorded as the slowest, so that it runs last.
+void writeHistory() {
+  snprintf(sFileName, sizeof(sFileName), "/tmp/aunit_history_%d.bin",
+      (int) getpid());
+  FILE* file = fopen(sFileName, "wb");
+  fwrite("AUH1", 4, 1, file);
+  writeRecord(file, "TestHistoryTest_a_slow", Test::kStatusPassed, 3000);
+  // A stale duplicate, which is superseded by the next record of b_fast.
+  writeRecord(file, "TestHistoryTest_b_fast", Test::kStatusFailed, 1000);
+  writeRecord(file, "TestHistoryTest_b_fast", Test::kStatusPassed, 1000);
+  writeRecord(file, "TestHistoryTest_c_failed", Test::kStatusFailed, 2000);
+  writeRecord(file, "TestHistoryTest_z_check", Test::kStatusPassed,
+      0xFFFFFFFE);
+  fclose(file);
+}
+
+// Find the last record of the given test in the history file, and return the
+// number of records of that test.
+uint8_t readRecord(const char* name, Record& record) {
+  FILE* file = fopen(sFileName, "rb");
+  if (file == nullptr) return 0;
+  fseek(file, 4, SEEK_SET);
+  uint8_t count = 0;
+  Record next;
+  while (fread(&next, sizeof(next), 1, file) == 1) {
+    if (next.hash == hashOf(name)) {
+      record = next;
+      count++;
+    }
+  }
+  fclose(file);
+  return count;
+}
+
+// The tests are run 3 times, see setRepeat() in setup(). This test is run
+// only by the first 2 iterations.
+test(TestHistoryTest, z_check) {
+  static uint8_t numIterations = 0;
+  numIterations++;
+
+  // Failed first, then new tests, then from the fastest to the slowest. The
+  // stale failure of b_fast is ignored.
+  if (numIterations == 1) {
+    assertEqual((const char*) sOrder, "cdba");
+  }
+
+  // The records are updated as soon as each test finishes.
+  Record record;
+  assertEqual(readRecord("TestHistoryTest_c_failed", record), 1);
+  assertEqual(record.status, Test::kStatusPassed);
+  assertEqual(readRecord("TestHistoryTest_b_fast", record), 2);
+  assertEqual(record.status, Test::kStatusPassed);
+
+  // The new test is appended once, and updated by the next iteration.
+  assertEqual(readRecord("TestHistoryTest_d_new", record), 1);
+  assertEqual(record.status, Test::kStatusPassed);
+  assertNotEqual(record.duration, Test::kDurationUnknown);
+
+  // Same as the '--rerun-failed' flag, for the last iteration. All the tests
+  // passed in the earlier iterations, so none of them are run again.
+  if (numIterations == 2) {
+    TestHistory::setRerunFailed(true);
+    unlink(sFileName);
+  }
+}
+
+#endif
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+
+  // Same as the '--history file --order history' flags.
+  writeHistory();
+  TestHistory::open(sFileName);
+  TestHistory::setOrderByHistory(true);
+  TestRunner::setRepeat(3);
+#endif
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,113 @@
+#line 2 "TestSuiteTest.ino"
+
+#include <AUnit.h>
+
+using namespace aunit;
+
+// -------------------------------------------------------------------------
+// A suite whose setupSuite() and teardownSuite() are called once around its
+// tests.
+// -------------------------------------------------------------------------
+
+class TableFixture: public TestOnce {
+  public:
+    static void setupSuite() {
+      numSetups++;
+      for (uint8_t i = 0; i < sizeof(table); i++) table[i] = i * 2;
+    }
+
+    static void teardownSuite() {
+      numTeardowns++;
+    }
+
+    static uint8_t table[16];
+    static uint8_t numSetups;
+    static uint8_t numTeardowns;
+};
+
+uint8_t TableFixture::table[16];
+uint8_t TableFixture::numSetups = 0;
+uint8_t TableFixture::numTeardowns = 0;
+
+suiteF(TableFixture);
+
+// A subclass whose name begins with "TableFixture_" is not a member of the
+// suite. Runs before the tests of TableFixture, because "D" < "f".
+class TableFixture_Derived: public TableFixture {};
+
+testF(TableFixture_Derived, notMember) {
+  assertEqual(0, numSetups);
+}
+
+testF(TableFixture, first) {
+  assertEqual(1, numSetups);
+  assertEqual(0, numTeardowns);
+  assertEqual(6, table[3]);
+}
+
+testF(TableFixture, second) {
+  assertEqual(1, numSetups);
+  assertEqual(0, numTeardowns);
+}
+
+lazyTestF(TableFixture, third) {
+  assertEqual(1, numSetups);
+  assertEqual(0, numTeardowns);
+}
+
+// Named "TableFixture_zzz" like a testF() of the fixture, but not a member, so
+// the suite was torn down after "TableFixture_third".
+test(TableFixture, zzz) {
+  assertEqual(1, TableFixture::numTeardowns);
+  assertFalse(TableFixture_suite.isActive());
+}
+
+// -------------------------------------------------------------------------
+// A suite whose tests are all excluded in setup(), so its setupSuite() is
+// never called.
+// -------------------------------------------------------------------------
+
+class ExcludedFixture: public TestOnce {
+  public:
+    static void setupSuite() { numSetups++; }
+
+    static uint8_t numSetups;
+};
+
+uint8_t ExcludedFixture::numSetups = 0;
+
+suiteF(ExcludedFixture);
+
+testF(ExcludedFixture, excluded) {
+  fail();
+}
+
+// -------------------------------------------------------------------------
+// Runs after the fixture tests, because the tests are sorted by name.
+// -------------------------------------------------------------------------
+
+test(TestSuiteTest, suiteIsTornDown) {
+  assertEqual(1, TableFixture::numSetups);
+  assertEqual(1, TableFixture::numTeardowns);
+  assertFalse(TableFixture_suite.isActive());
+}
+
+test(TestSuiteTest, excludedSuiteIsNotSetup) {
+  assertEqual(0, ExcludedFixture::numSetups);
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+  TestRunner::exclude("ExcludedFixture_*");
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,135 @@
+#line 2 "ThreadRunnerTest.ino"
+
+#include <AUnit.h>
+#if defined(EPOXY_DUINO)
+#include <atomic>
+#include <thread>
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+using namespace aunit;
+
+#if defined(EPOXY_DUINO)
+
+const uint8_t kJobs = 4;
+
+// The number of tests which are running at the same time, and its maximum.
+std::atomic<int> sNumRunning(0);
+std::atomic<int> sMaxRunning(0);
+std::atomic<int> sNumFinished(0);
+std::thread::id sMainThread;
+
+// Hold the test for a while, and record how many tests overlap with it.
+void overlap() {
+  int running = ++sNumRunning;
+  int max = sMaxRunning;
+  while (running > max && !sMaxRunning.compare_exchange_weak(max, running)) {}
+  delay(20);
+  sNumRunning--;
+  sNumFinished++;
+}
+
+test(ThreadRunnerTest, a) { overlap(); }
+test(ThreadRunnerTest, b) { overlap(); }
+test(ThreadRunnerTest, c) { overlap(); }
+test(ThreadRunnerTest, d) { overlap(); }
+test(ThreadRunnerTest, e) { overlap(); }
+test(ThreadRunnerTest, f) { overlap(); }
+
+test(ThreadRunnerTest, isOnWorkerThread) {
+  assertTrue(std::this_thread::get_id() != sMainThread);
+  sNumFinished++;
+}
+
+testing(ThreadRunnerTest, testingIsResolved) {
+  static int count = 0;
+  if (++count >= 10) {
+    sNumFinished++;
+    pass();
+  }
+}
+
+// A lazy fixture claims the arena atomically, so these tests take turns.
+static std::atomic<int> sNumLiveFixtures(0);
+
+class ArenaFixture: public TestOnce {
+  protected:
+    ArenaFixture() { sNumLiveFixtures++; }
+    ~ArenaFixture() { sNumLiveFixtures--; }
+};
+
+lazyTestF(ArenaFixture, first) {
+  assertEqual(1, (int) sNumLiveFixtures);
+  delay(10);
+  assertEqual(1, (int) sNumLiveFixtures);
+  sNumFinished++;
+}
+
+lazyTestF(ArenaFixture, second) {
+  assertEqual(1, (int) sNumLiveFixtures);
+  delay(10);
+  assertEqual(1, (int) sNumLiveFixtures);
+  sNumFinished++;
+}
+
+// The history file records the duration measured by the worker threads.
+char sHistoryName[48];
+
+// Return the duration recorded in the history file for the given test.
+uint32_t readDuration(const char* name) {
+  uint32_t duration = Test::kDurationUnknown;
+  FILE* file = fopen(sHistoryName, "rb");
+  if (file == nullptr) return duration;
+  fseek(file, 4, SEEK_SET);
+  uint32_t record[3];
+  while (fread(record, sizeof(record), 1, file) == 1) {
+    if (record[0] == internal::FCString(name).hash()) duration = record[1];
+  }
+  fclose(file);
+  return duration;
+}
+
+// Matches the serial("serial*") pattern, so runs on the main thread after all
+// the other tests.
+test(serialCheck) {
+  assertTrue(std::this_thread::get_id() == sMainThread);
+  assertEqual(10, (int) sNumFinished);
+  assertEqual(0, (int) sNumRunning);
+  assertMore((int) sMaxRunning, 1);
+  assertLessOrEqual((int) sMaxRunning, (int) kJobs);
+
+  uint32_t duration = readDuration("ThreadRunnerTest_a");
+  unlink(sHistoryName);
+  assertNotEqual(duration, Test::kDurationUnknown);
+  assertMoreOrEqual(duration, (uint32_t) 20000);
+}
+
+test(serialIsOnMainThread) {
+  assertTrue(std::this_thread::get_id() == sMainThread);
+}
+
+#endif
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+
+  // Same as the '--jobs 4 --serial serial* --history file' flags.
+  sMainThread = std::this_thread::get_id();
+  TestRunner::setJobs(kJobs);
+  TestRunner::serial("serial*");
+  snprintf(sHistoryName, sizeof(sHistoryName), "/tmp/aunit_history_%d.bin",
+      (int) getpid());
+  TestHistory::open(sHistoryName);
+#endif
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,51 @@
+#line 2 "TimerTest.ino"
+
+#include <AUnit.h>
+
+using namespace aunit;
+
+test(TimerTest, calibrate) {
+  Timer::calibrate();
+  assertTrue(Timer::isCalibrated());
+  // The overhead of a call to ticks() is far less than a millisecond.
+  assertLess((unsigned long) Timer::toMicros(Timer::overhead()), 1000UL);
+}
+
+test(TimerTest, ticksAreMonotonic) {
+  uint32_t start = Timer::ticks();
+  delay(2);
+  uint32_t elapsed = Timer::ticks() - start;
+  assertMoreOrEqual((unsigned long) Timer::toMicros(elapsed), 2000UL);
+  assertLess((unsigned long) Timer::toMicros(elapsed), 1000000UL);
+}
+
+test(TimerTest, toNanosAndMicros) {
+  uint32_t ticks = 100000;
+  assertEqual(
+      (unsigned long) Timer::toNanos(ticks) / 1000,
+      (unsigned long) Timer::toMicros(ticks));
+
+  // Long intervals saturate instead of overflowing.
+  assertEqual(4294967295UL, (unsigned long) Timer::toNanos(4294967295UL));
+}
+
+test(TimerTest, durationIsNotInAll) {
+  assertEqual(0, Verbosity::kAll & Verbosity::kTestDuration);
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+  TestRunner::setVerbosity(Verbosity::kDefault
+      | Verbosity::kTestDuration);
+}
+
+void loop() {
+  TestRunner::run();
+}
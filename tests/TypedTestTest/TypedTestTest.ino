@@ -0,0 +1,84 @@
+#line 2 "TypedTestTest.ino"
+
+#include <AUnit.h>
+
+using namespace aunit;
+
+template <typename T>
+class Accumulator: public TestOnce {
+  protected:
+    void setup() override {
+      TestOnce::setup();
+      sum = 0;
+    }
+
+    T sum;
+};
+
+#define ACCUMULATOR_TYPES (uint8_t, uint16_t, uint32_t, float)
+
+typedTestF(Accumulator, ACCUMULATOR_TYPES, add) {
+  this->sum += 2;
+  this->sum += 3;
+  assertEqual(this->sum, (TypeParam) 5);
+}
+
+// Fails for float, which is excluded in setup().
+typedTestF(Accumulator, ACCUMULATOR_TYPES, wrapAround) {
+  this->sum -= 1;
+  assertMore(this->sum, (TypeParam) 0);
+}
+
+template <typename T>
+class Counter: public TestAgain {
+  protected:
+    T count = 0;
+};
+
+typedTestingF(Counter, (uint8_t, long), count) {
+  this->count++;
+  if (this->count == 3) pass();
+}
+
+test(TypedTestTest, names) {
+  assertEqual(Accumulator_add_instance0.getName().compareToN(
+      "Accumulator<uint8_t>_add", 25), 0);
+  assertEqual(Accumulator_add_instance3.getName().compareToN(
+      "Accumulator<float>_add", 23), 0);
+  assertEqual(Counter_count_instance1.getName().compareToN(
+      "Counter<long>_count", 20), 0);
+}
+
+// Runs after the other tests, because the tests are sorted by name.
+testing(TypedTestTest, zz_monitor) {
+  if (Counter_count_instance0.isNotDone()) return;
+  if (Counter_count_instance1.isNotDone()) return;
+
+  assertTrue(Accumulator_add_instance0.isPassed());
+  assertTrue(Accumulator_add_instance1.isPassed());
+  assertTrue(Accumulator_add_instance2.isPassed());
+  assertTrue(Accumulator_add_instance3.isPassed());
+  assertTrue(Accumulator_wrapAround_instance0.isPassed());
+  assertTrue(Accumulator_wrapAround_instance2.isPassed());
+  assertTrue(Accumulator_wrapAround_instance3.isSkipped());
+  assertTrue(Counter_count_instance0.isPassed());
+  assertTrue(Counter_count_instance1.isPassed());
+  pass();
+}
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (! SERIAL_PORT_MONITOR); // Wait until Serial is ready - Leonardo
+#if defined(EPOXY_DUINO)
+  SERIAL_PORT_MONITOR.setLineModeUnix();
+#endif
+
+  TestRunner::exclude("Accumulator<float>_wrapAround");
+}
+
+void loop() {
+  TestRunner::run();
+}